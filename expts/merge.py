@@ -0,0 +1,126 @@
+
+# import the required modules.
+import os, re, shutil, sys
+from struct import unpack
+
+# usage: help string printed on invalid arguments.
+usage = '''usage:
+  merge.py dcd OUTPUT.dcd INPUT.dcd [INPUT.dcd ...]
+  merge.py report INPUT.log [INPUT.log ...]
+
+merges the outputs of independent ibp-ng runs over disjoint slices of
+the same tree, e.g. from "--partition 1/N" to "--partition N/N".
+'''
+
+# header_size: size in bytes of the three dcd header records.
+header_size = 276
+
+# counts: regular expression matching a pruning count line.
+counts = re.compile(r'^(.*):\s+(\d+)/(\d+)\s+[-.\d]+%$')
+
+# totals: regular expression matching a solution count line.
+totals = re.compile(r'^\s+(Accepted|Rejected):\s+(\d+)$')
+
+# dcd_atoms: read the number of atoms from a dcd header.
+#
+def dcd_atoms(f):
+  f.seek(0)
+  return unpack('=3i', f.read(header_size)[264:276])[1]
+
+# merge_dcd: concatenate the frames of several dcd files.
+#
+def merge_dcd(output, inputs):
+  # open the output file.
+  out = open(output, 'wb')
+  atoms = None
+  nframes = 0
+
+  # loop over the input files.
+  for filename in inputs:
+    # open the file and read its atom count.
+    f = open(filename, 'rb')
+    n = dcd_atoms(f)
+
+    # the first file provides the header, and the remaining files
+    # must match its atom count.
+    if atoms is None:
+      atoms = n
+      f.seek(0)
+    elif n != atoms:
+      raise ValueError('atom count mismatch in "{}"'.format(filename))
+
+    # copy the frames.
+    shutil.copyfileobj(f, out)
+    f.close()
+
+    # count the frames.
+    size = os.path.getsize(filename) - header_size
+    nframes += size // (24 + 12 * atoms)
+
+  # close the output file.
+  out.close()
+  print('wrote {} frames to "{}"'.format(nframes, output))
+
+# merge_report: sum the pruning and solution counts of several reports.
+#
+def merge_report(inputs):
+  # initialize the ordered sections and their counts.
+  sections = []
+  pruned = {}
+  sols = {'Accepted': 0, 'Rejected': 0}
+
+  # loop over the report files.
+  for filename in inputs:
+    section = None
+    for line in open(filename):
+      line = line.rstrip('\n')
+
+      # track the current pruning section.
+      if line.startswith('Pruning results'):
+        section = line
+        if section not in pruned:
+          sections.append(section)
+          pruned[section] = ([], {})
+        continue
+
+      # sum the solution counts.
+      m = totals.match(line)
+      if m:
+        sols[m.group(1)] += int(m.group(2))
+        continue
+
+      # sum the pruning counts within the current section.
+      m = counts.match(line)
+      if section and m:
+        order, lines = pruned[section]
+        label = m.group(1)
+        if label not in lines:
+          order.append(label)
+          lines[label] = [0, 0]
+        lines[label][0] += int(m.group(2))
+        lines[label][1] += int(m.group(3))
+      elif not line.startswith('  '):
+        section = None
+
+  # output the merged pruning counts.
+  for section in sections:
+    print('\n' + section)
+    order, lines = pruned[section]
+    for label in order:
+      np, nt = lines[label]
+      f = 100.0 * np / nt if nt else 0.0
+      print('{}: {:>16d}/{:<16d}  {:6.2f}%'.format(label, np, nt, f))
+
+  # output the merged solution counts.
+  print('\nSolutions:')
+  print('  Accepted: {:>16d}'.format(sols['Accepted']))
+  print('  Rejected: {:>16d}'.format(sols['Rejected']))
+
+# check the arguments.
+if len(sys.argv) >= 4 and sys.argv[1] == 'dcd':
+  merge_dcd(sys.argv[2], sys.argv[3:])
+elif len(sys.argv) >= 3 and sys.argv[1] == 'report':
+  merge_report(sys.argv[2:])
+else:
+  sys.stderr.write(usage)
+  sys.exit(1)
@@ -0,0 +1,508 @@
+
+/* include the enumerator headers. */
+#include "enum.h"
+#include "enum-checkpoint.h"
+#include "enum-prune.h"
+
+/* a checkpoint captures all the work that remains in an enumeration at
+ * a moment when every thread holding a range of the tree has stopped at
+ * a safe point (i.e. at the top of its search loop), and every solution
+ * found so far has been written to the output system.
+ *
+ * checkpoint files are written in native byte order, and hold:
+ *  - the magic string and the format version.
+ *  - the tree dimensions, the pruning methods and whether or not the
+ *    tree branches on reduced intervals, which must match when resuming.
+ *  - the frontier size and the index of its next unclaimed prefix.
+ *  - the solution counters, energy tolerance and output file size.
+ *  - the first and last leaves of the slice of the tree, which must
+ *    match the slice selected by the partition and prefix options.
+ *  - the merged pruning statistics counters.
+ *  - the level and node states of every range held by a thread.
+ *
+ * each checkpoint is written into a temporary file that then replaces
+ * the previous checkpoint, so that an interrupted write never destroys
+ * the last good checkpoint.
+ */
+
+/* ENUM_CHECKPOINT_NHDR: number of integers in the checkpoint header. */
+#define ENUM_CHECKPOINT_NHDR  13
+
+/* enum_checkpoint_put_range(): write the range of the tree held by an
+ * enumerator thread into a checkpoint file.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @th: pointer to the thread holding the range.
+ *  @fh: file handle of the checkpoint file.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_checkpoint_put_range (enum_t *E, enum_thread_t *th,
+                                      FILE *fh) {
+  /* write the level at which the range resumes. */
+  if (fwrite(&th->level, sizeof(unsigned int), 1, fh) != 1)
+    return 0;
+
+  /* write the state of each node in the range. */
+  for (unsigned int i = 0; i < E->G->n_order; i++) {
+    /* pack the indices of the node. */
+    const enum_thread_node_t *node = th->state + i;
+    const unsigned int idx[4] = { node->idx, node->start, node->end,
+                                  node->nb };
+
+    /* write the indices, positions and energy of the node. */
+    if (fwrite(idx, sizeof(unsigned int), 4, fh) != 4 ||
+        fwrite(&node->pos, sizeof(vector_t), 1, fh) != 1 ||
+        fwrite(&node->energy, sizeof(double), 1, fh) != 1)
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_checkpoint_get_range(): read a saved range of the tree from a
+ * checkpoint file.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @r: index of the saved range to read.
+ *  @fh: file handle of the checkpoint file.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_checkpoint_get_range (enum_t *E, unsigned int r,
+                                      FILE *fh) {
+  /* get the node states of the saved range. */
+  const unsigned int len = E->G->n_order;
+  enum_thread_node_t *state = E->resume_state + (unsigned long) r * len;
+
+  /* read the level at which the range resumes. */
+  if (fread(E->resume_level + r, sizeof(unsigned int), 1, fh) != 1)
+    return 0;
+
+  /* read the state of each node in the range. */
+  for (unsigned int i = 0; i < len; i++) {
+    /* read the indices, positions and energy of the node. */
+    unsigned int idx[4];
+    if (fread(idx, sizeof(unsigned int), 4, fh) != 4 ||
+        fread(&state[i].pos, sizeof(vector_t), 1, fh) != 1 ||
+        fread(&state[i].energy, sizeof(double), 1, fh) != 1)
+      return 0;
+
+    /* unpack the indices of the node. */
+    state[i].idx = idx[0];
+    state[i].start = idx[1];
+    state[i].end = idx[2];
+    state[i].nb = idx[3];
+  }
+
+  /* check that the range resumes within the tree. */
+  return (E->resume_level[r] < len);
+}
+
+/* enum_checkpoint_write(): write the remaining work of an enumerator
+ * into its checkpoint file. the caller must ensure that every thread
+ * holding a range of the tree is stopped at a safe point, and that all
+ * filled output frames have been written.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_checkpoint_write (enum_t *E) {
+  /* declare required variables:
+   *  @hdr: array of integer header values.
+   *  @nranges: number of ranges of the tree held by threads.
+   *  @offset: size of the output file, in bytes.
+   *  @fname: filename string of the temporary checkpoint file.
+   *  @fh: file handle of the temporary checkpoint file.
+   *  @ok: whether or not every write has succeeded.
+   */
+  unsigned int hdr[ENUM_CHECKPOINT_NHDR], nranges = 0;
+  long offset = 0;
+  char *fname;
+  FILE *fh;
+  int ok;
+
+  /* count the threads that hold ranges of the tree. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    if (E->threads[t].working)
+      nranges++;
+  }
+
+  /* flush the output file to disk, and get its size. */
+  if (E->fd >= 0) {
+    fdatasync(E->fd);
+    offset = lseek(E->fd, 0, SEEK_CUR);
+  }
+
+  /* build the filename of the temporary checkpoint file. */
+  fname = (char*) malloc((strlen(E->ckpt_fname) + 8) * sizeof(char));
+  if (!fname)
+    throw("unable to allocate filename string");
+
+  sprintf(fname, "%s.tmp", E->ckpt_fname);
+
+  /* open the temporary checkpoint file. */
+  fh = fopen(fname, "wb");
+  if (!fh) {
+    /* free allocated memory and return failure. */
+    raise("unable to open '%s' for writing", fname);
+    free(fname);
+    return 0;
+  }
+
+  /* build the header. */
+  hdr[0] = ENUM_CHECKPOINT_VERSION;
+  hdr[1] = E->G->n_order;
+  hdr[2] = E->G->n_orig;
+  hdr[3] = E->nbmax;
+  hdr[4] = E->nstats;
+  hdr[5] = E->frontier_depth;
+  hdr[6] = E->frontier_sz;
+  hdr[7] = E->frontier_next;
+  hdr[8] = __atomic_load_n(&E->nsol, __ATOMIC_RELAXED);
+  hdr[9] = __atomic_load_n(&E->nrej, __ATOMIC_RELAXED);
+  hdr[10] = nranges;
+  hdr[11] = E->reduce;
+  hdr[12] = E->prune_mask;
+
+  /* write the header. */
+  ok = (fwrite(ENUM_CHECKPOINT_MAGIC, 1, 8, fh) == 8 &&
+        fwrite(hdr, sizeof(unsigned int), ENUM_CHECKPOINT_NHDR, fh) ==
+          ENUM_CHECKPOINT_NHDR &&
+        fwrite(&E->eps, sizeof(double), 1, fh) == 1 &&
+        fwrite(&E->energy_tol, sizeof(double), 1, fh) == 1 &&
+        fwrite(&offset, sizeof(long), 1, fh) == 1 &&
+        fwrite(E->slice_lo, sizeof(unsigned int), E->G->n_order, fh) ==
+          E->G->n_order &&
+        fwrite(E->slice_hi, sizeof(unsigned int), E->G->n_order, fh) ==
+          E->G->n_order);
+
+  /* write the merged pruning statistics. */
+  for (unsigned int i = 0; ok && i < E->nstats; i++) {
+    const unsigned long val = enum_prune_get_stat(E, i);
+    ok = (fwrite(&val, sizeof(unsigned long), 1, fh) == 1);
+  }
+
+  /* write the range held by each working thread. */
+  for (unsigned int t = 0; ok && t < E->nthreads; t++) {
+    if (E->threads[t].working)
+      ok = enum_checkpoint_put_range(E, E->threads + t, fh);
+  }
+
+  /* flush the file to disk, and replace the previous checkpoint. */
+  ok = (ok && fflush(fh) == 0 && fsync(fileno(fh)) == 0);
+  ok = (fclose(fh) == 0 && ok);
+  ok = (ok && rename(fname, E->ckpt_fname) == 0);
+
+  /* check if any operation failed. */
+  if (!ok) {
+    /* remove the temporary file and return failure. */
+    raise("unable to write checkpoint to '%s'", fname);
+    unlink(fname);
+    free(fname);
+    return 0;
+  }
+
+  /* output an informational message about the checkpoint. */
+  E->ckpt_count++;
+  info("checkpoint %u: %u solutions, %u ranges, %u of %u prefixes",
+       E->ckpt_count, hdr[8], nranges, E->frontier_next, E->frontier_sz);
+
+  /* free the filename string and return success. */
+  free(fname);
+  return 1;
+}
+
+#ifdef __IBP_HAVE_PTHREAD
+
+/* enum_checkpoint_poll(): write a requested checkpoint once every
+ * thread holding a range of the tree has stopped at a safe point. the
+ * scheduler lock must be held by the caller.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ */
+static void enum_checkpoint_poll (enum_t *E) {
+  /* define the delay between polls of the writer thread. */
+  const struct timespec delay = { 0, 100000 };
+
+  /* return if no checkpoint is requested, or if any working thread has
+   * not yet reached a safe point.
+   */
+  if (!__atomic_load_n(&E->ckpt_req, __ATOMIC_RELAXED) ||
+      E->ckpt_parked < E->nthreads - E->nidle)
+    return;
+
+  /* wait for the writer thread to write every filled frame. */
+  while (__atomic_load_n(&E->write_frames, __ATOMIC_ACQUIRE) <
+         __atomic_load_n(&E->frame_head, __ATOMIC_RELAXED))
+    nanosleep(&delay, NULL);
+
+  /* write the checkpoint. */
+  enum_checkpoint_write(E);
+
+  /* clear the request, and terminate if requested. */
+  __atomic_store_n(&E->ckpt_req, 0, __ATOMIC_RELAXED);
+  if (E->ckpt_stop)
+    __atomic_store_n(&E->term, 1, __ATOMIC_RELAXED);
+
+  /* wake up the waiting threads. */
+  pthread_cond_broadcast(&E->sched_cond);
+}
+
+#endif /* __IBP_HAVE_PTHREAD */
+
+/* enum_checkpoint_park(): stop an enumerator thread at a safe point of
+ * its search until a requested checkpoint has been written. the last
+ * working thread to stop writes the checkpoint.
+ *
+ * arguments:
+ *  @th: pointer to the thread to stop.
+ *  @lev: next level to be embedded by the thread.
+ */
+void enum_checkpoint_park (enum_thread_t *th, unsigned int lev) {
+  /* get a reference to the enumerator. */
+  enum_t *E = th->E;
+
+  /* store the level at which the range of the thread resumes. */
+  th->level = lev;
+
+#ifdef __IBP_HAVE_PTHREAD
+  /* obtain a lock on the scheduler, and mark the thread as stopped. */
+  pthread_mutex_lock(&E->sched_mutex);
+  E->ckpt_parked++;
+
+  /* wait until the checkpoint has been written. */
+  while (1) {
+    /* write the checkpoint if every working thread has stopped. */
+    enum_checkpoint_poll(E);
+    if (!E->ckpt_req)
+      break;
+
+    /* wait for the next scheduler event. */
+    pthread_cond_wait(&E->sched_cond, &E->sched_mutex);
+  }
+
+  /* mark the thread as running, and release the lock. */
+  E->ckpt_parked--;
+  pthread_mutex_unlock(&E->sched_mutex);
+#else
+  /* single-threaded: every solution has already been written. */
+  enum_checkpoint_write(E);
+  E->ckpt_req = 0;
+
+  /* terminate if requested. */
+  if (E->ckpt_stop)
+    E->term = 1;
+#endif
+}
+
+/* enum_checkpoint_load(): read the contents of an open checkpoint file
+ * into an enumerator.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *  @fh: file handle of the checkpoint file.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_checkpoint_load (enum_t *E, FILE *fh) {
+  /* declare required variables:
+   *  @magic: magic string read from the file.
+   *  @hdr: array of integer header values.
+   *  @eps: discretization size of the checkpointed enumeration.
+   */
+  unsigned int hdr[ENUM_CHECKPOINT_NHDR];
+  char magic[8];
+  double eps;
+
+  /* read and check the magic string and the header. */
+  if (fread(magic, 1, 8, fh) != 8 ||
+      memcmp(magic, ENUM_CHECKPOINT_MAGIC, 8) ||
+      fread(hdr, sizeof(unsigned int), ENUM_CHECKPOINT_NHDR, fh) !=
+        ENUM_CHECKPOINT_NHDR)
+    throw("invalid checkpoint header");
+
+  /* check the format version. */
+  if (hdr[0] != ENUM_CHECKPOINT_VERSION)
+    throw("unsupported checkpoint version %u", hdr[0]);
+
+  /* check that the tree dimensions match. */
+  if (hdr[1] != E->G->n_order || hdr[2] != E->G->n_orig ||
+      hdr[3] != E->nbmax || hdr[4] != E->nstats)
+    throw("checkpoint does not match the current graph and options");
+
+  /* check that the pruning methods and the branching mode match. */
+  if (hdr[11] != E->reduce || hdr[12] != E->prune_mask)
+    throw("checkpoint does not match the current pruning and branching "
+          "options");
+
+  /* check that no rmsd diversity index is in use, as it is not saved. */
+  if (E->rmsd_tol > 0.0)
+    throw("checkpoints do not hold the rmsd diversity index");
+
+  /* read the scalar values. */
+  if (fread(&eps, sizeof(double), 1, fh) != 1 ||
+      fread(&E->resume_tol, sizeof(double), 1, fh) != 1 ||
+      fread(&E->resume_offset, sizeof(long), 1, fh) != 1)
+    throw("invalid checkpoint header");
+
+  /* check that the discretization matches. */
+  if (eps != E->eps)
+    throw("checkpoint does not match the current branch epsilon");
+
+  /* allocate and read the bounds of the checkpointed slice. */
+  const unsigned int len = E->G->n_order;
+  E->resume_slice = (unsigned int*) malloc(2 * len * sizeof(unsigned int));
+  if (!E->resume_slice)
+    throw("unable to allocate checkpoint slice bounds");
+
+  if (fread(E->resume_slice, sizeof(unsigned int), 2 * len, fh) != 2 * len)
+    throw("invalid checkpoint slice bounds");
+
+  /* store the frontier and the solution counters. */
+  E->resume_depth = hdr[5];
+  E->resume_prefixes = hdr[6];
+  E->resume_frontier = hdr[7];
+  E->nsol = hdr[8];
+  E->nrej = hdr[9];
+  E->resume_sz = hdr[10];
+  E->resume_next = 0;
+
+  /* allocate the saved statistics and ranges. */
+  E->resume_stats = (unsigned long*)
+    malloc((E->nstats ? E->nstats : 1) * sizeof(unsigned long));
+  E->resume_level = (unsigned int*)
+    malloc((E->resume_sz ? E->resume_sz : 1) * sizeof(unsigned int));
+  E->resume_state = (enum_thread_node_t*)
+    calloc((unsigned long) (E->resume_sz ? E->resume_sz : 1) *
+           E->G->n_order, sizeof(enum_thread_node_t));
+
+  /* check that allocation succeeded. */
+  if (!E->resume_stats || !E->resume_level || !E->resume_state)
+    throw("unable to allocate %u saved ranges", E->resume_sz);
+
+  /* read the merged pruning statistics. */
+  if (fread(E->resume_stats, sizeof(unsigned long), E->nstats, fh) !=
+      E->nstats)
+    throw("invalid checkpoint statistics");
+
+  /* read the saved ranges. */
+  for (unsigned int r = 0; r < E->resume_sz; r++) {
+    if (!enum_checkpoint_get_range(E, r, fh))
+      throw("invalid checkpoint range %u", r + 1);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_checkpoint_read(): read the checkpoint file of an enumerator
+ * in preparation for resuming the enumeration. the solution counters
+ * are restored immediately, and the remaining contents are held until
+ * enum_checkpoint_restore() is called.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_checkpoint_read (enum_t *E) {
+  /* open the checkpoint file. */
+  FILE *fh = fopen(E->ckpt_fname, "rb");
+  if (!fh)
+    throw("unable to open checkpoint '%s'", E->ckpt_fname);
+
+  /* read the contents of the file. */
+  const int ret = enum_checkpoint_load(E, fh);
+  fclose(fh);
+
+  /* check if reading failed. */
+  if (!ret)
+    throw("unable to read checkpoint '%s'", E->ckpt_fname);
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_checkpoint_restore(): restore the remaining contents of a read
+ * checkpoint into the threads of an enumerator. this must be called
+ * after the threads and the breadth-first frontier have been initialized.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_checkpoint_restore (enum_t *E) {
+  /* get the length of the order and the branch counts of the tree. */
+  const unsigned int len = E->G->n_order;
+  const enum_thread_node_t *tree = E->threads[0].state;
+
+  /* check that the slice of the tree matches the checkpoint. */
+  if (memcmp(E->resume_slice, E->slice_lo, len * sizeof(unsigned int)) ||
+      memcmp(E->resume_slice + len, E->slice_hi,
+             len * sizeof(unsigned int)))
+    throw("checkpoint slice does not match the current partition "
+          "and prefix");
+
+  /* check that the frontier matches the checkpoint. */
+  if (E->frontier_depth != E->resume_depth ||
+      E->frontier_sz != E->resume_prefixes ||
+      E->resume_frontier > E->frontier_sz)
+    throw("checkpoint frontier (%u prefixes) does not match the "
+          "current frontier (%u prefixes)",
+          E->resume_prefixes, E->frontier_sz);
+
+  /* check that the branch counts of every saved range match. */
+  for (unsigned int r = 0; r < E->resume_sz; r++) {
+    const enum_thread_node_t *state = E->resume_state +
+                                      (unsigned long) r * len;
+
+    for (unsigned int i = 0; i < len; i++) {
+      if (state[i].nb != tree[i].nb || state[i].end >= tree[i].nb)
+        throw("checkpoint range %u does not match the current tree", r + 1);
+    }
+  }
+
+  /* skip the frontier prefixes that were claimed before the checkpoint. */
+  E->frontier_next = E->resume_frontier;
+
+  /* restore the energy tolerance. */
+  E->energy_tol = E->resume_tol;
+
+  /* restore the merged statistics into the first thread, replacing the
+   * counts gathered while the frontier was expanded again.
+   */
+  for (unsigned int t = 0; t < E->nthreads; t++)
+    memset(E->threads[t].stats, 0, E->nstats * sizeof(unsigned long));
+
+  memcpy(E->threads[0].stats, E->resume_stats,
+         E->nstats * sizeof(unsigned long));
+
+  /* every thread begins idle, and obtains work from the saved ranges. */
+  for (unsigned int t = 0; t < E->nthreads; t++)
+    E->threads[t].working = E->threads[t].granted = 0;
+
+  /* update the global scheduler state. */
+  E->nidle = E->nthreads;
+
+  /* output an informational message about the resumed work. */
+  info("resuming: %u solutions, %u ranges, %u of %u prefixes",
+       E->nsol, E->resume_sz, E->frontier_next, E->frontier_sz);
+
+  /* return success. */
+  return 1;
+}
+
@@ -0,0 +1,14 @@
+
+/* ensure once-only inclusion. */
+#pragma once
+
+/* function declarations (enum-checkpoint.c): */
+
+int enum_checkpoint_write (enum_t *E);
+
+void enum_checkpoint_park (enum_thread_t *th, unsigned int lev);
+
+int enum_checkpoint_read (enum_t *E);
+
+int enum_checkpoint_restore (enum_t *E);
+
@@ -0,0 +1,567 @@
+/* include the enumerator headers. */
+#include "enum.h"
+#include "enum-nogood.h"
+
+/* a nogood is a short tuple of branch indices (idx[c], ..., idx[lev]) at
+ * consecutive levels of the tree, which is infeasible regardless of the
+ * branches taken above level c. levels that only hold a single branch,
+ * such as those of duplicate atoms, are left out of the tuple. such
+ * tuples are found from the culprits of failed tests: the position of
+ * the atom at a level relative to the three atoms preceding level c
+ * only depends on the branches at levels c and deeper, so a failed
+ * distance test against one of those atoms fails again whenever the
+ * same tuple reappears under another parent.
+ *
+ * nogoods are stored in a single open-addressed hash table shared by all
+ * threads. each entry holds two independent 64-bit hashes of its level,
+ * length and branch indices. the first hash selects the slot and marks
+ * it as occupied, and the second confirms a match, so that two distinct
+ * tuples are only ever confused if both of their hashes collide. entries
+ * are claimed using an atomic compare-and-swap, and are never removed:
+ * once the probe sequence of a new nogood is full, the nogood is simply
+ * dropped. a reader that finds a claimed entry whose second hash is not
+ * yet written treats it as a miss, which is always safe.
+ *
+ * nogood files are written in native byte order, and hold:
+ *  - the magic string and the format version.
+ *  - the tree dimensions and a signature of the embedding plans and
+ *    prune kernels, which must match when loading.
+ *  - the bit masks of nogood lengths stored at each level.
+ *  - the two hashes of every stored nogood.
+ */
+
+/* ENUM_NOGOOD_NHDR: number of integers in the nogood file header. */
+#define ENUM_NOGOOD_NHDR  5
+
+/* enum_nogood_fmix(): scramble the bits of a 64-bit hash value.
+ *
+ * arguments:
+ *  @h: hash value to scramble.
+ *
+ * returns:
+ *  scrambled hash value.
+ */
+static inline unsigned long enum_nogood_fmix (unsigned long h) {
+  /* apply the murmur3 finalizer. */
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdUL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53UL;
+  h ^= h >> 33;
+  return h;
+}
+
+/* enum_nogood_fnv(): fold an array of bytes into a 64-bit signature.
+ *
+ * arguments:
+ *  @h: current value of the signature.
+ *  @ptr: pointer to the bytes to fold.
+ *  @n: number of bytes to fold.
+ *
+ * returns:
+ *  updated value of the signature.
+ */
+static unsigned long enum_nogood_fnv (unsigned long h, const void *ptr,
+                                      const unsigned long n) {
+  /* apply the fnv-1a hash to each byte. */
+  const unsigned char *b = (const unsigned char*) ptr;
+  for (unsigned long i = 0; i < n; i++)
+    h = (h ^ b[i]) * 0x100000001b3UL;
+
+  return h;
+}
+
+/* enum_nogood_sig(): compute the signature of the instance that the
+ * nogoods of an enumerator hold for. nogoods only remain valid when
+ * the embedding plans and the merged distance and dihedral tests of
+ * every level are unchanged.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *
+ * returns:
+ *  signature of the enumerated instance.
+ */
+static unsigned long enum_nogood_sig (enum_t *E) {
+  /* initialize the signature. */
+  unsigned long h = 0xcbf29ce484222325UL;
+
+  /* loop over the levels of the tree. */
+  for (unsigned int lev = 0; lev < E->G->n_order; lev++) {
+    /* fold in the duplicate offset of the level. */
+    h = enum_nogood_fnv(h, E->G->orig + lev, sizeof(unsigned int));
+
+    /* fold in the embedding plan of the level. */
+    const enum_plan_t *plan = E->plan + lev;
+    h = enum_nogood_fnv(h, &plan->d13, sizeof(double));
+    h = enum_nogood_fnv(h, &plan->d23, sizeof(double));
+    h = enum_nogood_fnv(h, &plan->ct, sizeof(double));
+    h = enum_nogood_fnv(h, &plan->st, sizeof(double));
+    h = enum_nogood_fnv(h, &plan->dihed, sizeof(unsigned int));
+    h = enum_nogood_fnv(h, &plan->nb, sizeof(unsigned int));
+    if (plan->w && plan->sig) {
+      h = enum_nogood_fnv(h, plan->w, plan->nb * sizeof(double));
+      h = enum_nogood_fnv(h, plan->sig, plan->nb * sizeof(double));
+    }
+
+    /* fold in the two-sided distance tests of the level, which may be
+     * reordered by their prune rates, as a sum that ignores their order.
+     */
+    const enum_kernel_t *K = E->kern + lev;
+    unsigned long hp = 0;
+    for (unsigned int i = 0; i < K->n_pair; i++) {
+      unsigned long hi = 0xcbf29ce484222325UL;
+      hi = enum_nogood_fnv(hi, &K->pair[i].lev, sizeof(unsigned int));
+      hi = enum_nogood_fnv(hi, &K->pair[i].lo2, sizeof(double));
+      hi = enum_nogood_fnv(hi, &K->pair[i].hi2, sizeof(double));
+      hp += hi;
+    }
+
+    h = enum_nogood_fnv(h, &hp, sizeof(unsigned long));
+
+    for (unsigned int i = 0; i < K->n_upper; i++) {
+      h = enum_nogood_fnv(h, &K->upper[i].lev, sizeof(unsigned int));
+      h = enum_nogood_fnv(h, &K->upper[i].lo2, sizeof(double));
+      h = enum_nogood_fnv(h, &K->upper[i].hi2, sizeof(double));
+    }
+
+    /* fold in the dihedral tests of the level. */
+    for (unsigned int i = 0; i < K->n_quad; i++) {
+      h = enum_nogood_fnv(h, K->quad[i].lev, 4 * sizeof(unsigned int));
+      h = enum_nogood_fnv(h, &K->quad[i].l, sizeof(double));
+      h = enum_nogood_fnv(h, &K->quad[i].u, sizeof(double));
+    }
+  }
+
+  /* return the signature. */
+  return h;
+}
+
+/* enum_nogood_probe(): look up a nogood in the table of an enumerator,
+ * and optionally add it when absent.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @k1: first hash of the nogood, which selects its slot.
+ *  @k2: second hash of the nogood, which confirms a match.
+ *  @add: whether or not to add the nogood when absent.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the nogood was found,
+ *  or was added when requested.
+ */
+static int enum_nogood_probe (enum_t *E, const unsigned long k1,
+                              const unsigned long k2, const int add) {
+  /* get the table, and loop over the probe sequence. */
+  unsigned long *key = E->nogood_key;
+  for (unsigned int i = 0; i < ENUM_NOGOOD_PROBE; i++) {
+    /* get the slot and its current occupant. */
+    const unsigned long s = 2 * ((k1 + i) & (ENUM_NOGOOD_SLOTS - 1));
+    unsigned long cur = __atomic_load_n(key + s, __ATOMIC_ACQUIRE);
+
+    /* claim an empty slot, if requested. */
+    if (!cur) {
+      if (!add)
+        return 0;
+
+      if (__atomic_compare_exchange_n(key + s, &cur, k1, 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* publish the second hash, and count the nogood. */
+        __atomic_store_n(key + s + 1, k2, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&E->nogood_n, 1, __ATOMIC_RELAXED);
+        return 1;
+      }
+    }
+
+    /* check for a match. */
+    if (cur == k1 && __atomic_load_n(key + s + 1, __ATOMIC_ACQUIRE) == k2)
+      return 1;
+  }
+
+  /* the probe sequence is full. */
+  if (add)
+    __atomic_add_fetch(&E->nogood_lost, 1, __ATOMIC_RELAXED);
+
+  return 0;
+}
+
+/* enum_nogood_final(): finalize the two hashes of a nogood.
+ *
+ * arguments:
+ *  @h1, @h2: running hashes of the branch indices of the nogood.
+ *  @k: number of branching levels of the nogood, minus one.
+ *  @k1, @k2: output final hashes, which are never zero.
+ */
+static inline void enum_nogood_final (const unsigned long h1,
+                                      const unsigned long h2,
+                                      const unsigned int k,
+                                      unsigned long *k1,
+                                      unsigned long *k2) {
+  /* mix the length of the nogood into each hash. */
+  *k1 = enum_nogood_fmix(h1 ^ k);
+  *k2 = enum_nogood_fmix(h2 + k);
+
+  /* zero marks empty slots and unwritten entries. */
+  if (!*k1) *k1 = 1;
+  if (!*k2) *k2 = 1;
+}
+
+/* enum_nogood_fold(): fold the branch index of a node into the running
+ * hashes of a nogood.
+ *
+ * arguments:
+ *  @node: pointer to the node to fold in.
+ *  @h1, @h2: running hashes to update.
+ */
+static inline void enum_nogood_fold (const enum_thread_node_t *node,
+                                     unsigned long *h1,
+                                     unsigned long *h2) {
+  /* combine the offset branch index into each hash. */
+  const unsigned long x = node->idx + 1;
+  *h1 = (*h1 ^ x) * 0x100000001b3UL;
+  *h2 = (*h2 + x) * 0x9e3779b97f4a7c15UL;
+}
+
+/* enum_nogood_find(): check whether the current node at a level of an
+ * enumerator thread completes a stored nogood. the shortest matching
+ * nogood is preferred, as it holds under the most parents.
+ *
+ * arguments:
+ *  @th: pointer to the enumerator thread to access.
+ *  @lev: level of the node to check.
+ *
+ * returns:
+ *  shallowest branching level of the matching nogood, or zero if no
+ *  stored nogood matches the node.
+ */
+unsigned int enum_nogood_find (enum_thread_t *th, unsigned int lev) {
+  /* get the lengths of the nogoods stored at the level. */
+  enum_t *E = th->E;
+  const unsigned int mask =
+    __atomic_load_n(E->nogood_spans + lev, __ATOMIC_RELAXED);
+
+  /* return if no nogoods are stored at the level. */
+  if (!mask)
+    return 0;
+
+  /* seed the running hashes with the level. */
+  const enum_thread_node_t *state = th->state;
+  unsigned long h1 = enum_nogood_fmix(lev + 1);
+  unsigned long h2 = enum_nogood_fmix(~((unsigned long) lev));
+
+  /* loop upwards over the branching levels of the candidate nogoods. */
+  for (unsigned int j = lev, k = 0; j >= 3 && k < ENUM_NOGOOD_SPAN; j--) {
+    /* levels with a single branch are not part of any nogood. */
+    if (state[j].nb <= 1)
+      continue;
+
+    /* look up the nogood of the current length, if any are stored. */
+    enum_nogood_fold(state + j, &h1, &h2);
+    if (mask & (1U << k)) {
+      unsigned long k1, k2;
+      enum_nogood_final(h1, h2, k, &k1, &k2);
+      if (enum_nogood_probe(E, k1, k2, 0))
+        return j;
+    }
+
+    /* stop once no longer nogoods are stored. */
+    if (!(mask >> ++k))
+      break;
+  }
+
+  /* no stored nogood matches the node. */
+  return 0;
+}
+
+/* enum_nogood_insert(): store the branch indices of an enumerator thread
+ * between two levels as a nogood. only levels having more than a single
+ * branch are held in the nogood, and nogoods that span too many such
+ * levels, or that reach the first three levels, are ignored.
+ *
+ * arguments:
+ *  @th: pointer to the enumerator thread to access.
+ *  @lev: deepest level of the nogood.
+ *  @c: shallowest level of the nogood. failures that do not even depend
+ *      on the branch at @lev are stored as nogoods of that branch alone.
+ */
+void enum_nogood_insert (enum_thread_t *th, unsigned int lev,
+                         unsigned int c) {
+  /* get a reference to the enumerator. */
+  enum_t *E = th->E;
+
+  /* check the extent of the nogood. */
+  if (c > lev)
+    c = lev;
+
+  if (c < E->nogood_reach[lev])
+    return;
+
+  /* seed the running hashes with the level. */
+  const enum_thread_node_t *state = th->state;
+  unsigned long h1 = enum_nogood_fmix(lev + 1);
+  unsigned long h2 = enum_nogood_fmix(~((unsigned long) lev));
+
+  /* fold in the branch index of each branching level of the nogood. */
+  unsigned int k = 0;
+  for (unsigned int j = lev; j >= c; j--) {
+    if (state[j].nb > 1) {
+      enum_nogood_fold(state + j, &h1, &h2);
+      k++;
+    }
+  }
+
+  /* nogoods without branches cannot be represented. */
+  if (!k--)
+    return;
+
+  /* add the nogood, and mark its length as stored at the level. */
+  unsigned long k1, k2;
+  enum_nogood_final(h1, h2, k, &k1, &k2);
+  if (enum_nogood_probe(E, k1, k2, 1) &&
+      !(__atomic_load_n(E->nogood_spans + lev, __ATOMIC_RELAXED) &
+        (1U << k)))
+    __atomic_fetch_or(E->nogood_spans + lev, 1U << k, __ATOMIC_RELAXED);
+}
+
+/* enum_nogood_load(): read the contents of a nogood file into the table
+ * of an enumerator.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *  @fh: file handle of the nogood file.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the file matched the
+ *  current instance and was read successfully.
+ */
+static int enum_nogood_load (enum_t *E, FILE *fh) {
+  /* declare required variables:
+   *  @magic: magic string read from the file.
+   *  @hdr: array of integer header values.
+   *  @eps: discretization size read from the file.
+   *  @sig: instance signature read from the file.
+   *  @n: number of nogoods held by the file.
+   */
+  char magic[8];
+  unsigned int hdr[ENUM_NOGOOD_NHDR];
+  double eps;
+  unsigned long sig, n;
+
+  /* read and check the header. */
+  if (fread(magic, 1, 8, fh) != 8 ||
+      memcmp(magic, ENUM_NOGOOD_MAGIC, 8) ||
+      fread(hdr, sizeof(unsigned int), ENUM_NOGOOD_NHDR, fh) !=
+        ENUM_NOGOOD_NHDR ||
+      fread(&eps, sizeof(double), 1, fh) != 1 ||
+      fread(&sig, sizeof(unsigned long), 1, fh) != 1 ||
+      fread(&n, sizeof(unsigned long), 1, fh) != 1)
+    return 0;
+
+  /* check that the file belongs to the current instance. */
+  if (hdr[0] != ENUM_NOGOOD_VERSION ||
+      hdr[1] != E->G->n_order ||
+      hdr[2] != E->G->n_orig ||
+      hdr[3] != E->nbmax ||
+      hdr[4] != ENUM_NOGOOD_SPAN ||
+      eps != E->eps || sig != E->nogood_sig)
+    return 0;
+
+  /* read the nogood lengths stored at each level. */
+  if (fread(E->nogood_spans, sizeof(unsigned int), E->G->n_order, fh) !=
+      E->G->n_order)
+    return 0;
+
+  /* read and add each nogood. */
+  for (unsigned long i = 0; i < n; i++) {
+    unsigned long k[2];
+    if (fread(k, sizeof(unsigned long), 2, fh) != 2)
+      return 0;
+
+    enum_nogood_probe(E, k[0], k[1], 1);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_nogood_init(): allocate the nogood table of an enumerator, and
+ * fill it from the nogood file, if one exists. this must be called
+ * after the embedding plans and prune kernels have been computed.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_nogood_init (enum_t *E) {
+  /* free any table from a previous enumeration. */
+  enum_nogood_free(E);
+
+  /* allocate and clear the table and the stored lengths. */
+  const unsigned int len = E->G->n_order;
+  E->nogood_key = (unsigned long*)
+    calloc(2 * (unsigned long) ENUM_NOGOOD_SLOTS, sizeof(unsigned long));
+  E->nogood_spans = (unsigned int*) calloc(len, sizeof(unsigned int));
+  E->nogood_reach = (unsigned int*) malloc(len * sizeof(unsigned int));
+
+  if (!E->nogood_key || !E->nogood_spans || !E->nogood_reach)
+    throw("unable to allocate nogood table");
+
+  /* find the shallowest start of a nogood ending at each level, such
+   * that it holds at most ENUM_NOGOOD_SPAN branching levels and none
+   * of the first three levels.
+   */
+  const enum_thread_node_t *state = E->threads[0].state;
+  for (unsigned int lev = 0; lev < len; lev++) {
+    unsigned int j = lev + 1, k = 0;
+    while (j > 3 && (k < ENUM_NOGOOD_SPAN || state[j - 1].nb <= 1))
+      k += (state[--j].nb > 1);
+
+    E->nogood_reach[lev] = j;
+  }
+
+  /* compute the signature of the instance. */
+  E->nogood_sig = enum_nogood_sig(E);
+
+  /* return if no nogood file was requested. */
+  if (!E->nogood_fname)
+    return 1;
+
+  /* a missing nogood file is created at the end of the enumeration. */
+  FILE *fh = fopen(E->nogood_fname, "rb");
+  if (!fh)
+    return 1;
+
+  /* read the contents of the file. */
+  const int ret = enum_nogood_load(E, fh);
+  fclose(fh);
+
+  /* nogoods from a mismatched or damaged file are discarded. */
+  if (!ret) {
+    warn("discarding nogoods from '%s'", E->nogood_fname);
+    memset(E->nogood_key, 0,
+           2 * (unsigned long) ENUM_NOGOOD_SLOTS * sizeof(unsigned long));
+    memset(E->nogood_spans, 0, E->G->n_order * sizeof(unsigned int));
+    E->nogood_n = E->nogood_lost = 0;
+    return 1;
+  }
+
+  /* output an informational message about the loaded nogoods. */
+  E->nogood_loaded = E->nogood_n;
+  info("loaded %lu nogoods from '%s'", E->nogood_n, E->nogood_fname);
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_nogood_free(): free the nogood table of an enumerator.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ */
+void enum_nogood_free (enum_t *E) {
+  /* free the table and the stored lengths. */
+  free(E->nogood_key);
+  free(E->nogood_spans);
+  free(E->nogood_reach);
+
+  /* reset the table. */
+  E->nogood_key = NULL;
+  E->nogood_spans = E->nogood_reach = NULL;
+  E->nogood_n = E->nogood_lost = E->nogood_loaded = 0;
+}
+
+/* enum_nogood_save(): write the nogood table of an enumerator into its
+ * nogood file. the caller must ensure that no thread is running.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_nogood_save (enum_t *E) {
+  /* declare required variables:
+   *  @hdr: array of integer header values.
+   *  @fname: filename string of the temporary nogood file.
+   *  @fh: file handle of the temporary nogood file.
+   *  @ok: whether or not every write has succeeded.
+   */
+  unsigned int hdr[ENUM_NOGOOD_NHDR];
+  char *fname;
+  FILE *fh;
+  int ok;
+
+  /* return if there is no table to write. */
+  if (!E->nogood_fname || !E->nogood_key)
+    return 1;
+
+  /* build the filename of the temporary nogood file. */
+  fname = (char*) malloc((strlen(E->nogood_fname) + 8) * sizeof(char));
+  if (!fname)
+    throw("unable to allocate filename string");
+
+  sprintf(fname, "%s.tmp", E->nogood_fname);
+
+  /* open the temporary nogood file. */
+  fh = fopen(fname, "wb");
+  if (!fh) {
+    /* free allocated memory and return failure. */
+    raise("unable to open '%s' for writing", fname);
+    free(fname);
+    return 0;
+  }
+
+  /* count the complete entries of the table. */
+  const unsigned long *key = E->nogood_key;
+  unsigned long n = 0;
+  for (unsigned long s = 0; s < 2 * (unsigned long) ENUM_NOGOOD_SLOTS;
+       s += 2) {
+    if (key[s] && key[s + 1])
+      n++;
+  }
+
+  /* build the header. */
+  hdr[0] = ENUM_NOGOOD_VERSION;
+  hdr[1] = E->G->n_order;
+  hdr[2] = E->G->n_orig;
+  hdr[3] = E->nbmax;
+  hdr[4] = ENUM_NOGOOD_SPAN;
+
+  /* write the header and the stored lengths. */
+  ok = (fwrite(ENUM_NOGOOD_MAGIC, 1, 8, fh) == 8 &&
+        fwrite(hdr, sizeof(unsigned int), ENUM_NOGOOD_NHDR, fh) ==
+          ENUM_NOGOOD_NHDR &&
+        fwrite(&E->eps, sizeof(double), 1, fh) == 1 &&
+        fwrite(&E->nogood_sig, sizeof(unsigned long), 1, fh) == 1 &&
+        fwrite(&n, sizeof(unsigned long), 1, fh) == 1 &&
+        fwrite(E->nogood_spans, sizeof(unsigned int), E->G->n_order, fh) ==
+          E->G->n_order);
+
+  /* write the complete entries of the table. */
+  for (unsigned long s = 0;
+       ok && s < 2 * (unsigned long) ENUM_NOGOOD_SLOTS; s += 2) {
+    if (key[s] && key[s + 1])
+      ok = (fwrite(key + s, sizeof(unsigned long), 2, fh) == 2);
+  }
+
+  /* flush the file to disk, and replace the previous nogood file. */
+  ok = (ok && fflush(fh) == 0 && fsync(fileno(fh)) == 0);
+  ok = (fclose(fh) == 0 && ok);
+  ok = (ok && rename(fname, E->nogood_fname) == 0);
+
+  /* check if any operation failed. */
+  if (!ok) {
+    /* remove the temporary file and return failure. */
+    raise("unable to write nogoods to '%s'", fname);
+    unlink(fname);
+    free(fname);
+    return 0;
+  }
+
+  /* free the filename string and return success. */
+  free(fname);
+  return 1;
+}
+
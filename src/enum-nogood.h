@@ -0,0 +1,17 @@
+
+/* ensure once-only inclusion. */
+#pragma once
+
+/* function declarations (enum-nogood.c): */
+
+int enum_nogood_init (enum_t *E);
+
+void enum_nogood_free (enum_t *E);
+
+int enum_nogood_save (enum_t *E);
+
+unsigned int enum_nogood_find (enum_thread_t *th, unsigned int lev);
+
+void enum_nogood_insert (enum_thread_t *th, unsigned int lev,
+                         unsigned int c);
+
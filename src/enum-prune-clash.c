@@ -0,0 +1,338 @@
+
+/* include the enumerator header. */
+#include "enum.h"
+#include "enum-thread.h"
+#include "enum-prune.h"
+
+/* the clash pruner checks each newly embedded atom against the earlier
+ * atoms of its path for van der waals overlaps, i.e. distances below the
+ * sum of their radii. every thread holds the positions of the atoms on
+ * its current path in a uniform grid having the largest sum of radii as
+ * its spacing, hashed into buckets, so that only the 27 neighbouring
+ * cells of the new atom can hold atoms that overlap it.
+ *
+ * the grid is updated lazily by the checks themselves: a check at a
+ * level first removes the deeper levels left over from the previous
+ * path, whose positions are being replaced, and then adds the levels
+ * above it that the grid does not hold yet. as the tree is traversed
+ * depth-first, the bucket lists are ordered from deepest to shallowest,
+ * and removals only ever unlink their heads. the grid is emptied when
+ * the positions that it holds move as a whole, i.e. when a thread takes
+ * up another range of the tree, and after every leaf, whose solution is
+ * centered in place.
+ *
+ * pairs of atoms whose graph edge admits distances below the sum of
+ * their radii, e.g. bonded atoms, are left to the distance pruners.
+ */
+
+/* enum_prune_clash_t: structure for holding information required for
+ * van der waals clash pruning closures.
+ */
+typedef struct {
+  /* @stat: index of the test and prune counters of the closure.
+   * @n: number of excluded earlier levels.
+   * @excl: array of earlier levels that are not checked for clashes.
+   */
+  unsigned int stat, n;
+  unsigned int excl[];
+}
+enum_prune_clash_t;
+
+/* enum_prune_clash_hash(): compute the clash grid bucket of a cell.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @c: array of grid cell indices.
+ *
+ * returns:
+ *  bucket index of the grid cell.
+ */
+static inline unsigned int enum_prune_clash_hash (const enum_t *E,
+                                                  const long *c) {
+  /* combine the cell indices using large primes. */
+  const unsigned long h = ((unsigned long) c[0] * 73856093UL) ^
+                          ((unsigned long) c[1] * 19349663UL) ^
+                          ((unsigned long) c[2] * 83492791UL);
+
+  /* return the bucket index. */
+  return (unsigned int) (h & E->clash_mask);
+}
+
+/* enum_prune_clash_cell(): compute the clash grid cell of a position.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @x: pointer to the position.
+ *  @c: output array of grid cell indices.
+ */
+static inline void enum_prune_clash_cell (const enum_t *E,
+                                          const vector_t *x, long *c) {
+  /* divide each coordinate by the grid spacing. */
+  c[0] = (long) floor(x->x / E->clash_grid);
+  c[1] = (long) floor(x->y / E->clash_grid);
+  c[2] = (long) floor(x->z / E->clash_grid);
+}
+
+/* enum_prune_clash_init(): initialize the clash pruner.
+ */
+int enum_prune_clash_init (enum_t *E, unsigned int lev) {
+  /* declare required variables:
+   *  @data: closure data pointer.
+   *  @n: number of excluded earlier levels.
+   */
+  enum_prune_clash_t *data;
+  unsigned int n;
+
+  /* locally store the graph, re-order and originality arrays. */
+  graph_t *G = E->G;
+  const unsigned int *order = G->order;
+  const unsigned int *dup = G->orig;
+
+  /* tabulate the radii of every level on first use. */
+  if (!E->clash_rad) {
+    E->clash_rad = (double*) malloc(G->n_order * sizeof(double));
+    if (!E->clash_rad)
+      throw("unable to allocate clash radii");
+
+    /* the grid spacing is the largest sum of two radii. */
+    double rmax = 0.0;
+    for (unsigned int i = 0; i < G->n_order; i++) {
+      E->clash_rad[i] = E->P->atoms[order[i]].radius;
+      if (E->clash_rad[i] > rmax)
+        rmax = E->clash_rad[i];
+    }
+
+    E->clash_grid = (rmax > 0.0 ? 2.0 * rmax : 1.0);
+
+    /* use at least two buckets per level. */
+    unsigned int nb = 1;
+    while (nb < 2 * G->n_order)
+      nb <<= 1;
+
+    E->clash_mask = nb - 1;
+  }
+
+  /* count the earlier atoms that may lie closer than their radii. */
+  const double *rad = E->clash_rad;
+  n = 0;
+  for (unsigned int ib = 0; ib < lev; ib++) {
+    const value_t bound = graph_get_edge(G, order[ib], order[lev]);
+    n += (!dup[ib] && bound.type != VALUE_TYPE_UNDEFINED &&
+          bound.l < rad[ib] + rad[lev]);
+  }
+
+  /* allocate the closure payload. */
+  data = (enum_prune_clash_t*)
+    malloc(sizeof(enum_prune_clash_t) + n * sizeof(unsigned int));
+  if (!data)
+    return 0;
+
+  /* store the excluded levels. */
+  data->n = 0;
+  for (unsigned int ib = 0; ib < lev; ib++) {
+    const value_t bound = graph_get_edge(G, order[ib], order[lev]);
+    if (!dup[ib] && bound.type != VALUE_TYPE_UNDEFINED &&
+        bound.l < rad[ib] + rad[lev])
+      data->excl[data->n++] = ib;
+  }
+
+  /* reserve the test and prune counters of the closure. */
+  data->stat = enum_prune_add_stats(E, 2);
+
+  /* register a closure. */
+  if (!enum_prune_add_closure(E, lev, enum_prune_clash, data))
+    return 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_clash_alloc(): allocate the clash grids of every thread of
+ * an enumerator.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_prune_clash_alloc (enum_t *E) {
+  /* get the number of buckets and levels of each grid. */
+  const unsigned int nb = E->clash_mask + 1;
+  const unsigned int n = E->G->n_order;
+
+  /* loop over the threads. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    /* allocate the arrays of the grid at once. */
+    enum_thread_t *th = E->threads + t;
+    free(th->clash_head);
+    th->clash_head = (unsigned int*)
+      malloc((nb + 3 * n) * sizeof(unsigned int));
+    if (!th->clash_head)
+      throw("unable to allocate clash grid of thread %u", t + 1);
+
+    th->clash_next = th->clash_head + nb;
+    th->clash_cell = th->clash_next + n;
+    th->clash_mark = th->clash_cell + n;
+
+    /* initialize the grid as empty. */
+    for (unsigned int b = 0; b < nb; b++)
+      th->clash_head[b] = UINT_MAX;
+
+    for (unsigned int i = 0; i < n; i++)
+      th->clash_mark[i] = 0;
+
+    th->clash_top = th->clash_stamp = 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_clash_reset(): remove every level from the clash grid of
+ * a thread, whose path is about to be replaced.
+ *
+ * arguments:
+ *  @th: pointer to the thread to modify.
+ */
+void enum_prune_clash_reset (enum_thread_t *th) {
+  /* get the originality array. */
+  const unsigned int *dup = th->E->G->orig;
+
+  /* unlink the levels from deepest to shallowest. */
+  while (th->clash_top) {
+    const unsigned int l = --th->clash_top;
+    if (!dup[l])
+      th->clash_head[th->clash_cell[l]] = th->clash_next[l];
+  }
+}
+
+/* enum_prune_clash(): determine whether an enumerator tree may be pruned
+ * at a given node based on van der waals clashes.
+ */
+int enum_prune_clash (enum_t *E, enum_thread_t *th, void *data) {
+  /* get the payload. */
+  enum_prune_clash_t *clash_data = (enum_prune_clash_t*) data;
+
+  /* locally store the level, originality array and grid arrays. */
+  const enum_thread_node_t *state = th->state;
+  const unsigned int lev = th->level;
+  const unsigned int *dup = E->G->orig;
+  const double *rad = E->clash_rad;
+  unsigned int *head = th->clash_head;
+  unsigned int *next = th->clash_next;
+  unsigned int *cell = th->clash_cell;
+  unsigned int *mark = th->clash_mark;
+
+  /* remove the current and deeper levels, from the previous path. */
+  while (th->clash_top > lev) {
+    const unsigned int l = --th->clash_top;
+    if (!dup[l])
+      head[cell[l]] = next[l];
+  }
+
+  /* add the earlier levels that are not held yet. */
+  while (th->clash_top < lev) {
+    const unsigned int l = th->clash_top++;
+    if (dup[l])
+      continue;
+
+    long c[3];
+    enum_prune_clash_cell(E, &state[l].pos, c);
+    const unsigned int b = enum_prune_clash_hash(E, c);
+    cell[l] = b;
+    next[l] = head[b];
+    head[b] = l;
+  }
+
+  /* mark the excluded levels, clearing the marks once they wrap. */
+  if (++th->clash_stamp == 0) {
+    for (unsigned int i = 0; i < E->G->n_order; i++)
+      mark[i] = 0;
+
+    th->clash_stamp = 1;
+  }
+
+  const unsigned int stamp = th->clash_stamp;
+  for (unsigned int i = 0; i < clash_data->n; i++)
+    mark[clash_data->excl[i]] = stamp;
+
+  /* declare variables for visiting the neighbouring cells:
+   *  @c0: grid cell of the new atom.
+   *  @c: grid cell being visited.
+   *  @seen: buckets already visited.
+   */
+  const vector_t *x = &state[lev].pos;
+  long c0[3], c[3];
+  unsigned int seen[27], nseen = 0;
+
+  /* loop over the cells neighbouring the new atom. */
+  enum_stat_inc(th, clash_data->stat);
+  enum_prune_clash_cell(E, x, c0);
+  for (unsigned int m = 0; m < 27; m++) {
+    /* compute the cell indices and the bucket. */
+    c[0] = c0[0] + (long) (m % 3) - 1;
+    c[1] = c0[1] + (long) (m / 3 % 3) - 1;
+    c[2] = c0[2] + (long) (m / 9) - 1;
+    const unsigned int b = enum_prune_clash_hash(E, c);
+
+    /* skip buckets that were already visited. */
+    unsigned int k;
+    for (k = 0; k < nseen && seen[k] != b; k++);
+    if (k < nseen)
+      continue;
+
+    seen[nseen++] = b;
+
+    /* loop over the atoms held in the bucket. */
+    for (unsigned int l = head[b]; l != UINT_MAX; l = next[l]) {
+      /* skip excluded atoms. */
+      if (mark[l] == stamp)
+        continue;
+
+      /* prune if the atoms overlap beyond the tolerance. */
+      const double r = rad[lev] + rad[l] - E->ddf_tol;
+      const vector_t *y = &state[l].pos;
+      const double dx = x->x - y->x;
+      const double dy = x->y - y->y;
+      const double dz = x->z - y->z;
+      if (r > 0.0 && dx * dx + dy * dy + dz * dz < r * r) {
+        enum_stat_inc(th, clash_data->stat + 1);
+        return 1;
+      }
+    }
+  }
+
+  /* do not prune. */
+  return 0;
+}
+
+/* enum_prune_clash_report(): output a report for the clash pruning
+ * closure.
+ */
+void enum_prune_clash_report (enum_t *E, unsigned int lev, void *data) {
+  /* get the closure payload. */
+  enum_prune_clash_t *clash_data = (enum_prune_clash_t*) data;
+
+  /* get the test and prune counts of the closure. */
+  const unsigned long nt = enum_prune_get_stat(E, clash_data->stat);
+  const unsigned long np = enum_prune_get_stat(E, clash_data->stat + 1);
+
+  /* return if no prunes were performed by the closure. */
+  if (!np) return;
+
+  /* get the atom/residue indices. */
+  unsigned int ai = E->G->order[lev];
+  unsigned int ri = E->P->atoms[ai].res_id;
+
+  /* get the atom/residue names. */
+  const char *atomi = E->P->atoms[ai].name;
+  const char *resi = peptide_get_resname(E->P, ri);
+
+  /* compute the percentage. */
+  double f = ((double) np) / ((double) nt) * 100.0;
+
+  /* output the statistics. */
+  printf("  %3s%-4u %-4s | %-12s : %16lu/%-16lu  %6.2lf%%\n",
+         resi, ri + 1, atomi, "(any atom)", np, nt, f);
+}
@@ -4,14 +4,28 @@
 #include "enum-thread.h"
 #include "enum-prune.h"
 
+/* include the c float header. */
+#include <float.h>
+
 /* enum_prune_ddf_t: structure for holding information required for
  * direct distance feasibility pruning closures.
+ *
+ * the tests of a closure bound the distance from the atom at its level
+ * to every earlier atom that shares a defined graph edge with it. the
+ * bounds never change during enumeration, so they are tabulated once,
+ * as squared distances in structure-of-arrays layout.
  */
 typedef struct {
-  /* @ntest: number of calls made for each preceeding atom.
-   * @nprune: number of prunes performed for each preceeding atom.
+  /* @n: number of tests of the closure.
+   * @lev: array of levels of the earlier atom of each test.
+   * @stat: array of indices of the test counter of each test. the
+   *        prune counter is @stat + 1.
+   * @lo2, @hi2: arrays of squared bounds of each test, including
+   *             tolerances.
    */
-  unsigned int *ntest, *nprune;
+  unsigned int n;
+  unsigned int *lev, *stat;
+  double *lo2, *hi2;
 }
 enum_prune_ddf_t;
 
@@ -20,26 +34,100 @@ enum_prune_ddf_t;
 int enum_prune_ddf_init (enum_t *E, unsigned int lev) {
   /* declare required variables:
    *  @data: closure data pointer.
-   *  @sz: closure memory footprint.
+   *  @ref: levels of the sources of the three preceding atoms.
+   *  @key: array of sort keys of each test.
+   *  @nt: number of tests.
    */
   enum_prune_ddf_t *data;
-  unsigned int sz;
+  unsigned int ref[3], nt;
+  double *key;
+
+  /* locally store the graph, re-order and originality arrays. */
+  graph_t *G = E->G;
+  const unsigned int *order = G->order;
+  const unsigned int *dup = G->orig;
+
+  /* count the earlier atoms with defined bounds. */
+  nt = 0;
+  for (unsigned int ib = 0; ib < lev; ib++) {
+    const value_t bound = graph_get_edge(G, order[ib], order[lev]);
+    nt += (!dup[ib] && bound.type != VALUE_TYPE_UNDEFINED);
+  }
 
-  /* allocate the closure payload. */
-  sz = sizeof(enum_prune_ddf_t) + 2 * lev * sizeof(unsigned int);
-  data = (enum_prune_ddf_t*) malloc(sz);
+  /* skip levels without any bounds. */
+  if (!nt)
+    return 1;
+
+  /* allocate the closure payload along with its arrays. */
+  data = (enum_prune_ddf_t*)
+    malloc(sizeof(enum_prune_ddf_t) +
+           nt * (3 * sizeof(double) + 2 * sizeof(unsigned int)));
   if (!data)
     return 0;
 
-  /* initialize the payload array pointers. */
-  data->ntest = (unsigned int*)
-    (((char*) data) + sizeof(enum_prune_ddf_t));
-  data->nprune = (unsigned int*)
-    (((char*) data->ntest) + lev * sizeof(unsigned int));
+  data->lo2 = (double*) (data + 1);
+  data->hi2 = data->lo2 + nt;
+  key = data->hi2 + nt;
+  data->lev = (unsigned int*) (key + nt);
+  data->stat = data->lev + nt;
+
+  /* locate the sources of the three atoms that the current atom is
+   * embedded from, as its distances to them hold by construction.
+   */
+  for (unsigned int k = 0; k < 3; k++) {
+    ref[k] = (lev > k ? lev - k - 1 : lev);
+    while (ref[k] < lev && dup[ref[k]])
+      ref[k] -= dup[ref[k]];
+  }
+
+  /* store the squared bounds, widened by the ddf tolerance. */
+  data->n = 0;
+  for (unsigned int ib = lev - 1; ib < lev; ib--) {
+    /* skip duplicate atoms and undefined bounds, which never prune. */
+    const value_t bound = graph_get_edge(G, order[ib], order[lev]);
+    if (dup[ib] || bound.type == VALUE_TYPE_UNDEFINED)
+      continue;
+
+    const double l = bound.l - E->ddf_tol;
+    const double u = bound.u + E->ddf_tol;
+
+    const unsigned int t = data->n++;
+    data->lev[t] = ib;
+    data->lo2[t] = (l > 0.0 ? l * l : -1.0);
+    data->hi2[t] = u * u;
+
+    /* key the test by the width of its bounds, which best predicts its
+     * failure rate before any node has been tested. the bounds to the
+     * atoms of the embedding frame never fail, so they go last.
+     */
+    const int held = (ib == ref[0] || ib == ref[1] || ib == ref[2]);
+    key[t] = (held ? DBL_MAX : u - l);
+  }
+
+  /* sort the tests by their keys, keeping the nearest atoms first among
+   * tests of equal keys.
+   */
+  for (unsigned int t = 1; t < nt; t++) {
+    const unsigned int lv = data->lev[t];
+    const double lo2 = data->lo2[t], hi2 = data->hi2[t], k = key[t];
+
+    unsigned int s = t;
+    for (; s > 0 && key[s - 1] > k; s--) {
+      data->lev[s] = data->lev[s - 1];
+      data->lo2[s] = data->lo2[s - 1];
+      data->hi2[s] = data->hi2[s - 1];
+      key[s] = key[s - 1];
+    }
+
+    data->lev[s] = lv;
+    data->lo2[s] = lo2;
+    data->hi2[s] = hi2;
+    key[s] = k;
+  }
 
-  /* initialize the payload array contents. */
-  memset(data->ntest, 0, lev * sizeof(unsigned int));
-  memset(data->nprune, 0, lev * sizeof(unsigned int));
+  /* reserve the test and prune counters of each test. */
+  for (unsigned int t = 0; t < nt; t++)
+    data->stat[t] = enum_prune_add_stats(E, 2);
 
   /* register a closure. */
   if (!enum_prune_add_closure(E, lev, enum_prune_ddf, data))
@@ -53,40 +141,26 @@ int enum_prune_ddf_init (enum_t *E, unsigned int lev) {
  * at a given node based on direct distance feasibility (DDF).
  */
 int enum_prune_ddf (enum_t *E, enum_thread_t *th, void *data) {
-  /* declare required variables:
-   *  @bound: distance bound between upstream and end.
-   *  @dist: computed distance between upstream and end.
-   */
-  value_t bound;
-  double dist;
-
   /* get the payload. */
   enum_prune_ddf_t *ddf_data = (enum_prune_ddf_t*) data;
 
-  /* locally store the level, thread length, and originality array. */
-  const unsigned int n = E->G->n_order;
-  const unsigned int *dup = E->G->orig;
-  const unsigned int ia = th->level;
-
   /* locally store the end position. */
-  vector_t *thpos = &th->state[ia].pos;
-
-  /* loop over all upstream embedded atoms. */
-  for (unsigned int ib = ia - 1; ib < n; ib--) {
-    /* skip duplicate atoms. */
-    if (dup[ib]) continue;
-
-    /* obtain the distance bound on the two nodes. */
-    bound = graph_get_edge(E->G, E->G->order[ib],
-                                 E->G->order[ia]);
-
-    /* compute the distance between the two nodes. */
-    dist = vector_dist(&th->state[ib].pos, thpos);
-
-    /* prune if the distance is out of the bound. */
-    ddf_data->ntest[ib]++;
-    if (bound.l - dist > E->ddf_tol || dist - bound.u > E->ddf_tol) {
-      ddf_data->nprune[ib]++;
+  const enum_thread_node_t *state = th->state;
+  const vector_t x = state[th->level].pos;
+
+  /* loop over the tabulated tests. */
+  for (unsigned int t = 0; t < ddf_data->n; t++) {
+    /* compute the squared distance to the earlier atom. */
+    const vector_t *y = &state[ddf_data->lev[t]].pos;
+    const double dx = x.x - y->x;
+    const double dy = x.y - y->y;
+    const double dz = x.z - y->z;
+    const double d2 = dx * dx + dy * dy + dz * dz;
+
+    /* prune if the distance leaves the bounds. */
+    enum_stat_inc(th, ddf_data->stat[t]);
+    if (d2 < ddf_data->lo2[t] || d2 > ddf_data->hi2[t]) {
+      enum_stat_inc(th, ddf_data->stat[t] + 1);
       return 1;
     }
   }
@@ -95,6 +169,25 @@ int enum_prune_ddf (enum_t *E, enum_thread_t *th, void *data) {
   return 0;
 }
 
+/* enum_prune_ddf_compile(): merge a direct distance feasibility (DDF)
+ * closure into the prune kernel of its level.
+ */
+int enum_prune_ddf_compile (enum_t *E, unsigned int lev, void *data,
+                            enum_kernel_t *K) {
+  /* get the payload. */
+  enum_prune_ddf_t *ddf_data = (enum_prune_ddf_t*) data;
+
+  /* add a two-sided test that is also applied to batches. */
+  for (unsigned int t = 0; t < ddf_data->n; t++) {
+    if (!enum_prune_add_pair(K, ddf_data->lev[t], ddf_data->stat[t],
+                             ddf_data->lo2[t], ddf_data->hi2[t], 1))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
 /* enum_prune_ddf_report(): output a report for the direct distance
  * feasbility (DDF) pruning closure.
  */
@@ -111,12 +204,15 @@ void enum_prune_ddf_report (enum_t *E, unsigned int lev, void *data) {
   const char *resi = peptide_get_resname(E->P, ri);
 
   /* loop over all tested predecessors. */
-  for (unsigned int j = lev - 1; j < E->G->n_order; j--) {
-    /* skip duplicates and non-pruned predecessors. */
-    if (E->G->orig[j] || !ddf_data->nprune[j]) continue;
+  for (unsigned int t = 0; t < ddf_data->n; t++) {
+    /* get the test and prune counts, and skip non-pruned predecessors. */
+    const unsigned int stat = ddf_data->stat[t];
+    const unsigned long nt = enum_prune_get_stat(E, stat);
+    const unsigned long np = enum_prune_get_stat(E, stat + 1);
+    if (!np) continue;
 
     /* get the second atom/residue indices. */
-    unsigned int aj = E->G->order[j];
+    unsigned int aj = E->G->order[ddf_data->lev[t]];
     unsigned int rj = E->P->atoms[aj].res_id;
 
     /* get the second atom/residue names. */
@@ -124,15 +220,13 @@ void enum_prune_ddf_report (enum_t *E, unsigned int lev, void *data) {
     const char *resj = peptide_get_resname(E->P, rj);
 
     /* compute the percentage. */
-    double f = ((double) ddf_data->nprune[j]) /
-               ((double) ddf_data->ntest[j]) * 100.0;
+    double f = ((double) np) / ((double) nt) * 100.0;
 
     /* output the statistics. */
     printf("  %3s%-4u %-4s | %3s%-4u %-4s : "
-           "%16u/%-16u  %6.2lf%%\n",
+           "%16lu/%-16lu  %6.2lf%%\n",
            resi, ri + 1, atomi,
            resj, rj + 1, atomj,
-           ddf_data->nprune[j], ddf_data->ntest[j], f);
+           np, nt, f);
   }
 }
-
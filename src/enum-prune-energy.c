@@ -4,35 +4,287 @@
 #include "enum-thread.h"
 #include "enum-prune.h"
 
-/* define constants to represent pruning closure @type.
+/* ENERGY_LINEAR: smallest squared sine of the mean of an angle term for
+ * which its energy is expanded about the cosine of the mean. flatter
+ * angles use the linear expansion about a straight angle instead.
  */
-#define ENERGY_BOND     0
-#define ENERGY_ANGLE    1
-#define ENERGY_DIHEDRAL 2
-#define ENERGY_DISTANCE 3
-#define ENERGY_CONTACT  4
+#define ENERGY_LINEAR  1.0e-3
 
-/* enum_prune_energy_t: structure for holding information
- * required for energetic pruning closures.
+/* ENERGY_SLACK: distance (in angstroms) by which the bounds on embedded
+ * distances are widened when bounding the energy of a term, to absorb
+ * the rounding errors of the embedding.
  */
-typedef struct enum_prune_energy enum_prune_energy_t;
-struct enum_prune_energy {
-  /* @type: type of energy term to be feasibility checked.
-   */
-  unsigned int type;
+#define ENERGY_SLACK  1.0e-6
 
-  /* @ntest, @nprune: test and prune counts of the current closure.
-   * @mu, @kappa: mean and precision force field parameters.
+/* enum_prune_energy_term_t: structure for holding a single term of an
+ * energetic pruning closure.
+ */
+typedef struct {
+  /* @type: type of energy term to be feasibility checked.
    * @n: backward step-counts for the prior atoms.
+   * @c: polynomial coefficients of the term, as held by prune kernels.
    */
-  unsigned int ntest, nprune;
+  unsigned int type;
   unsigned int n[4];
-  double mu, kappa;
+  double c[3];
+}
+enum_prune_energy_term_t;
 
-  /* @next: pointer to the next energy term structure.
+/* enum_prune_energy_t: structure for holding information
+ * required for energetic pruning closures.
+ */
+typedef struct {
+  /* @stat: index of the first statistics counter of the closure. the
+   *  test and prune counts of the terms of each type are held in
+   *  counters (@stat + 2 * type) and (@stat + 2 * type + 1).
+   * @n: number of terms of the closure.
+   * @term: array of terms, sorted by type.
    */
-  enum_prune_energy_t *next;
-};
+  unsigned int stat, n;
+  enum_prune_energy_term_t term[];
+}
+enum_prune_energy_t;
+
+/* enum_prune_energy_add(): append a term to the payload of an energetic
+ * pruning closure, folding its force field parameters into the
+ * coefficients evaluated by the prune kernels.
+ *
+ * arguments:
+ *  @pdata: pointer to the closure payload to modify.
+ *  @type: type of the energy term.
+ *  @lev: level of the last atom of the term.
+ *  @levs: array of levels of the atoms of the term.
+ *  @mu, @kappa: mean and precision force field parameters of the term.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_prune_energy_add (enum_prune_energy_t **pdata,
+                                  unsigned int type, unsigned int lev,
+                                  const unsigned int *levs,
+                                  double mu, double kappa) {
+  /* reallocate the closure payload. */
+  const unsigned int n = (*pdata ? (*pdata)->n : 0);
+  enum_prune_energy_t *data = (enum_prune_energy_t*)
+    realloc(*pdata, sizeof(enum_prune_energy_t) +
+                    (n + 1) * sizeof(enum_prune_energy_term_t));
+
+  /* check for allocation failures. */
+  if (!data)
+    return 0;
+
+  *pdata = data;
+  data->n = n + 1;
+
+  /* store the term type and offsets. */
+  enum_prune_energy_term_t *t = data->term + n;
+  t->type = type;
+  for (unsigned int k = 0; k < 4; k++)
+    t->n[k] = lev - levs[k];
+
+  /* compute the term coefficients. */
+  const double cmu = cos(mu), smu = sin(mu);
+  switch (type) {
+    /* close contacts: 0.5 kappa (mu / d)^6. */
+    case ENERGY_CONTACT:
+      t->c[0] = 0.5 * kappa;
+      t->c[1] = mu * mu;
+      t->c[2] = 0.0;
+      break;
+
+    /* bonded distances: 0.5 kappa (d - mu)^2. */
+    case ENERGY_BOND:
+      t->c[0] = 0.5 * kappa;
+      t->c[1] = mu;
+      t->c[2] = 0.0;
+      break;
+
+    /* non-bonded distances: 0.5 kappa log(d / mu)^2. */
+    case ENERGY_DISTANCE:
+      t->c[0] = 0.125 * kappa;
+      t->c[1] = 1.0 / (mu * mu);
+      t->c[2] = 0.0;
+      break;
+
+    /* angles: 0.5 kappa (cos(theta) - cos(mu))^2 / sin(mu)^2, which
+     * matches the harmonic energy to second order about the mean. at
+     * straight angles, kappa (1 - cos(theta) cos(mu)) is used instead.
+     */
+    case ENERGY_ANGLE:
+      if (smu * smu > ENERGY_LINEAR) {
+        const double a = 0.5 * kappa / (smu * smu);
+        t->c[0] = a * cmu * cmu;
+        t->c[1] = -2.0 * a * cmu;
+        t->c[2] = a;
+      }
+      else {
+        t->c[0] = kappa;
+        t->c[1] = -kappa * (cmu < 0.0 ? -1.0 : 1.0);
+        t->c[2] = 0.0;
+      }
+      break;
+
+    /* dihedrals: kappa (1 - cos(omega - mu)), which matches the harmonic
+     * energy to second order about the mean and is periodic.
+     */
+    case ENERGY_DIHEDRAL:
+      t->c[0] = kappa;
+      t->c[1] = -kappa * cmu;
+      t->c[2] = -kappa * smu;
+      break;
+
+    /* otherwise, contribute nothing. */
+    default:
+      t->c[0] = t->c[1] = t->c[2] = 0.0;
+      break;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_energy_edge(): return the bounds that the embedding of a
+ * level places on the distance to a nearby level. each embedded atom is
+ * placed at exact distances from the two atoms that precede it, so only
+ * those distances are bounded.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @i, @j: levels of the two atoms.
+ *
+ * returns:
+ *  widened bounds on the distance between the atoms, or an undefined
+ *  value if the embedding does not bound the distance.
+ */
+static value_t enum_prune_energy_edge (enum_t *E, unsigned int i,
+                                       unsigned int j) {
+  /* order the levels, deepest first. */
+  if (i < j) {
+    const unsigned int k = i;
+    i = j;
+    j = k;
+  }
+
+  /* duplicate atoms are not embedded, and so bound nothing. */
+  if (i == j || i - j > 2 || E->G->orig[i])
+    return value_undefined();
+
+  /* get the edge used to embed the atom. */
+  const value_t d = graph_get_edge(E->G, E->G->order[j], E->G->order[i]);
+  if (d.type == VALUE_TYPE_UNDEFINED)
+    return d;
+
+  /* widen the edge bounds. */
+  return value_interval(d.l > ENERGY_SLACK ? d.l - ENERGY_SLACK : 0.0,
+                        d.u + ENERGY_SLACK);
+}
+
+/* enum_prune_energy_min(): compute a lower bound on the value of a term
+ * of an energetic pruning closure over every embedding of its level.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @lev: level of the last atom of the term.
+ *  @t: pointer to the term to bound.
+ *
+ * returns:
+ *  lower bound on the energy contribution of the term.
+ */
+static double enum_prune_energy_min (enum_t *E, unsigned int lev,
+                                     const enum_prune_energy_term_t *t) {
+  /* get the bounds on the first bond of the term. */
+  const value_t a = enum_prune_energy_edge(E, lev - t->n[0],
+                                           lev - t->n[1]);
+  const int bounded = (a.type != VALUE_TYPE_UNDEFINED);
+
+  /* bound the term. */
+  switch (t->type) {
+    /* close contacts decrease with the distance. */
+    case ENERGY_CONTACT: {
+      if (!bounded)
+        break;
+
+      const double r = t->c[1] / (a.u * a.u);
+      return t->c[0] * r * r * r;
+    }
+
+    /* bonded distances are least at the nearest distance to the mean. */
+    case ENERGY_BOND: {
+      if (!bounded)
+        break;
+
+      const double dd = (t->c[1] < a.l ? a.l - t->c[1] :
+                         t->c[1] > a.u ? t->c[1] - a.u : 0.0);
+      return t->c[0] * dd * dd;
+    }
+
+    /* non-bonded distances are also least nearest to the mean. */
+    case ENERGY_DISTANCE: {
+      if (!bounded || a.l <= 0.0)
+        break;
+
+      const double lo = log(t->c[1] * a.l * a.l);
+      const double hi = log(t->c[1] * a.u * a.u);
+      const double lg = (lo > 0.0 ? lo : hi < 0.0 ? hi : 0.0);
+      return t->c[0] * lg * lg;
+    }
+
+    /* angles are quadratic in the cosine of the angle, which is bounded
+     * when all three distances between the atoms are.
+     */
+    case ENERGY_ANGLE: {
+      double lo = -1.0, hi = 1.0;
+      const value_t b = enum_prune_energy_edge(E, lev - t->n[1],
+                                               lev - t->n[2]);
+      const value_t c = enum_prune_energy_edge(E, lev - t->n[0],
+                                               lev - t->n[2]);
+
+      if (bounded && a.l > 0.0 &&
+          b.type != VALUE_TYPE_UNDEFINED && b.l > 0.0 &&
+          c.type != VALUE_TYPE_UNDEFINED) {
+        const value_t ct = values_to_angle(a, c, b);
+        lo = (ct.l < -1.0 ? -1.0 : ct.l > 1.0 ? 1.0 : ct.l);
+        hi = (ct.u > 1.0 ? 1.0 : ct.u < lo ? lo : ct.u);
+      }
+
+      /* take the least value at the bounds and the vertex. */
+      double x = (t->c[2] > 0.0 ? -0.5 * t->c[1] / t->c[2] : lo);
+      x = (x < lo ? lo : x > hi ? hi : x);
+
+      double umin = t->c[0] + x * (t->c[1] + x * t->c[2]);
+      const double ulo = t->c[0] + lo * (t->c[1] + lo * t->c[2]);
+      const double uhi = t->c[0] + hi * (t->c[1] + hi * t->c[2]);
+      umin = (ulo < umin ? ulo : umin);
+      umin = (uhi < umin ? uhi : umin);
+      return umin;
+    }
+
+    /* dihedrals are least when the angle equals the mean. */
+    case ENERGY_DIHEDRAL:
+      return t->c[0] - sqrt(t->c[1] * t->c[1] + t->c[2] * t->c[2]);
+
+    /* otherwise, do nothing. */
+    default: break;
+  }
+
+  /* unbounded terms are non-negative. */
+  return 0.0;
+}
+
+/* enum_prune_energy_bound(): replace the least energy of the terms held
+ * at each level of an enumerator by the least energy of the terms held
+ * at all deeper levels, so that a node may be pruned once its energy
+ * and the least energy below it exceed the tolerance.
+ */
+void enum_prune_energy_bound (enum_t *E) {
+  /* sum the bounds from the deepest level. */
+  double sum = 0.0;
+  for (unsigned int lev = E->G->n_order; lev-- > 0;) {
+    const double umin = E->energy_lb[lev];
+    E->energy_lb[lev] = sum;
+    sum += umin;
+  }
+}
 
 /* enum_prune_energy_init(): initialize the energy enumerator.
  */
@@ -40,13 +292,12 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
   /* declare required variables:
    *  @i: peptide bond/angle/torsion/improper array index.
    *  @k: atoms array index.
-   *  @n_data: number of linked closure data structures.
    *  @id: atom index that has just been embedded.
    *  @ids: atom indices in each energetic term.
    *  @levs: reorder indices of each atom.
    *  @data: closure data pointer.
    */
-  unsigned int i, k, n, n_data, id, *ids, levs[4];
+  unsigned int i, k, n, id, *ids, levs[4];
   enum_prune_energy_t *data;
 
   /* define a contact force constant scale factor. */
@@ -55,9 +306,15 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
   /* get the current atom index. */
   id = E->G->order[lev];
 
+  /* allocate the energy bounds of every level on first use. */
+  if (!E->energy_lb) {
+    E->energy_lb = (double*) calloc(E->G->n_order, sizeof(double));
+    if (!E->energy_lb)
+      throw("unable to allocate energy bounds");
+  }
+
   /* initialize the closure data. */
   data = NULL;
-  n_data = 0;
 
   /* loop over the bonds. */
   for (i = 0, n = 2; i < E->P->n_bonds; i++) {
@@ -78,37 +335,12 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
         levs[1] > lev)
       continue;
 
-    /* reallocate the closure payload. */
-    n_data++;
-    data = (enum_prune_energy_t*)
-      realloc(data, n_data * sizeof(enum_prune_energy_t));
-
-    /* check for allocation failures. */
-    if (!data)
+    /* store the term. */
+    if (!enum_prune_energy_add(&data, (E->P->bonds[i].is_virtual
+                                        ? ENERGY_DISTANCE
+                                        : ENERGY_BOND), lev, levs,
+                               E->P->bonds[i].mu, E->P->bonds[i].kappa))
       return 0;
-
-    /* store the term type. */
-    data[n_data - 1].type = (E->P->bonds[i].is_virtual
-                              ? ENERGY_DISTANCE
-                              : ENERGY_BOND);
-
-    /* initialize the counters. */
-    data[n_data - 1].ntest = data[n_data - 1].nprune = 0;
-
-    /* store the offsets. */
-    data[n_data - 1].n[0] = 0;
-    data[n_data - 1].n[1] = 0;
-    data[n_data - 1].n[2] = 0;
-    data[n_data - 1].n[3] = 0;
-    for (k = 0; k < n; k++)
-      data[n_data - 1].n[k] = lev - levs[k];
-
-    /* store the term parameters. */
-    data[n_data - 1].mu = E->P->bonds[i].mu;
-    data[n_data - 1].kappa = E->P->bonds[i].kappa;
-
-    /* initialize the next-payload pointer. */
-    data[n_data - 1].next = NULL;
   }
 
   /* loop over the angles. */
@@ -131,33 +363,10 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
         levs[2] > lev)
       continue;
 
-    /* reallocate the closure payload. */
-    n_data++;
-    data = (enum_prune_energy_t*)
-      realloc(data, n_data * sizeof(enum_prune_energy_t));
-
-    /* check for allocation failures. */
-    if (!data)
+    /* store the term. */
+    if (!enum_prune_energy_add(&data, ENERGY_ANGLE, lev, levs,
+                               E->P->angles[i].mu, E->P->angles[i].kappa))
       return 0;
-
-    /* store the term type and initialize the counters. */
-    data[n_data - 1].type = ENERGY_ANGLE;
-    data[n_data - 1].ntest = data[n_data - 1].nprune = 0;
-
-    /* store the offsets. */
-    data[n_data - 1].n[0] = 0;
-    data[n_data - 1].n[1] = 0;
-    data[n_data - 1].n[2] = 0;
-    data[n_data - 1].n[3] = 0;
-    for (k = 0; k < n; k++)
-      data[n_data - 1].n[k] = lev - levs[k];
-
-    /* store the term parameters. */
-    data[n_data - 1].mu = E->P->angles[i].mu;
-    data[n_data - 1].kappa = E->P->angles[i].kappa;
-
-    /* initialize the next-payload pointer. */
-    data[n_data - 1].next = NULL;
   }
 
   /* loop over the torsions. */
@@ -181,33 +390,11 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
         levs[3] > lev)
       continue;
 
-    /* reallocate the closure payload. */
-    n_data++;
-    data = (enum_prune_energy_t*)
-      realloc(data, n_data * sizeof(enum_prune_energy_t));
-
-    /* check for allocation failures. */
-    if (!data)
+    /* store the term. */
+    if (!enum_prune_energy_add(&data, ENERGY_DIHEDRAL, lev, levs,
+                               E->P->torsions[i].mu,
+                               E->P->torsions[i].kappa))
       return 0;
-
-    /* store the term type and initialize the counters. */
-    data[n_data - 1].type = ENERGY_DIHEDRAL;
-    data[n_data - 1].ntest = data[n_data - 1].nprune = 0;
-
-    /* store the offsets. */
-    data[n_data - 1].n[0] = 0;
-    data[n_data - 1].n[1] = 0;
-    data[n_data - 1].n[2] = 0;
-    data[n_data - 1].n[3] = 0;
-    for (k = 0; k < n; k++)
-      data[n_data - 1].n[k] = lev - levs[k];
-
-    /* store the term parameters. */
-    data[n_data - 1].mu = E->P->torsions[i].mu;
-    data[n_data - 1].kappa = E->P->torsions[i].kappa;
-
-    /* initialize the next-payload pointer. */
-    data[n_data - 1].next = NULL;
   }
 
   /* loop over the impropers. */
@@ -231,80 +418,53 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
         levs[3] > lev)
       continue;
 
-    /* reallocate the closure payload. */
-    n_data++;
-    data = (enum_prune_energy_t*)
-      realloc(data, n_data * sizeof(enum_prune_energy_t));
-
-    /* check for allocation failures. */
-    if (!data)
+    /* store the term. */
+    if (!enum_prune_energy_add(&data, ENERGY_DIHEDRAL, lev, levs,
+                               E->P->impropers[i].mu,
+                               E->P->impropers[i].kappa))
       return 0;
-
-    /* store the term type and initialize the counters. */
-    data[n_data - 1].type = ENERGY_DIHEDRAL;
-    data[n_data - 1].ntest = data[n_data - 1].nprune = 0;
-
-    /* store the offsets. */
-    data[n_data - 1].n[0] = 0;
-    data[n_data - 1].n[1] = 0;
-    data[n_data - 1].n[2] = 0;
-    data[n_data - 1].n[3] = 0;
-    for (k = 0; k < n; k++)
-      data[n_data - 1].n[k] = lev - levs[k];
-
-    /* store the term parameters. */
-    data[n_data - 1].mu = E->P->impropers[i].mu;
-    data[n_data - 1].kappa = E->P->impropers[i].kappa;
-
-    /* initialize the next-payload pointer. */
-    data[n_data - 1].next = NULL;
   }
 
   /* loop over van der waals contacts. */
-  for (i = 0, n = 4; i < lev; i++) {
+  for (i = 0; i < lev; i++) {
     /* skip duplicate atoms. */
     if (E->G->orig[i]) continue;
 
     /* get the other atom index. */
     unsigned int jd = E->G->order[i];
 
-    /* reallocate the closure payload. */
-    n_data++;
-    data = (enum_prune_energy_t*)
-      realloc(data, n_data * sizeof(enum_prune_energy_t));
-
-    /* check for allocation failures. */
-    if (!data)
+    /* store the term. */
+    levs[0] = levs[2] = levs[3] = lev;
+    levs[1] = i;
+    if (!enum_prune_energy_add(&data, ENERGY_CONTACT, lev, levs,
+                               E->P->atoms[id].radius +
+                               E->P->atoms[jd].radius,
+                               Z * pow(E->ddf_tol, -2.0)))
       return 0;
+  }
 
-    /* store the term type. */
-    data[n_data - 1].type = ENERGY_CONTACT;
-
-    /* initialize the counters. */
-    data[n_data - 1].ntest = data[n_data - 1].nprune = 0;
+  /* return if no closures were created. */
+  if (!data)
+    return 1;
 
-    /* store the offsets. */
-    data[n_data - 1].n[0] = 0;
-    data[n_data - 1].n[1] = lev - i;
-    data[n_data - 1].n[2] = 0;
-    data[n_data - 1].n[3] = 0;
+  /* sort the terms by type, keeping their order within each type. */
+  for (i = 1; i < data->n; i++) {
+    const enum_prune_energy_term_t t = data->term[i];
 
-    /* store the term parameters. */
-    data[n_data - 1].kappa = Z * pow(E->ddf_tol, -2.0);
-    data[n_data - 1].mu =
-      E->P->atoms[id].radius + E->P->atoms[jd].radius;
+    for (k = i; k > 0 && data->term[k - 1].type > t.type; k--)
+      data->term[k] = data->term[k - 1];
 
-    /* initialize the next-payload pointer. */
-    data[n_data - 1].next = NULL;
+    data->term[k] = t;
   }
 
-  /* return if no closures were created. */
-  if (!n_data)
-    return 1;
+  /* sum the least energy of the terms, held until all levels have
+   * been initialized.
+   */
+  for (i = 0; i < data->n; i++)
+    E->energy_lb[lev] += enum_prune_energy_min(E, lev, data->term + i);
 
-  /* link up the chain of energy structures. */
-  for (i = 0; i < n_data - 1; i++)
-    data[i].next = data + (i + 1);
+  /* reserve the test and prune counters of each term type. */
+  data->stat = enum_prune_add_stats(E, 2 * ENERGY_TYPES);
 
   /* register the closure with the enumerator. */
   if (!enum_prune_add_closure(E, lev, enum_prune_energy, data))
@@ -314,100 +474,191 @@ int enum_prune_energy_init (enum_t *E, unsigned int lev) {
   return 1;
 }
 
-/* enum_prune_energy(): determine whether an enumerator tree may
- * be pruned at a given node based on energetic feasibility.
+/* enum_prune_energy_term(): compute the value of a single term of an
+ * energetic pruning closure.
+ *
+ * arguments:
+ *  @state: array of tree nodes holding the atom positions.
+ *  @lev: level of the last atom of the term.
+ *  @t: pointer to the term to compute.
+ *
+ * returns:
+ *  energy contribution of the term.
  */
-int enum_prune_energy (enum_t *E, enum_thread_t *th, void *data) {
-  /* declare required variables:
-   *  @energy_data: payload for energetic pruning terms.
-   *  @Eterm: energy contribution of the current term.
-   *  @Enew: total energy contribution of the embedded atom.
-   *  @mu: mean parameter of the current term.
-   *  @kappa: precision parameter of the current term.
-   *  @obs: observed value of the current term.
-   *  @x: array of atoms involved in the current term.
-   */
-  enum_prune_energy_t *energy_data;
-  double Eterm, Enew, mu, kappa, obs;
-  unsigned int k;
-  vector_t x[4];
-
-  /* get the payload and initialize the energy contribution. */
-  energy_data = (enum_prune_energy_t*) data;
-  Enew = 0.0;
-
-  /* loop over each term in the new energy contribution. */
-  while (energy_data) {
-    /* extract the term parameters. */
-    Eterm = 0.0;
-    mu = energy_data->mu;
-    kappa = energy_data->kappa;
-
-    /* extract all atom positions. */
-    for (k = 0; k < 4; k++)
-      x[k] = th->state[th->level - energy_data->n[k]].pos;
-
-    /* compute the current term. */
-    switch (energy_data->type) {
-      /* bonded distance. */
-      case ENERGY_BOND:
-        obs = vector_dist(&x[0], &x[1]);
-        Eterm = 0.5 * kappa * pow(obs - mu, 2.0);
-        break;
-
-      /* two-bond angle. */
-      case ENERGY_ANGLE:
-        obs = vector_angle(&x[0], &x[1], &x[2]);
-        Eterm = 0.5 * kappa * pow(obs - mu, 2.0);
-        break;
+static double enum_prune_energy_term (const enum_thread_node_t *state,
+                                      unsigned int lev,
+                                      const enum_prune_energy_term_t *t) {
+  /* get pretty handles to the atom positions. */
+  const vector_t *x0 = &state[lev - t->n[0]].pos;
+  const vector_t *x1 = &state[lev - t->n[1]].pos;
+  const vector_t *x2 = &state[lev - t->n[2]].pos;
+  const vector_t *x3 = &state[lev - t->n[3]].pos;
+
+  /* compute the first bond vector and its squared length. */
+  const double ax = x0->x - x1->x, ay = x0->y - x1->y, az = x0->z - x1->z;
+  const double a2 = ax * ax + ay * ay + az * az;
+
+  /* compute the term. */
+  switch (t->type) {
+    /* close contacts. */
+    case ENERGY_CONTACT: {
+      const double r = t->c[1] / a2;
+      return t->c[0] * r * r * r;
+    }
 
-      /* dihedral angle. */
-      case ENERGY_DIHEDRAL:
-        obs = vector_dihedral(&x[0], &x[1], &x[2], &x[3]);
-        Eterm = 0.5 * kappa * pow(obs - mu, 2.0);
-        break;
+    /* bonded distance. */
+    case ENERGY_BOND: {
+      const double dd = sqrt(a2) - t->c[1];
+      return t->c[0] * dd * dd;
+    }
 
-      /* non-bonded distance. */
-      case ENERGY_DISTANCE:
-        obs = vector_dist(&x[0], &x[1]);
-        Eterm = 0.5 * kappa * pow(log(obs / mu), 2.0);
-        break;
+    /* non-bonded distance. */
+    case ENERGY_DISTANCE: {
+      const double lg = log(t->c[1] * a2);
+      return t->c[0] * lg * lg;
+    }
 
-      /* close contacts (vdw repulsion). */
-      case ENERGY_CONTACT:
-        obs = vector_dist(&x[0], &x[1]);
-        Eterm = 0.5 * kappa * pow(mu / obs, 6.0);
-        break;
+    /* two-bond angle. */
+    case ENERGY_ANGLE: {
+      const double bx = x2->x - x1->x, by = x2->y - x1->y,
+                   bz = x2->z - x1->z;
+      const double b2 = bx * bx + by * by + bz * bz;
+      const double c = (ax * bx + ay * by + az * bz) / sqrt(a2 * b2);
+      return t->c[0] + c * (t->c[1] + c * t->c[2]);
+    }
 
-      /* otherwise, do nothing. */
-      default: break;
+    /* dihedral angle. */
+    case ENERGY_DIHEDRAL: {
+      /* compute the second and third bond vectors. */
+      const double bx = x1->x - x2->x, by = x1->y - x2->y,
+                   bz = x1->z - x2->z;
+      const double cx = x2->x - x3->x, cy = x2->y - x3->y,
+                   cz = x2->z - x3->z;
+
+      /* compute the normals of the two planes. */
+      const double n1x = ay * bz - az * by, n1y = az * bx - ax * bz,
+                   n1z = ax * by - ay * bx;
+      const double n2x = by * cz - bz * cy, n2y = bz * cx - bx * cz,
+                   n2z = bx * cy - by * cx;
+
+      /* compute the scaled cosine and sine of the angle. */
+      const double mx = n1y * bz - n1z * by, my = n1z * bx - n1x * bz,
+                   mz = n1x * by - n1y * bx;
+      const double x = sqrt(bx * bx + by * by + bz * bz) *
+                       (n1x * n2x + n1y * n2y + n1z * n2z);
+      const double y = mx * n2x + my * n2y + mz * n2z;
+      const double r = sqrt(x * x + y * y);
+      const double cw = (r > 0.0 ? x / r : 1.0);
+      const double sw = (r > 0.0 ? y / r : 0.0);
+      return t->c[0] + cw * t->c[1] + sw * t->c[2];
     }
 
-    /* sum the energy term into the new contribution. */
-    Enew += Eterm;
+    /* otherwise, do nothing. */
+    default: break;
+  }
 
-    /* update the energy at the current node. */
-    th->state[th->level].energy = th->state[th->level - 1].energy + Enew;
+  /* unknown term. */
+  return 0.0;
+}
+
+/* enum_prune_energy(): determine whether an enumerator tree may
+ * be pruned at a given node based on energetic feasibility.
+ */
+int enum_prune_energy (enum_t *E, enum_thread_t *th, void *data) {
+  /* get the payload and the energy of the parent node. */
+  enum_prune_energy_t *energy_data = (enum_prune_energy_t*) data;
+  enum_thread_node_t *state = th->state;
+  const unsigned int lev = th->level;
+  const double E0 = state[lev - 1].energy;
+  double Enew = 0.0, tol;
+  int ret = 0;
+
+  /* compare against the tolerance, less the least energy below. */
+  __atomic_load(&E->energy_tol, &tol, __ATOMIC_RELAXED);
+  tol -= E->energy_lb[lev];
+
+  /* loop over the terms, one type at a time. */
+  for (unsigned int i = 0; i < energy_data->n;) {
+    /* sum the terms of the current type. */
+    const unsigned int type = energy_data->term[i].type;
+    for (; i < energy_data->n && energy_data->term[i].type == type; i++)
+      Enew += enum_prune_energy_term(state, lev, energy_data->term + i);
 
     /* check if the node should be pruned. */
-    energy_data->ntest++;
-    if (th->state[th->level].energy > E->energy_tol) {
-      energy_data->nprune++;
-      return 1;
+    const unsigned int stat = energy_data->stat + 2 * type;
+    enum_stat_inc(th, stat);
+    if (E0 + Enew > tol) {
+      enum_stat_inc(th, stat + 1);
+      ret = 1;
+      break;
     }
+  }
+
+  /* store the energy of the node. */
+  state[lev].energy = E0 + Enew;
+  return ret;
+}
 
-    /* move to the next energy term. */
-    energy_data = energy_data->next;
+/* enum_prune_energy_compile(): merge the terms of an energetic
+ * feasibility closure into the prune kernel of its level.
+ */
+int enum_prune_energy_compile (enum_t *E, unsigned int lev, void *data,
+                               enum_kernel_t *K) {
+  /* get the payload. */
+  enum_prune_energy_t *energy_data = (enum_prune_energy_t*) data;
+
+  /* loop over each term. */
+  for (unsigned int i = 0; i < energy_data->n; i++) {
+    const enum_prune_energy_term_t *t = energy_data->term + i;
+
+    /* compute the levels of the atoms of the term. */
+    unsigned int levs[4];
+    for (unsigned int k = 0; k < 4; k++)
+      levs[k] = lev - t->n[k];
+
+    /* add the term. */
+    if (!enum_prune_add_term(K, t->type, levs,
+                             energy_data->stat + 2 * t->type, t->c))
+      return 0;
   }
 
-  /* do not prune. */
-  return 0;
+  /* return success. */
+  return 1;
 }
 
 /* enum_prune_energy_report(): output a report for the energetic feasibility
  * pruning closure.
  */
 void enum_prune_energy_report (enum_t *E, unsigned int lev, void *data) {
-  /* FIXME: implement enum_prune_energy_report() */
+  /* define the names of the term types. */
+  static const char *names[ENERGY_TYPES] = {
+    "contact", "bond", "distance", "angle", "dihedral"
+  };
+
+  /* get the closure payload. */
+  enum_prune_energy_t *energy_data = (enum_prune_energy_t*) data;
+
+  /* get the atom/residue indices. */
+  unsigned int ai = E->G->order[lev];
+  unsigned int ri = E->P->atoms[ai].res_id;
+
+  /* get the atom/residue names. */
+  const char *atomi = E->P->atoms[ai].name;
+  const char *resi = peptide_get_resname(E->P, ri);
+
+  /* loop over the term types. */
+  for (unsigned int type = 0; type < ENERGY_TYPES; type++) {
+    /* get the test and prune counts, and skip non-pruning types. */
+    const unsigned int stat = energy_data->stat + 2 * type;
+    const unsigned long nt = enum_prune_get_stat(E, stat);
+    const unsigned long np = enum_prune_get_stat(E, stat + 1);
+    if (!np) continue;
+
+    /* compute the percentage. */
+    double f = ((double) np) / ((double) nt) * 100.0;
+
+    /* output the statistics. */
+    printf("  %3s%-4u %-4s | %-12s : %16lu/%-16lu  %6.2lf%%\n",
+           resi, ri + 1, atomi, names[type], np, nt, f);
+  }
 }
-
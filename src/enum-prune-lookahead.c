@@ -0,0 +1,355 @@
+
+/* include the enumerator header. */
+#include "enum.h"
+#include "enum-thread.h"
+#include "enum-prune.h"
+
+/* enum_prune_lookahead_t: structure for holding information required for
+ * lookahead (forward checking) pruning closures.
+ */
+typedef struct {
+  /* @stat: index of the test and prune counters of the closure.
+   * @lev: graph level of the closure.
+   * @next: graph level of the next embedded atom, whose distance tests
+   *        are checked ahead of time.
+   * @frame: graph levels holding the positions of the three atoms that
+   *         precede @next, which are never deeper than @lev.
+   */
+  unsigned int stat, lev, next;
+  unsigned int frame[3];
+}
+enum_prune_lookahead_t;
+
+/* enum_prune_lookahead_arc(): add an arc of the circle to an interval
+ * set, splitting the arc in two where it crosses the point pi = -pi.
+ *
+ * arguments:
+ *  @I: pointer to the interval set to modify.
+ *  @a: start angle of the arc.
+ *  @len: length of the arc, at most 2 pi.
+ */
+static void enum_prune_lookahead_arc (intervals_t *I, double a, double len) {
+  /* wrap the start angle into [-pi, pi). */
+  while (a < -M_PI) a += 2.0 * M_PI;
+  while (a >= M_PI) a -= 2.0 * M_PI;
+
+  /* add the arc, in two pieces if it wraps around. */
+  const double b = a + len;
+  if (b > M_PI) {
+    intervals_union(I, a, M_PI);
+    intervals_union(I, -M_PI, b - 2.0 * M_PI);
+  }
+  else
+    intervals_union(I, a, b);
+}
+
+/* enum_prune_lookahead_meet(): determine whether the arcs of a circle
+ * admitted by a set of distance tests have a common point.
+ *
+ * arguments:
+ *  @m: number of tests.
+ *  @w: array of the positions of each test atom, relative to the center
+ *      of the circle.
+ *  @wl, @wu: arrays of the bounds on the cosine of the angle between
+ *            each test atom and the points of the circle, about its axis.
+ *  @e1: unit axis of the circle.
+ *  @v: vector that is not parallel to the axis, which fixes the origin
+ *      of the angles on the circle.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the arcs intersect.
+ */
+static int enum_prune_lookahead_meet (const unsigned int m,
+                                      const vector_t *w,
+                                      const double *wl, const double *wu,
+                                      vector_t e1, vector_t v) {
+  /* a single test always admits part of the circle. */
+  if (m < 2)
+    return 1;
+
+  /* e2 = component of @v orthogonal to the axis. */
+  vector_t e2 = v, e3;
+  const double f = v.x * e1.x + v.y * e1.y + v.z * e1.z;
+  vector_axpy(&e2, -f, &e1);
+
+  /* the angles are undefined if @v is parallel to the axis. */
+  const double ne2 = sqrt(e2.x * e2.x + e2.y * e2.y + e2.z * e2.z);
+  if (ne2 < 1.0e-9)
+    return 1;
+
+  e2.x /= ne2;
+  e2.y /= ne2;
+  e2.z /= ne2;
+
+  /* e3 = cross(e1, e2), completing the frame of the circle. */
+  vector_cross(&e1, &e2, &e3);
+
+  /* declare the interval sets holding the running intersection @cur,
+   * its next value @nxt, and the arcs @arc of the current test. each
+   * intersection adds at most two intervals to the running set.
+   */
+  const unsigned int cap = 2 * m + 1;
+  double buf[4 * cap + 8];
+  intervals_t I[3] = {
+    { buf,           buf + cap,         0, cap },
+    { buf + 2 * cap, buf + 3 * cap,     0, cap },
+    { buf + 4 * cap, buf + 4 * cap + 4, 0, 4 }
+  };
+  intervals_t *cur = I, *nxt = I + 1, *arc = I + 2, *swp;
+
+  /* initialize the running intersection to the whole circle. */
+  intervals_union(cur, -M_PI, M_PI);
+
+  /* loop over the stored tests. */
+  for (unsigned int i = 0; i < m; i++) {
+    /* compute the arcs admitted by the test, which lie at angles from
+     * @wa to @wb on either side of the angle @phi of the test atom.
+     */
+    const double ua = w[i].x * e2.x + w[i].y * e2.y + w[i].z * e2.z;
+    const double ub = w[i].x * e3.x + w[i].y * e3.y + w[i].z * e3.z;
+    const double phi = atan2(ub, ua);
+    const double wa = (wu[i] >= 1.0 ? 0.0 : acos(wu[i]));
+    const double wb = (wl[i] <= -1.0 ? M_PI : acos(wl[i]));
+
+    arc->size = 0;
+    if (wa == 0.0)
+      enum_prune_lookahead_arc(arc, phi - wb, 2.0 * wb);
+    else if (wb == M_PI)
+      enum_prune_lookahead_arc(arc, phi + wa, 2.0 * (M_PI - wa));
+    else {
+      enum_prune_lookahead_arc(arc, phi + wa, wb - wa);
+      enum_prune_lookahead_arc(arc, phi - wb, wb - wa);
+    }
+
+    /* intersect the arcs with the running intersection. */
+    intervals_intersect(cur, arc, nxt);
+    if (nxt->size == 0)
+      return 0;
+
+    swp = cur;
+    cur = nxt;
+    nxt = swp;
+  }
+
+  /* the intersection is non-empty. */
+  return 1;
+}
+
+/* enum_prune_lookahead_init(): initialize the lookahead pruner.
+ */
+int enum_prune_lookahead_init (enum_t *E, unsigned int lev) {
+  /* declare required variables:
+   *  @next: level of the next embedded atom.
+   *  @data: closure data pointer.
+   */
+  enum_prune_lookahead_t *data;
+  unsigned int next;
+
+  /* locally store the originality array and the order length. */
+  const unsigned int *dup = E->G->orig;
+  const unsigned int n = E->G->n_order;
+
+  /* do not look ahead from the initial clique. */
+  if (lev < 3)
+    return 1;
+
+  /* find the next atom that is embedded on a circle of positions. any
+   * duplicate atoms in between are placed as soon as the current atom is.
+   */
+  for (next = lev + 1; next < n && dup[next]; next++);
+  if (next >= n)
+    return 1;
+
+  /* allocate a new closure payload. */
+  data = (enum_prune_lookahead_t*) malloc(sizeof(enum_prune_lookahead_t));
+  if (!data)
+    return 0;
+
+  /* initialize the payload contents. */
+  data->stat = enum_prune_add_stats(E, 2);
+  data->lev = lev;
+  data->next = next;
+
+  /* locate the positions of the preceding atoms of the next atom,
+   * resolving duplicates that have not been placed yet.
+   */
+  for (unsigned int k = 0; k < 3; k++) {
+    unsigned int l = next - 3 + k;
+    while (l > lev)
+      l -= dup[l];
+
+    data->frame[k] = l;
+  }
+
+  /* register the closure with the enumerator. */
+  if (!enum_prune_add_closure(E, lev, enum_prune_lookahead, data))
+    return 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_lookahead(): determine whether an enumerator tree may be
+ * pruned at a given node based on the feasibility of its children.
+ *
+ * every child of the node lies on a circle around the axis through the
+ * two atoms preceding it, at an angle omega. the squared distance from
+ * a child to any placed atom has the form k - 2 r cos(omega - phi), so
+ * each distance test of the next level admits at most two arcs of the
+ * circle. the node is pruned if the intersection of these arcs is empty,
+ * as then none of its children can pass the tests.
+ */
+int enum_prune_lookahead (enum_t *E, enum_thread_t *th, void *data) {
+  /* get the closure payload, and the prune kernel of the next level. */
+  enum_prune_lookahead_t *la = (enum_prune_lookahead_t*) data;
+  const enum_kernel_t *K = E->kern + la->next;
+  const enum_plan_t *plan = E->plan + la->next;
+  const unsigned int *dup = E->G->orig;
+
+  /* return if the next level holds no distance tests. */
+  const unsigned int n = K->n_pair + K->n_upper;
+  if (!n)
+    return 0;
+
+  /* pull the preceding atom positions into local variables. */
+  const enum_thread_node_t *state = th->state;
+  const vector_t x0 = state[la->frame[0]].pos;
+  const vector_t x1 = state[la->frame[1]].pos;
+  const vector_t x2 = state[la->frame[2]].pos;
+
+  /* e1 = (x2 - x1) / |x2 - x1|, the axis of the circle. */
+  vector_t e1, v;
+  e1.x = x2.x - x1.x;
+  e1.y = x2.y - x1.y;
+  e1.z = x2.z - x1.z;
+  vector_normalize(&e1);
+
+  /* compute the center and radius of the circle. */
+  const double r = plan->d23 * plan->st;
+  vector_t c = x2;
+  vector_axpy(&c, -plan->d23 * plan->ct, &e1);
+
+  /* declare arrays holding the terms of every test that admits only
+   * part of the circle:
+   *  @w: position of the test atom, relative to the center.
+   *  @wl, @wu: bounds on the cosine of the angle between the test atom
+   *            and the points of the circle, about its axis.
+   *  @m: number of such tests.
+   */
+  vector_t w[n];
+  double wl[n], wu[n];
+  unsigned int m = 0;
+
+  /* loop over the distance tests of the next level. */
+  enum_stat_inc(th, la->stat);
+  for (unsigned int i = 0; i < n; i++) {
+    const enum_kernel_pair_t *p =
+      (i < K->n_pair ? K->pair + i : K->upper + (i - K->n_pair));
+
+    /* get the level of the placed atom of the test. */
+    unsigned int a = p->lev;
+    while (a > la->lev)
+      a -= dup[a];
+
+    /* the bond and angle to the two preceding atoms are exact on the
+     * whole circle.
+     */
+    if (a == la->frame[1] || a == la->frame[2])
+      continue;
+
+    /* u = x[a] - c */
+    vector_t u;
+    u.x = state[a].pos.x - c.x;
+    u.y = state[a].pos.y - c.y;
+    u.z = state[a].pos.z - c.z;
+
+    /* compute the terms of the squared distance over the circle, from
+     * the axial and radial components of @u.
+     */
+    const double h = u.x * e1.x + u.y * e1.y + u.z * e1.z;
+    const double q = u.x * u.x + u.y * u.y + u.z * u.z;
+    const double k = q + r * r;
+    const double amp = 2.0 * r * sqrt(q > h * h ? q - h * h : 0.0);
+
+    /* widen the bounds slightly to absorb round-off in the embedding. */
+    const double delta = 1.0e-9 * k;
+    const double lo2 = p->lo2 - delta;
+    const double hi2 = p->hi2 + delta;
+
+    /* the distance is constant for atoms on the axis of the circle. */
+    if (amp <= delta) {
+      if (k < lo2 || k > hi2)
+        goto prune;
+
+      continue;
+    }
+
+    /* the circle misses the shell entirely, or lies within it. */
+    if (k - hi2 > amp || k - lo2 < -amp)
+      goto prune;
+
+    if (k - hi2 <= -amp && k - lo2 >= amp)
+      continue;
+
+    /* store the position and the bounds on cos(omega - phi). */
+    w[m] = u;
+    wl[m] = (k - hi2) / amp;
+    wu[m] = (k - lo2) / amp;
+    m++;
+  }
+
+  /* prune if the arcs admitted by the tests have no common point. */
+  v.x = x1.x - x0.x;
+  v.y = x1.y - x0.y;
+  v.z = x1.z - x0.z;
+  if (!enum_prune_lookahead_meet(m, w, wl, wu, e1, v))
+    goto prune;
+
+  /* do not prune. */
+  return 0;
+
+prune:
+  /* no child of the node is feasible; prune. */
+  enum_stat_inc(th, la->stat + 1);
+  return 1;
+}
+
+/* enum_prune_lookahead_report(): output a report for the lookahead
+ * pruning closure.
+ */
+void enum_prune_lookahead_report (enum_t *E, unsigned int lev, void *data) {
+  /* get the closure payload. */
+  enum_prune_lookahead_t *la = (enum_prune_lookahead_t*) data;
+
+  /* get the test and prune counts of the closure. */
+  const unsigned long nt = enum_prune_get_stat(E, la->stat);
+  const unsigned long np = enum_prune_get_stat(E, la->stat + 1);
+
+  /* return if no prunes were performed by the closure. */
+  if (!np) return;
+
+  /* get the atom indices. */
+  unsigned int a0 = E->G->order[la->lev];
+  unsigned int a1 = E->G->order[la->next];
+
+  /* get the residue indices. */
+  unsigned int r0 = E->P->atoms[a0].res_id;
+  unsigned int r1 = E->P->atoms[a1].res_id;
+
+  /* get the atom names. */
+  const char *atom0 = E->P->atoms[a0].name;
+  const char *atom1 = E->P->atoms[a1].name;
+
+  /* get the residue codes. */
+  const char *res0 = peptide_get_resname(E->P, r0);
+  const char *res1 = peptide_get_resname(E->P, r1);
+
+  /* compute the percentage. */
+  double f = ((double) np) / ((double) nt) * 100.0;
+
+  /* output the statistics. */
+  printf("  %3s%-4u %-4s | %3s%-4u %-4s : %16lu/%-16lu  %6.2lf%%\n",
+         res0, r0 + 1, atom0,
+         res1, r1 + 1, atom1,
+         np, nt, f);
+}
@@ -4,66 +4,171 @@
 #include "enum-thread.h"
 #include "enum-prune.h"
 
+/* include the c float header. */
+#include <float.h>
+
 /* enum_prune_path_t: structure for holding information required for
- * shortest path feasibility pruning closures.
+ * triangle (shortest path) feasibility pruning closures.
+ *
+ * the tests of a closure bound the distance from the atom at its level
+ * to each earlier atom, using the triangle inequalities through every
+ * later atom. the bounds never change during enumeration, so they are
+ * tabulated once, as squared distances in structure-of-arrays layout.
  */
 typedef struct {
-  /* @ntest: number of calls made or each neighbor pair.
-   * @nprune: number of prunes performed for each neighbor pair.
+  /* @n: number of tests of the closure.
+   * @other: index of the test counter shared by all tests that are not
+   *         sampled, or UINT_MAX if every test has its own counters.
+   *         the prune counter is @other + 1.
+   * @lev: array of levels of the earlier atom of each test.
+   * @stat: array of indices of the test counter of each test. the
+   *        prune counter is @stat + 1.
+   * @lo2, @hi2: arrays of squared bounds of each test, including
+   *             tolerances.
    */
-  unsigned int **ntest, **nprune;
+  unsigned int n, other;
+  unsigned int *lev, *stat;
+  double *lo2, *hi2;
 }
 enum_prune_path_t;
 
-/* enum_prune_path_init(): initialize the path pruning device.
+/* enum_prune_path_init(): initialize the triangle feasibility pruner.
  */
 int enum_prune_path_init (enum_t *E, unsigned int lev) {
   /* declare required variables:
    *  @data: closure data pointer.
-   *  @sz: closure memory footprint.
-   *  @na, @nb: row and column counts.
+   *  @ks, @lk, @uk: levels and bounds of the later atoms that have a
+   *                 graph edge to the atom at the current level.
+   *  @lo, @hi: arrays of bounds implied on each earlier atom.
+   *  @nk, @nt: numbers of later atoms and of tests.
    */
   enum_prune_path_t *data;
-  unsigned int sz, na, nb;
-  char *rtest, *rprune;
+  unsigned int *ks, nk, nt;
+  double *lk, *uk, *lo, *hi;
 
-  /* compute the number of table rows and columns. */
-  na = lev;
-  nb = E->G->n_order - lev - 1;
+  /* do not test the initial clique. */
+  if (lev < 3)
+    return 1;
 
-  /* compute the closure memory block size. */
-  sz = sizeof(enum_prune_path_t)
-     + 2 * na * sizeof(unsigned int*)
-     + 2 * na * nb * sizeof(unsigned int);
+  /* return if a closure is already registered at the level, which
+   * happens when the method is requested under both of its names.
+   */
+  for (unsigned int i = 0; i < E->prune_sz[lev]; i++) {
+    if (E->prune[lev][i] == enum_prune_path)
+      return 1;
+  }
 
-  /* allocate the closure payload. */
-  data = (enum_prune_path_t*) malloc(sz);
-  if (!data)
+  /* locally store the graph, re-order and originality arrays. */
+  graph_t *G = E->G;
+  const unsigned int *order = G->order;
+  const unsigned int *dup = G->orig;
+  const unsigned int n = G->n_order;
+  const unsigned int j = lev;
+
+  /* allocate temporary arrays. */
+  ks = (unsigned int*) malloc(n * sizeof(unsigned int));
+  lk = (double*) malloc(4 * n * sizeof(double));
+  if (!ks || !lk) {
+    free(ks);
+    free(lk);
     return 0;
+  }
+
+  uk = lk + n;
+  lo = uk + n;
+  hi = lo + n;
+
+  /* gather the bounds from the current atom to every later atom. */
+  nk = 0;
+  for (unsigned int k = j + 1; k < n; k++) {
+    /* skip duplicate atoms and atoms without defined bounds. */
+    const value_t djk = graph_get_edge(G, order[j], order[k]);
+    if (dup[k] || djk.type == VALUE_TYPE_UNDEFINED)
+      continue;
+
+    ks[nk] = k;
+    lk[nk] = djk.l;
+    uk[nk] = djk.u;
+    nk++;
+  }
+
+  /* compute the tightest bounds on the distance to each earlier atom:
+   *  d(i,j) <= d(i,k) + d(j,k)
+   *  d(i,j) >= d(i,k) - d(j,k), d(j,k) - d(i,k)
+   */
+  nt = 0;
+  for (unsigned int i = 0; i < j; i++) {
+    lo[i] = 0.0;
+    hi[i] = DBL_MAX;
+    if (dup[i])
+      continue;
+
+    for (unsigned int t = 0; t < nk; t++) {
+      const value_t dik = graph_get_edge(G, order[i], order[ks[t]]);
+      if (dik.type == VALUE_TYPE_UNDEFINED)
+        continue;
+
+      if (dik.u + uk[t] < hi[i]) hi[i] = dik.u + uk[t];
+      if (dik.l - uk[t] > lo[i]) lo[i] = dik.l - uk[t];
+      if (lk[t] - dik.u > lo[i]) lo[i] = lk[t] - dik.u;
+    }
 
-  /* initialize the first array pointer. */
-  sz = sizeof(enum_prune_path_t);
-  data->ntest = (unsigned int**) (((char*) data) + sz);
-
-  /* initialize the second array pointer. */
-  sz += na * (nb * sizeof(unsigned int) + sizeof(unsigned int*));
-  data->nprune = (unsigned int**) (((char*) data) + sz);
-
-  /* initialize the array row pointers. */
-  rtest  = ((char*) data->ntest)  + (na * sizeof(unsigned int*));
-  rprune = ((char*) data->nprune) + (na * sizeof(unsigned int*));
-  sz  = nb * sizeof(unsigned int);
-  for (unsigned int i = 0; i < na; i++) {
-    /* set the row pointers. */
-    data->ntest[i]  = (unsigned int*) (rtest  + (i * sz));
-    data->nprune[i] = (unsigned int*) (rprune + (i * sz));
-
-    /* initialize the row contents. */
-    for (unsigned int k = 0; k < nb; k++)
-      data->ntest[i][k] = data->nprune[i][k] = 0;
+    /* count the earlier atoms that received any bound. */
+    nt += (lo[i] > 0.0 || hi[i] < DBL_MAX);
   }
 
-  /* register a closure. */
+  /* skip levels without any bounds. */
+  if (!nt) {
+    free(ks);
+    free(lk);
+    return 1;
+  }
+
+  /* allocate the closure payload along with its arrays. */
+  data = (enum_prune_path_t*)
+    malloc(sizeof(enum_prune_path_t) +
+           nt * (2 * sizeof(double) + 2 * sizeof(unsigned int)));
+  if (!data) {
+    free(ks);
+    free(lk);
+    return 0;
+  }
+
+  data->lo2 = (double*) (data + 1);
+  data->hi2 = data->lo2 + nt;
+  data->lev = (unsigned int*) (data->hi2 + nt);
+  data->stat = data->lev + nt;
+
+  /* store the squared bounds, widened by the ddf tolerance. */
+  data->n = 0;
+  for (unsigned int i = 0; i < j; i++) {
+    if (dup[i] || (lo[i] <= 0.0 && hi[i] == DBL_MAX))
+      continue;
+
+    const double l = lo[i] - E->ddf_tol;
+    const double u = (hi[i] < DBL_MAX ? hi[i] + E->ddf_tol : DBL_MAX);
+
+    const unsigned int t = data->n++;
+    data->lev[t] = i;
+    data->lo2[t] = (l > 0.0 ? l * l : -1.0);
+    data->hi2[t] = (u < DBL_MAX ? u * u : DBL_MAX);
+  }
+
+  /* free the temporary arrays. */
+  free(ks);
+  free(lk);
+
+  /* reserve the test and prune counters of each test. when sampling,
+   * only evenly spaced tests receive their own counters, and all other
+   * tests of the level share a single pair of counters.
+   */
+  const unsigned int ns = E->path_sample;
+  const unsigned int stride = (ns && nt > ns ? (nt + ns - 1) / ns : 1);
+  data->other = (stride > 1 ? enum_prune_add_stats(E, 2) : UINT_MAX);
+  for (unsigned int t = 0; t < nt; t++)
+    data->stat[t] = (t % stride ? data->other : enum_prune_add_stats(E, 2));
+
+  /* register the closure with the enumerator. */
   if (!enum_prune_add_closure(E, lev, enum_prune_path, data))
     return 0;
 
@@ -72,56 +177,30 @@ int enum_prune_path_init (enum_t *E, unsigned int lev) {
 }
 
 /* enum_prune_path(): determine whether an enumerator tree may be pruned
- * at a given node based on shortest path feasibility.
+ * at a given node based on triangle (shortest path) feasibility.
  */
 int enum_prune_path (enum_t *E, enum_thread_t *th, void *data) {
-  /* declare required variables:
-   *  @dik: distance bound from x(i) to x(k).
-   *  @djk: distance bound from x(j) to x(k).
-   *  @dij: current distance between x(i) and x(j).
-   */
-  value_t dik, djk;
-  double dij;
-
   /* get the payload. */
   enum_prune_path_t *path_data = (enum_prune_path_t*) data;
 
-  /* locally store the level, thread length, and originality array. */
-  const unsigned int n = E->G->n_order;
-  const unsigned int *dup = E->G->orig;
-  const unsigned int j = th->level;
-
   /* locally store the end position. */
-  vector_t *thpos = &th->state[j].pos;
-
-  /* loop over all upstream embedded atoms. */
-  for (unsigned int i = j - 1; i < n; i--) {
-    /* skip duplicate atoms. */
-    if (dup[i]) continue;
-
-    /* compute the distance between the two nodes. */
-    dij = vector_dist(&th->state[i].pos, thpos);
-
-    /* loop over all future (un-embedded) atoms. */
-    for (unsigned int k = j + 1; k < n; k++) {
-      /* skip duplicate atoms. */
-      if (dup[k]) continue;
-
-      /* obtain the distance bounds to the future atom. */
-      dik = graph_get_edge(E->G, E->G->order[i], E->G->order[k]);
-      djk = graph_get_edge(E->G, E->G->order[j], E->G->order[k]);
-
-      /* skip future atoms without defined bounds. */
-      if (dik.type == VALUE_TYPE_UNDEFINED ||
-          djk.type == VALUE_TYPE_UNDEFINED)
-        continue;
-
-      /* prune if the future atom is unreachable. */
-      path_data->ntest[i][k - j - 1]++;
-      if (dij - dik.u > djk.u) {
-        path_data->nprune[i][k - j - 1]++;
-        return 1;
-      }
+  const enum_thread_node_t *state = th->state;
+  const vector_t x = state[th->level].pos;
+
+  /* loop over the tabulated tests. */
+  for (unsigned int t = 0; t < path_data->n; t++) {
+    /* compute the squared distance to the earlier atom. */
+    const vector_t *y = &state[path_data->lev[t]].pos;
+    const double dx = x.x - y->x;
+    const double dy = x.y - y->y;
+    const double dz = x.z - y->z;
+    const double d2 = dx * dx + dy * dy + dz * dz;
+
+    /* prune if the distance leaves the bounds. */
+    enum_stat_inc(th, path_data->stat[t]);
+    if (d2 < path_data->lo2[t] || d2 > path_data->hi2[t]) {
+      enum_stat_inc(th, path_data->stat[t] + 1);
+      return 1;
     }
   }
 
@@ -129,61 +208,82 @@ int enum_prune_path (enum_t *E, enum_thread_t *th, void *data) {
   return 0;
 }
 
-/* enum_prune_path_report(): output a report for the shortest path
- * feasbility (i.e. DSP) pruning closure.
+/* enum_prune_path_compile(): merge a triangle feasibility closure into
+ * the prune kernel of its level.
  */
-void enum_prune_path_report (enum_t *E, unsigned int lev, void *data) {
-  /* get the closure payload. */
+int enum_prune_path_compile (enum_t *E, unsigned int lev, void *data,
+                             enum_kernel_t *K) {
+  /* get the payload. */
   enum_prune_path_t *path_data = (enum_prune_path_t*) data;
 
-  /* get the inner atom/residue indices. */
-  unsigned int j = lev;
-  unsigned int aj = E->G->order[j];
-  unsigned int rj = E->P->atoms[aj].res_id;
+  /* add a two-sided distance test for each earlier atom. */
+  for (unsigned int t = 0; t < path_data->n; t++) {
+    if (!enum_prune_add_pair(K, path_data->lev[t], path_data->stat[t],
+                             path_data->lo2[t], path_data->hi2[t], 1))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_path_report(): output a report for the triangle
+ * feasibility pruning closure.
+ */
+void enum_prune_path_report (enum_t *E, unsigned int lev, void *data) {
+  /* get the payload. */
+  enum_prune_path_t *path_data = (enum_prune_path_t*) data;
 
-  /* get the inner atom/residue names. */
+  /* get the atom index, residue index and names of the current atom. */
+  const unsigned int aj = E->G->order[lev];
+  const unsigned int rj = E->P->atoms[aj].res_id;
   const char *atomj = E->P->atoms[aj].name;
   const char *resj = peptide_get_resname(E->P, rj);
 
-  /* loop over all tested prior neighbors. */
-  for (unsigned int i = j - 1; i < E->G->n_order; i--) {
-    /* skip duplicate prior atoms. */
-    if (E->G->orig[i]) continue;
+  /* loop over the tests that have their own counters. */
+  unsigned int nother = 0;
+  for (unsigned int t = 0; t < path_data->n; t++) {
+    /* count the tests that share counters. */
+    const unsigned int stat = path_data->stat[t];
+    if (stat == path_data->other) {
+      nother++;
+      continue;
+    }
+
+    /* get the test and prune counts of the test. */
+    const unsigned long nt = enum_prune_get_stat(E, stat);
+    const unsigned long np = enum_prune_get_stat(E, stat + 1);
 
-    /* get the first atom/residue indices. */
-    unsigned int ai = E->G->order[i];
-    unsigned int ri = E->P->atoms[ai].res_id;
+    /* skip tests that performed no prunes. */
+    if (!np) continue;
 
-    /* get the first atom/residue names. */
+    /* get the atom index, residue index and names of the earlier atom. */
+    const unsigned int ai = E->G->order[path_data->lev[t]];
+    const unsigned int ri = E->P->atoms[ai].res_id;
     const char *atomi = E->P->atoms[ai].name;
     const char *resi = peptide_get_resname(E->P, ri);
 
-    /* loop over all tested posterior neighbors. */
-    for (unsigned int k = j + 1; k < E->G->n_order; k++) {
-      /* skip duplicates and non-pruned posteriors. */
-      if (E->G->orig[k] || !path_data->nprune[i][k - j - 1]) continue;
-
-      /* get the last atom/residue indices. */
-      unsigned int ak = E->G->order[k];
-      unsigned int rk = E->P->atoms[ak].res_id;
-
-      /* get the last atom/residue names. */
-      const char *atomk = E->P->atoms[ak].name;
-      const char *resk = peptide_get_resname(E->P, rk);
-
-      /* compute the percentage. */
-      unsigned int np = path_data->nprune[i][k - j - 1];
-      unsigned int nt = path_data->ntest[i][k - j - 1];
-      double f = ((double) np) / ((double) nt) * 100.0;
-
-      /* output the statistics. */
-      printf("  %3s%-4u %-4s | %3s%-4u %-4s | %3s%-4u %-4s : "
-             "%16u/%-16u  %6.2lf%%\n",
-             resi, ri + 1, atomi,
-             resj, rj + 1, atomj,
-             resk, rk + 1, atomk,
-             np, nt, f);
-    }
+    /* compute the percentage. */
+    double f = ((double) np) / ((double) nt) * 100.0;
+
+    /* output the statistics. */
+    printf("  %3s%-4u %-4s | %3s%-4u %-4s : "
+           "%16lu/%-16lu  %6.2lf%%\n",
+           resj, rj + 1, atomj,
+           resi, ri + 1, atomi,
+           np, nt, f);
   }
-}
 
+  /* return if no prunes were performed by the shared counters. */
+  if (!nother) return;
+  const unsigned long nt = enum_prune_get_stat(E, path_data->other);
+  const unsigned long np = enum_prune_get_stat(E, path_data->other + 1);
+  if (!np) return;
+
+  /* output the statistics of the tests that share counters. */
+  char others[24];
+  snprintf(others, 24, "(%u others)", nother);
+  printf("  %3s%-4u %-4s | %-12s : %16lu/%-16lu  %6.2lf%%\n",
+         resj, rj + 1, atomj, others,
+         np, nt, ((double) np) / ((double) nt) * 100.0);
+}
@@ -8,11 +8,11 @@
  * torsion angle feasibility pruning closures.
  */
 typedef struct {
-  /* @ntest, @nprune: test and prune counts of the current closure.
+  /* @stat: index of the test and prune counters of the closure.
    * @n: array of backward step-counts for the prior atoms.
    * @bound: angle bound to check.
    */
-  unsigned int ntest, nprune;
+  unsigned int stat;
   peptide_dihed_t *arr;
   unsigned int n[4];
   value_t bound;
@@ -63,8 +63,8 @@ static int taf_init (enum_t *E, peptide_dihed_t *arr, unsigned int n_arr,
     if (!data)
       return 0;
 
-    /* initialize the counters. */
-    data->ntest = data->nprune = 0;
+    /* reserve the counters. */
+    data->stat = enum_prune_add_stats(E, 2);
     data->arr = arr;
 
     /* store the offsets. */
@@ -119,7 +119,7 @@ int enum_prune_taf (enum_t *E, enum_thread_t *th, void *data) {
   const double omega = vector_dihedral(&x1, &x2, &x3, &x4);
 
   /* check if the computed dihedral angle is in bounds. */
-  taf_data->ntest++;
+  enum_stat_inc(th, taf_data->stat);
   int feasible = 0;
   for (int n = -2; n <= 2; n += 2) {
     /* compute the shifted feasibility boundary. */
@@ -136,7 +136,7 @@ int enum_prune_taf (enum_t *E, enum_thread_t *th, void *data) {
 
   /* if all three boundaries fail to contain the angle, prune. */
   if (!feasible) {
-    taf_data->nprune++;
+    enum_stat_inc(th, taf_data->stat + 1);
     return 1;
   }
 
@@ -144,6 +144,25 @@ int enum_prune_taf (enum_t *E, enum_thread_t *th, void *data) {
   return 0;
 }
 
+/* enum_prune_taf_compile(): merge a dihedral or improper feasibility
+ * closure into the prune kernel of its level.
+ */
+int enum_prune_taf_compile (enum_t *E, unsigned int lev, void *data,
+                            enum_kernel_t *K) {
+  /* get the payload. */
+  enum_prune_taf_t *taf_data = (enum_prune_taf_t*) data;
+
+  /* compute the levels of the four atoms. */
+  unsigned int levs[4];
+  for (unsigned int k = 0; k < 4; k++)
+    levs[k] = lev - taf_data->n[k];
+
+  /* add the test, with the tolerance folded into the bounds. */
+  return enum_prune_add_quad(K, levs, taf_data->stat,
+                             taf_data->bound.l - E->ddf_tol,
+                             taf_data->bound.u + E->ddf_tol);
+}
+
 /* enum_prune_taf_report(): function utilized by:
  *  - enum_prune_dihe_init()
  *  - enum_prune_impr_init()
@@ -153,10 +172,14 @@ void enum_prune_taf_report (enum_t *E, peptide_dihed_t *arr,
   /* get the closure payload. */
   enum_prune_taf_t *taf_data = (enum_prune_taf_t*) data;
 
+  /* get the test and prune counts of the closure. */
+  const unsigned long nt = enum_prune_get_stat(E, taf_data->stat);
+  const unsigned long np = enum_prune_get_stat(E, taf_data->stat + 1);
+
   /* return if the requested array does not match, or if
    * no prunes were performed by the closure.
    */
-  if (taf_data->arr != arr || !taf_data->nprune) return;
+  if (taf_data->arr != arr || !np) return;
 
   /* get the atom indices. */
   unsigned int a0 = E->G->order[lev - taf_data->n[0]];
@@ -183,18 +206,17 @@ void enum_prune_taf_report (enum_t *E, peptide_dihed_t *arr,
   const char *res3 = peptide_get_resname(E->P, r3);
 
   /* compute the percentage. */
-  double f = ((double) taf_data->nprune) /
-             ((double) taf_data->ntest) * 100.0;
+  double f = ((double) np) / ((double) nt) * 100.0;
 
   /* output the statistics. */
   printf("  %3s%-4u %-4s | %3s%-4u %-4s | "
          "%3s%-4u %-4s | %3s%-4u %-4s : "
-         "%16u/%-16u  %6.2lf%%\n",
+         "%16lu/%-16lu  %6.2lf%%\n",
          res0, r0 + 1, atom0,
          res1, r1 + 1, atom1,
          res2, r2 + 1, atom2,
          res3, r3 + 1, atom3,
-         taf_data->nprune, taf_data->ntest, f);
+         np, nt, f);
 }
 
 /* enum_prune_dihe_report(): output a report for the dihedral angle
@@ -57,6 +57,52 @@ int enum_prune_add_closure (enum_t *E, unsigned int lev,
   return 1;
 }
 
+/* enum_prune_add_stats(): reserve a block of statistics counters for
+ * a pruning closure. every enumerator thread holds its own copy of each
+ * counter, and the copies are summed after enumeration.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *  @n: number of counters to reserve.
+ *
+ * returns:
+ *  index of the first reserved counter.
+ */
+unsigned int enum_prune_add_stats (enum_t *E, unsigned int n) {
+  /* reserve the counters at the end of the current block. */
+  const unsigned int base = E->nstats;
+  E->nstats += n;
+
+  /* return the index of the first counter. */
+  return base;
+}
+
+/* enum_prune_get_stat(): sum the values of a statistics counter over
+ * all the threads of an enumerator.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @i: index of the counter to sum.
+ *
+ * returns:
+ *  total value of the counter.
+ */
+unsigned long enum_prune_get_stat (enum_t *E, unsigned int i) {
+  /* declare required variables:
+   *  @sum: total value of the counter.
+   */
+  unsigned long sum = 0;
+
+  /* sum the counter over all threads. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    if (E->threads[t].stats)
+      sum += E->threads[t].stats[i];
+  }
+
+  /* return the total. */
+  return sum;
+}
+
 /* enum_prune_get_level(): function utilized by pruning initialization
  * functions to check whether all atoms in a given entry have been embedded.
  *
@@ -87,3 +133,289 @@ unsigned int enum_prune_get_level (unsigned int *order,
   return i;
 }
 
+
+/* enum_prune_grow(): make room for one more element at the end of an
+ * array held by a prune kernel. arrays are grown in powers of two, so
+ * their capacity is implied by their size.
+ *
+ * arguments:
+ *  @arr: pointer to the array to grow.
+ *  @n: current number of elements in the array.
+ *  @sz: size of each element of the array.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_prune_grow (void **arr, unsigned int n, size_t sz) {
+  /* return if the array still has room. */
+  if (n & (n - 1))
+    return 1;
+
+  /* double the capacity of the array. */
+  void *ptr = realloc(*arr, (n ? 2 * n : 1) * sz);
+  if (!ptr)
+    throw("unable to reallocate prune kernel array");
+
+  /* store the new array and return success. */
+  *arr = ptr;
+  return 1;
+}
+
+/* enum_prune_add_pair(): add a distance test to a prune kernel.
+ *
+ * arguments:
+ *  @K: pointer to the prune kernel to modify.
+ *  @lev: level of the earlier atom of the test.
+ *  @stat: index of the test counter of the test.
+ *  @lo2, @hi2: squared bounds on the distance, including tolerances.
+ *              a negative @lo2 leaves the distance unbounded below.
+ *  @batch: whether or not the test is applied to batches of siblings,
+ *          in which case it is held as a two-sided test. all other
+ *          tests only check the upper bound.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_prune_add_pair (enum_kernel_t *K, unsigned int lev,
+                         unsigned int stat, double lo2, double hi2,
+                         unsigned int batch) {
+  /* declare required variables:
+   *  @arr: array to add the test into.
+   *  @n: size of the array.
+   */
+  enum_kernel_pair_t **arr;
+  unsigned int *n;
+
+  /* select the array of the test. */
+  if (batch) {
+    arr = &K->pair;
+    n = &K->n_pair;
+  }
+  else {
+    arr = &K->upper;
+    n = &K->n_upper;
+  }
+
+  /* grow the array. */
+  if (!enum_prune_grow((void**) arr, *n, sizeof(enum_kernel_pair_t)))
+    return 0;
+
+  /* store the test. */
+  enum_kernel_pair_t *p = *arr + (*n)++;
+  p->lev = lev;
+  p->stat = stat;
+  p->conf = 0;
+  p->lo2 = lo2;
+  p->hi2 = hi2;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_add_quad(): add a dihedral angle test to a prune kernel.
+ *
+ * arguments:
+ *  @K: pointer to the prune kernel to modify.
+ *  @lev: array of levels of the four atoms of the test.
+ *  @stat: index of the test counter of the test.
+ *  @l, @u: bounds on the dihedral angle, including tolerances.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_prune_add_quad (enum_kernel_t *K, const unsigned int *lev,
+                         unsigned int stat, double l, double u) {
+  /* grow the array. */
+  if (!enum_prune_grow((void**) &K->quad, K->n_quad,
+                       sizeof(enum_kernel_quad_t)))
+    return 0;
+
+  /* store the test. */
+  enum_kernel_quad_t *q = K->quad + K->n_quad++;
+  for (unsigned int k = 0; k < 4; k++)
+    q->lev[k] = lev[k];
+
+  q->stat = stat;
+  q->conf = 0;
+  q->l = l;
+  q->u = u;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_conflict(): compute the shallowest level whose branch the
+ * outcome of a test between the atom at a level and earlier atoms
+ * depends on.
+ *
+ * the three atoms from a level m onwards are held at exact distances from
+ * each other, so the positions of the atoms at levels m, ..., lev relative
+ * to them only depend on the branches taken at levels m + 3 and deeper,
+ * provided that every duplicate atom in that range repeats an atom that
+ * is also in the range. the range is therefore widened from the earliest
+ * atom of the test until it holds the source of every duplicate atom.
+ *
+ * arguments:
+ *  @G: pointer to the graph structure to access.
+ *  @lev: level of the current atom of the test.
+ *  @a: shallowest level of the atoms of the test.
+ *
+ * returns:
+ *  shallowest level whose branch the outcome of the test depends on.
+ */
+static unsigned int enum_prune_conflict (const graph_t *G, unsigned int lev,
+                                         unsigned int a) {
+  /* widen the range until it holds the sources of its duplicates. */
+  unsigned int m = a;
+  for (unsigned int x = lev + 1; x-- > m;) {
+    if (G->orig[x] && x - G->orig[x] < m)
+      m = x - G->orig[x];
+  }
+
+  /* return the first level that branches within the range. */
+  return m + 3;
+}
+
+/* enum_prune_set_conflicts(): compute the conflict levels of the
+ * distance and dihedral tests held by the prune kernel of a level.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @lev: level of the prune kernel.
+ *  @K: pointer to the prune kernel to modify.
+ */
+void enum_prune_set_conflicts (enum_t *E, unsigned int lev,
+                               enum_kernel_t *K) {
+  /* set the conflict levels of the distance tests. */
+  for (unsigned int i = 0; i < K->n_pair; i++)
+    K->pair[i].conf = enum_prune_conflict(E->G, lev, K->pair[i].lev);
+
+  for (unsigned int i = 0; i < K->n_upper; i++)
+    K->upper[i].conf = enum_prune_conflict(E->G, lev, K->upper[i].lev);
+
+  /* set the conflict levels of the dihedral tests. */
+  for (unsigned int i = 0; i < K->n_quad; i++) {
+    enum_kernel_quad_t *q = K->quad + i;
+    unsigned int a = q->lev[0];
+    for (unsigned int k = 1; k < 4; k++)
+      a = (q->lev[k] < a ? q->lev[k] : a);
+
+    q->conf = enum_prune_conflict(E->G, lev, a);
+  }
+}
+
+/* enum_prune_add_term(): add an energy term to a prune kernel.
+ *
+ * arguments:
+ *  @K: pointer to the prune kernel to modify.
+ *  @type: type of the energy term.
+ *  @lev: array of levels of the atoms of the term.
+ *  @stat: index of the test counter of the terms of the type.
+ *  @c: array of three polynomial coefficients of the term.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_prune_add_term (enum_kernel_t *K, unsigned int type,
+                         const unsigned int *lev, unsigned int stat,
+                         const double *c) {
+  /* get the terms of the type. */
+  enum_kernel_term_t *T = K->term + type;
+
+  /* grow the arrays. */
+  for (unsigned int k = 0; k < 4; k++) {
+    if (!enum_prune_grow((void**) &T->lev[k], T->n, sizeof(unsigned int)))
+      return 0;
+  }
+
+  for (unsigned int k = 0; k < 3; k++) {
+    if (!enum_prune_grow((void**) &T->c[k], T->n, sizeof(double)))
+      return 0;
+  }
+
+  /* store the term. */
+  const unsigned int i = T->n++;
+  for (unsigned int k = 0; k < 4; k++)
+    T->lev[k][i] = lev[k];
+
+  for (unsigned int k = 0; k < 3; k++)
+    T->c[k][i] = c[k];
+
+  T->stat = stat;
+  K->n_term++;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_add_func(): add a closure that could not be merged into
+ * the tests of a prune kernel, to be called by the kernel as is.
+ *
+ * arguments:
+ *  @K: pointer to the prune kernel to modify.
+ *  @func: pruning test function pointer of the closure.
+ *  @data: pruning data payload of the closure.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_prune_add_func (enum_kernel_t *K, enum_prune_test_fn func,
+                         void *data) {
+  /* grow the arrays. */
+  if (!enum_prune_grow((void**) &K->func, K->n_func,
+                       sizeof(enum_prune_test_fn)) ||
+      !enum_prune_grow((void**) &K->data, K->n_func, sizeof(void*)))
+    return 0;
+
+  /* store the closure. */
+  K->func[K->n_func] = func;
+  K->data[K->n_func] = data;
+  K->n_func++;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_prune_sort_pairs(): reorder the two-sided distance tests of each
+ * prune kernel of an enumerator by their measured prune rates, so that
+ * the tests that fail most often are run first. tests that have not yet
+ * been run keep their place after the measured tests.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ */
+void enum_prune_sort_pairs (enum_t *E) {
+#ifdef __IBP_HAVE_STATS
+  /* loop over the prune kernels of every level. */
+  for (unsigned int lev = 0; lev < E->G->n_order; lev++) {
+    enum_kernel_t *K = E->kern + lev;
+    if (K->n_pair < 2)
+      continue;
+
+    /* compute the prune rate of each test. */
+    double rate[K->n_pair];
+    for (unsigned int i = 0; i < K->n_pair; i++) {
+      const unsigned long nt = enum_prune_get_stat(E, K->pair[i].stat);
+      const unsigned long np = enum_prune_get_stat(E, K->pair[i].stat + 1);
+      rate[i] = (nt ? ((double) np) / ((double) nt) : -1.0);
+    }
+
+    /* sort the tests by decreasing rate, keeping the order of tests
+     * with equal rates.
+     */
+    for (unsigned int i = 1; i < K->n_pair; i++) {
+      const enum_kernel_pair_t p = K->pair[i];
+      const double r = rate[i];
+
+      unsigned int j = i;
+      for (; j > 0 && rate[j - 1] < r; j--) {
+        K->pair[j] = K->pair[j - 1];
+        rate[j] = rate[j - 1];
+      }
+
+      K->pair[j] = p;
+      rate[j] = r;
+    }
+  }
+#endif
+}
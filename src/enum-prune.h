@@ -8,16 +8,42 @@ int enum_prune_add_closure (enum_t *E, unsigned int lev,
                             enum_prune_test_fn func,
                             void *data);
 
+unsigned int enum_prune_add_stats (enum_t *E, unsigned int n);
+
+unsigned long enum_prune_get_stat (enum_t *E, unsigned int i);
+
 unsigned int enum_prune_get_level (unsigned int *order,
                                    unsigned int lev,
                                    unsigned int id);
 
+int enum_prune_add_pair (enum_kernel_t *K, unsigned int lev,
+                         unsigned int stat, double lo2, double hi2,
+                         unsigned int batch);
+
+int enum_prune_add_quad (enum_kernel_t *K, const unsigned int *lev,
+                         unsigned int stat, double l, double u);
+
+int enum_prune_add_term (enum_kernel_t *K, unsigned int type,
+                         const unsigned int *lev, unsigned int stat,
+                         const double *c);
+
+int enum_prune_add_func (enum_kernel_t *K, enum_prune_test_fn func,
+                         void *data);
+
+void enum_prune_set_conflicts (enum_t *E, unsigned int lev,
+                               enum_kernel_t *K);
+
+void enum_prune_sort_pairs (enum_t *E);
+
 /* function declarations (enum-prune-ddf.c): */
 
 int enum_prune_ddf_init (enum_t *E, unsigned int lev);
 
 int enum_prune_ddf (enum_t *E, enum_thread_t *th, void *data);
 
+int enum_prune_ddf_compile (enum_t *E, unsigned int lev, void *data,
+                            enum_kernel_t *K);
+
 void enum_prune_ddf_report (enum_t *E, unsigned int lev, void *data);
 
 /* function declarations (enum-prune-taf.c): */
@@ -28,6 +54,9 @@ int enum_prune_impr_init (enum_t *E, unsigned int lev);
 
 int enum_prune_taf (enum_t *E, enum_thread_t *th, void *data);
 
+int enum_prune_taf_compile (enum_t *E, unsigned int lev, void *data,
+                            enum_kernel_t *K);
+
 void enum_prune_dihe_report (enum_t *E, unsigned int lev, void *data);
 
 void enum_prune_impr_report (enum_t *E, unsigned int lev, void *data);
@@ -38,21 +67,41 @@ int enum_prune_path_init (enum_t *E, unsigned int lev);
 
 int enum_prune_path (enum_t *E, enum_thread_t *th, void *data);
 
-void enum_prune_path_report (enum_t *E, unsigned int lev, void *data);
-
-/* function declarations (enum-prune-future.c): */
-
-int enum_prune_future_init (enum_t *E, unsigned int lev);
-
-int enum_prune_future (enum_t *E, enum_thread_t *th, void *data);
+int enum_prune_path_compile (enum_t *E, unsigned int lev, void *data,
+                             enum_kernel_t *K);
 
-void enum_prune_future_report (enum_t *E, unsigned int lev, void *data);
+void enum_prune_path_report (enum_t *E, unsigned int lev, void *data);
 
 /* function declarations (enum-prune-energy.c): */
 
 int enum_prune_energy_init (enum_t *E, unsigned int lev);
 
+void enum_prune_energy_bound (enum_t *E);
+
 int enum_prune_energy (enum_t *E, enum_thread_t *th, void *data);
 
+int enum_prune_energy_compile (enum_t *E, unsigned int lev, void *data,
+                               enum_kernel_t *K);
+
 void enum_prune_energy_report (enum_t *E, unsigned int lev, void *data);
 
+/* function declarations (enum-prune-clash.c): */
+
+int enum_prune_clash_init (enum_t *E, unsigned int lev);
+
+int enum_prune_clash_alloc (enum_t *E);
+
+void enum_prune_clash_reset (enum_thread_t *th);
+
+int enum_prune_clash (enum_t *E, enum_thread_t *th, void *data);
+
+void enum_prune_clash_report (enum_t *E, unsigned int lev, void *data);
+
+/* function declarations (enum-prune-lookahead.c): */
+
+int enum_prune_lookahead_init (enum_t *E, unsigned int lev);
+
+int enum_prune_lookahead (enum_t *E, enum_thread_t *th, void *data);
+
+void enum_prune_lookahead_report (enum_t *E, unsigned int lev, void *data);
+
@@ -2,6 +2,7 @@
 /* include the enumerator headers. */
 #include "enum.h"
 #include "enum-thread.h"
+#include "enum-reduce.h"
 
 /* _det3x3(): macro function for computing the determinant of
  * a three-by-three matrix, stored linearly in row-major order.
@@ -256,22 +257,207 @@ int solve_iomega_k (vector_t *x1, vector_t *x2, vector_t *x3, vector_t *xk,
   return 1;
 }
 
+/* reduce_bounds(): clamp the distance bounds between an unknown vertex
+ * x0 and a friend vertex xk to the range of distances that are actually
+ * attainable on the circle of positions that x0 may take, given its
+ * distances to x1 and x2. this ensures that the three-sphere intersections
+ * solved by solve_iomega_k() have solutions whenever the circle and the
+ * spherical shell around xk intersect at all.
+ *
+ * arguments:
+ *  @x1: once-removed prior vertex in the order.
+ *  @x2: twice-removed prior vertex in the order.
+ *  @xk: friend vertex in the order.
+ *  @d01: distance between x[i] and x[i-1].
+ *  @d02: distance between x[i] and x[i-2].
+ *  @lk: pointer to the lower bound distance between x[i] and x[k].
+ *  @uk: pointer to the upper bound distance between x[i] and x[k].
+ *
+ * returns:
+ *  integer indicating whether the circle intersects the shell (1),
+ *  does not intersect the shell (0), or lies on an axis passing
+ *  through xk, and so carries no information on omega (-1).
+ */
+static int reduce_bounds (vector_t *x1, vector_t *x2, vector_t *xk,
+                          double d01, double d02, double *lk, double *uk) {
+  /* compute the unit axis of the circle, from x1 to x2. */
+  vector_t e;
+  e.x = x2->x - x1->x;
+  e.y = x2->y - x1->y;
+  e.z = x2->z - x1->z;
+  const double d12 = sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+  e.x /= d12;
+  e.y /= d12;
+  e.z /= d12;
+
+  /* compute the offset of the circle center along the axis,
+   * and the radius of the circle.
+   */
+  const double t = (d01 * d01 - d02 * d02 + d12 * d12) / (2.0 * d12);
+  const double r2 = d01 * d01 - t * t;
+  const double r = (r2 > 0.0 ? sqrt(r2) : 0.0);
+
+  /* w <- xk - (x1 + t e) */
+  vector_t w;
+  w.x = xk->x - x1->x - t * e.x;
+  w.y = xk->y - x1->y - t * e.y;
+  w.z = xk->z - x1->z - t * e.z;
+
+  /* compute the axial and radial components of @w. */
+  const double h = w.x * e.x + w.y * e.y + w.z * e.z;
+  const double rho2 = w.x * w.x + w.y * w.y + w.z * w.z - h * h;
+  const double rho = (rho2 > 0.0 ? sqrt(rho2) : 0.0);
+
+  /* every point on the circle is equidistant from a vertex on its axis. */
+  if (rho * r < 1.0e-9)
+    return -1;
+
+  /* compute the closest and furthest distances from the circle to xk,
+   * pulled inward slightly to guard against round-off.
+   */
+  const double dmin = sqrt(h * h + (rho - r) * (rho - r));
+  const double dmax = sqrt(h * h + (rho + r) * (rho + r));
+  const double delta = 1.0e-7 * (dmax - dmin);
+
+  /* clamp the bounds to the attainable range. */
+  if (*lk < dmin + delta) *lk = dmin + delta;
+  if (*uk > dmax - delta) *uk = dmax - delta;
+
+  /* return whether the clamped bounds are non-empty. */
+  return (*lk <= *uk);
+}
+
+/* enum_reduce_level(): determine whether a level of the tree should
+ * branch on reduced dihedral intervals. only non-duplicate atoms that
+ * have at least one friend besides v(i-3) gain anything from reduction,
+ * as the interval reduction would otherwise just reproduce the dihedrals
+ * of the standard branching scheme.
+ *
+ * arguments:
+ *  @G: pointer to the graph to access.
+ *  @lev: level in the order to check.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the level is reduced.
+ */
+static int enum_reduce_level (graph_t *G, unsigned int lev) {
+  /* the first three atoms and duplicates are never reduced. */
+  if (lev < 3 || G->orig[lev])
+    return 0;
+
+  /* search for a friend that is not the thrice-removed vertex. */
+  for (unsigned int k = 0; k < G->n_friends[lev]; k++) {
+    if (G->friends[lev][k] != G->order[lev - 3])
+      return 1;
+  }
+
+  /* no useful friends exist. */
+  return 0;
+}
+
+/* enum_reduce_init(): allocate the interval sets and dihedral arrays
+ * of every thread at every level that branches on reduced intervals.
+ * the branch counts of each thread state must already be computed.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_reduce_init (enum_t *E) {
+  /* get the graph and the length of the order. */
+  graph_t *G = E->G;
+  const unsigned int len = G->n_order;
+
+  /* count the reduced levels. */
+  E->n_reduce = 0;
+  for (unsigned int lev = 0; lev < len; lev++)
+    E->n_reduce += enum_reduce_level(G, lev);
+
+  /* loop over the threads. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    /* free any arrays from a previous enumeration. */
+    enum_thread_t *th = E->threads + t;
+    enum_reduce_free(th);
+
+    /* loop over the reduced levels. */
+    for (unsigned int lev = 0; lev < len; lev++) {
+      if (!enum_reduce_level(G, lev))
+        continue;
+
+      /* every friend contributes at most four arcs to an intersection,
+       * on top of the initial interval.
+       */
+      enum_thread_node_t *node = th->state + lev;
+      const unsigned int cap = 4 * G->n_friends[lev] + 4;
+
+      /* allocate the interval sets and the dihedral array. */
+      node->isa = intervals_new(cap);
+      node->isb = intervals_new(cap);
+      node->isk = intervals_new(cap);
+      node->omega = (double*) malloc(3 * node->nb * sizeof(double));
+      node->n_omega = ENUM_REDUCE_STALE;
+
+      /* check that allocation succeeded. */
+      if (!node->isa || !node->isb || !node->isk || !node->omega)
+        throw("unable to allocate reduced intervals of thread %u", t + 1);
+
+      /* the cosines and sines share the allocation of the dihedrals. */
+      node->cw = node->omega + node->nb;
+      node->sw = node->cw + node->nb;
+    }
+  }
+
+  /* output an informational message about the reduced levels. */
+  info("interval reduction at %u of %u levels", E->n_reduce, len);
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_reduce_free(): free the interval sets and dihedral arrays of
+ * an enumerator thread.
+ *
+ * arguments:
+ *  @th: pointer to the enumerator thread to modify.
+ */
+void enum_reduce_free (enum_thread_t *th) {
+  /* return if the thread has no state. */
+  if (!th->state)
+    return;
+
+  /* loop over the levels of the thread state. */
+  for (unsigned int lev = 0; lev < th->E->G->n_order; lev++) {
+    enum_thread_node_t *node = th->state + lev;
+    intervals_free(node->isa);
+    intervals_free(node->isb);
+    intervals_free(node->isk);
+    free(node->omega);
+    node->omega = NULL;
+    node->cw = node->sw = NULL;
+  }
+}
+
 /* enum_reduce(): at a given level within an enumerator thread, compute
  * a discretized set of omega dihedral angles using interval reduction,
  * described in the 'torsion Branch-and-Prune' paper.
  *
+ * the reduced set begins as the whole circle, or as the dihedral
+ * interval when the d(i,i-3) edge derives from a dihedral restraint,
+ * and is intersected with the arcs allowed by every friend vertex.
+ * the final set is discretized into at most as many dihedrals as the
+ * level has branches, and their count is stored in the node.
+ *
  * arguments:
  *  @th: enumerator thread structure pointer.
  *  @lev: level in the order at which to compute the omega values.
- *  @l0: initial lower bound for the reduced interval set.
- *  @u0: initial upper bound for the reduced interval set.
  *
  * returns:
  *  integer indicating whether (1) or not (0) dihedral interval reduction
  *  yielded a feasible (i.e. non-empty) set of intervals.
  */
-int enum_reduce (enum_thread_t *th, unsigned int lev,
-                 double l0, double u0) {
+int enum_reduce (enum_thread_t *th, unsigned int lev) {
   /* get some required struct pointers:
    *  @E: master enumerator.
    *  @G: distance graph.
@@ -289,17 +475,21 @@ int enum_reduce (enum_thread_t *th, unsigned int lev,
   /* declare variables for friends:
    *  @xk: position of the friend vertex.
    *  @d0k: distance to the friend vertex.
+   *  @lk, @uk: tolerance-widened bounds of the distance.
    */
   vector_t xk;
   value_t d0k;
+  double lk, uk;
 
   /* get some more required variables:
    *  @n_omega: number of discretization points.
    *  @isa, @isb, @isk: temporary interval sets.
    */
-  const unsigned int n_omega = state[lev].nb;
-  intervals_t *isa, *isb, *isk;
-  isk = state[lev].isk;
+  unsigned int n_omega = state[lev].nb;
+  intervals_t *isa = state[lev].isa;
+  intervals_t *isb = state[lev].isb;
+  intervals_t *isk = state[lev].isk;
+  intervals_t *swp;
 
   /* get some required uint arrays:
    *  @order: graph repetition order array.
@@ -316,33 +506,59 @@ int enum_reduce (enum_thread_t *th, unsigned int lev,
    *  @v: graph vertex index at the current level in the order.
    *  @d01: distance to the once-removed vertex.
    *  @d02: distance to the twice-removed vertex.
+   *  @d03: distance or dihedral to the thrice-removed vertex.
    */
   const unsigned int v = order[lev];
   const double d01 = graph_get_edge(G, v, order[lev - 1]).l;
   const double d02 = graph_get_edge(G, v, order[lev - 2]).l;
+  value_t d03 = graph_get_edge(G, v, order[lev - 3]);
+
+  /* initialize the interval set to the entire circle, or to the
+   * dihedral interval if one is available.
+   */
+  isa->size = 0;
+  isb->size = 0;
+  if (value_is_dihedral(d03)) {
+    d03 = value_bound(value_scal(*d03.src, M_PI / 180.0),
+                      value_interval(-M_PI, M_PI));
+    intervals_union(isa, d03.l, d03.u);
+  }
+  else
+    intervals_union(isa, -M_PI, M_PI);
 
-  /* initialize the interval set to the entire circle. */
-  state[lev].isa->size = 0;
-  state[lev].isb->size = 0;
-  intervals_union(state[lev].isa, l0, u0);
+  /* assume the reduced interval set will be empty. */
+  state[lev].n_omega = 0;
 
   /* loop over all friend vertices:
    * F(i) := { v(k) | k <= i-3 ^ !dup[k] ^ v(k) != v(i-1) ^ v(k) != v(i-2) }
    */
   for (unsigned int k = 0; k < n_friends; k++) {
-    /* alternate between the two interval sets for intersections. */
-    isa = k % 2 ? state[lev].isb : state[lev].isa;
-    isb = k % 2 ? state[lev].isa : state[lev].isb;
-
     /* get the vertex index and position of the current friend. */
     const unsigned int vk = friends[k];
     xk = state[ordrev[vk]].pos;
 
-    /* get the graph edge connecting us to the current friend. */
+    /* get the graph edge connecting us to the current friend. dihedral
+     * edges have already been applied to the initial interval set.
+     */
     d0k = graph_get_edge(G, v, vk);
+    if (value_is_dihedral(d0k))
+      continue;
+
+    /* widen the bounds by half the tolerance used by ddf pruning, which
+     * keeps the dihedrals sampled at the ends of the arcs clear of the
+     * pruning bounds, and clamp them to the distances attainable on the
+     * circle.
+     */
+    lk = d0k.l - 0.5 * E->ddf_tol;
+    uk = d0k.u + 0.5 * E->ddf_tol;
+    const int valid = reduce_bounds(&x1, &x2, &xk, d01, d02, &lk, &uk);
+    if (valid < 0)
+      continue;
+    else if (!valid)
+      return 0;
 
     /* solve for the two interval arcs related to the current friend. */
-    if (!solve_iomega_k(&x1, &x2, &x3, &xk, d01, d02, d0k.l, d0k.u, isk))
+    if (!solve_iomega_k(&x1, &x2, &x3, &xk, d01, d02, lk, uk, isk))
       return 0;
 
     /* intersect these interval arcs with the current interval set. */
@@ -351,12 +567,21 @@ int enum_reduce (enum_thread_t *th, unsigned int lev,
     /* the interval set is empty! return false. */
     if (isb->size == 0)
       return 0;
+
+    /* swap the interval sets, leaving the intersection in @isa. */
+    swp = isa;
+    isa = isb;
+    isb = swp;
   }
 
   /* finally, discretize the reduced interval set. */
-  intervals_grid(isb, state[lev].omega, n_omega);
+  intervals_grid(isa, state[lev].omega, &n_omega);
+  state[lev].n_omega = n_omega;
 
-  /* feasible intervals are available, return true. */
-  return 1;
-}
+  /* tabulate the cosines and sines for all siblings. */
+  for (unsigned int i = 0; i < n_omega; i++)
+    sincos(state[lev].omega[i], state[lev].sw + i, state[lev].cw + i);
 
+  /* return whether feasible dihedrals are available. */
+  return (n_omega > 0);
+}
@@ -4,6 +4,9 @@
 
 /* function declarations (enum-reduce.c): */
 
-int enum_reduce (enum_thread_t *th, unsigned int lev,
-                 double l0, double u0);
+int enum_reduce_init (enum_t *E);
+
+void enum_reduce_free (enum_thread_t *th);
+
+int enum_reduce (enum_thread_t *th, unsigned int lev);
 
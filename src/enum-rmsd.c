@@ -0,0 +1,517 @@
+
+/* include the enumerator headers. */
+#include "enum.h"
+#include "enum-rmsd.h"
+
+/* the rmsd diversity index holds every solution accepted under a nonzero
+ * rmsd tolerance, so that each new candidate is compared against all of
+ * them rather than only the previous solution of the same thread.
+ *
+ * candidates are compared using a cascade of lower bounds on the rmsd
+ * after optimal superposition. for centered structures a and b of n atoms,
+ * and any rotation R:
+ *
+ *   sum_i (|a_i| - |b_i|)^2 <= sum_i |R a_i - b_i|^2
+ *
+ * so the radial profile (i.e. the distance of each atom from the center)
+ * gives a rotation-free lower bound on the rmsd. summing the profile over
+ * ENUM_RMSD_GROUPS contiguous groups of atoms further yields a short key
+ * vector whose euclidean distance (scaled by 1/sqrt(n)) is also a lower
+ * bound. the keys are hashed into a uniform grid having the rmsd tolerance
+ * as its spacing, so that only the neighbouring cells of a candidate can
+ * hold solutions within the tolerance of it.
+ *
+ * only the solutions that pass both bounds are compared by a full rmsd
+ * calculation.
+ */
+
+/* enum_rmsd_hash(): compute the hash table bucket of a grid cell.
+ *
+ * arguments:
+ *  @c: array of grid cell indices.
+ *
+ * returns:
+ *  bucket index of the grid cell.
+ */
+static inline unsigned int enum_rmsd_hash (const long *c) {
+  /* combine the cell indices using large primes. */
+  const unsigned long h = ((unsigned long) c[0] * 73856093UL) ^
+                          ((unsigned long) c[1] * 19349663UL) ^
+                          ((unsigned long) c[2] * 83492791UL);
+
+  /* return the bucket index. */
+  return (unsigned int) (h & (ENUM_RMSD_BUCKETS - 1));
+}
+
+/* enum_rmsd_cell(): compute the grid cell of a key vector.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @key: array of key vector elements.
+ *  @c: output array of grid cell indices.
+ */
+static inline void enum_rmsd_cell (enum_t *E, const double *key, long *c) {
+  /* divide each key element by the grid spacing. */
+  for (unsigned int j = 0; j < ENUM_RMSD_GROUPS; j++)
+    c[j] = (long) floor(key[j] / E->rmsd_grid);
+}
+
+/* enum_rmsd_sqdev(): compute the sum of squared deviations between two
+ * centered structures after optimal superposition.
+ *
+ * this function utilizes the quaternion characteristic polynomial method,
+ * referenced here:
+ *
+ *  D. L. Theobald, "Rapid calculation of RMSD using a quaternion-based
+ *  characteristic polynomial." Acta Crysta. A, 2005, 61(4): 478-480.
+ *
+ * arguments:
+ *  @a: array of positions of the first structure.
+ *  @b: array of packed coordinates of the second structure.
+ *  @n: number of atoms in each structure.
+ *
+ * returns:
+ *  sum of squared deviations, i.e. n times the squared rmsd.
+ */
+static double enum_rmsd_sqdev (const vector_t *a, const float *b,
+                               const unsigned int n) {
+  /* declare required variables:
+   */
+  double Sxx, Sxy, Sxz, Syx, Syy, Syz, Szx, Szy, Szz, G1, G2;
+  double x1, x2, y1, y2, z1, z2;
+  unsigned int i;
+
+  /* initialize the inner product matrix. */
+  Sxx = Sxy = Sxz = 0.0;
+  Syx = Syy = Syz = 0.0;
+  Szx = Szy = Szz = 0.0;
+
+  /* loop to compute the inner product matrix. */
+  for (i = 0, G1 = 0.0, G2 = 0.0; i < n; i++) {
+    /* get the first coordinate. */
+    x1 = b[3 * i];
+    y1 = b[3 * i + 1];
+    z1 = b[3 * i + 2];
+
+    /* get the second coordinate. */
+    x2 = a[i].x;
+    y2 = a[i].y;
+    z2 = a[i].z;
+
+    /* compute the inner product terms. */
+    G1 += x1 * x1 + y1 * y1 + z1 * z1;
+    G2 += x2 * x2 + y2 * y2 + z2 * z2;
+
+    /* update the first-row matrix elements. */
+    Sxx += x1 * x2;
+    Sxy += x1 * y2;
+    Sxz += x1 * z2;
+
+    /* update the second-row matrix elements. */
+    Syx += y1 * x2;
+    Syy += y1 * y2;
+    Syz += y1 * z2;
+
+    /* update the third-row matrix elements. */
+    Szx += z1 * x2;
+    Szy += z1 * y2;
+    Szz += z1 * z2;
+  }
+
+  /* compute the final inner product. */
+  const double E0 = (G1 + G2) * 0.5;
+  double E = E0;
+
+  /* compute squared matrix elements (diagonal). */
+  const double Sxx2 = Sxx * Sxx;
+  const double Syy2 = Syy * Syy;
+  const double Szz2 = Szz * Szz;
+
+  /* compute squared matrix elements (off-diagonals). */
+  const double Sxy2 = Sxy * Sxy;
+  const double Syz2 = Syz * Syz;
+  const double Sxz2 = Sxz * Sxz;
+
+  /* compute squared matrix elements (off-diagonals). */
+  const double Syx2 = Syx * Syx;
+  const double Szy2 = Szy * Szy;
+  const double Szx2 = Szx * Szx;
+
+  /* compute some temporaries... */
+  const double SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
+  const double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+
+  /* ... and another temporary. */
+  const double C2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 +
+                            Sxz2 + Szx2 + Syz2 + Szy2);
+
+  /* ... and yet another temporary. */
+  const double C1 = 8.0 * (Sxx*Syz*Szy + Syy*Szx*Sxz + Szz*Sxy*Syx -
+                           Sxx*Syy*Szz - Syz*Szx*Sxy - Szy*Syx*Sxz);
+
+  /* ... and even more temporaries. */
+  const double SxzpSzx = Sxz + Szx;
+  const double SyzpSzy = Syz + Szy;
+  const double SxypSyx = Sxy + Syx;
+  const double SyzmSzy = Syz - Szy;
+  const double SxzmSzx = Sxz - Szx;
+  const double SxymSyx = Sxy - Syx;
+  const double SxxpSyy = Sxx + Syy;
+  const double SxxmSyy = Sxx - Syy;
+  const double Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+  /* ... and one final temporary. */
+  const double C0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2 +
+    (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) *
+    (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2) +
+    (-SxzpSzx*SyzmSzy + SxymSyx*(SxxmSyy-Szz)) *
+    (-SxzmSzx*SyzpSzy + SxymSyx*(SxxmSyy+Szz)) +
+    (-SxzpSzx*SyzpSzy - SxypSyx*(SxxpSyy-Szz)) *
+    (-SxzmSzx*SyzmSzy - SxypSyx*(SxxpSyy+Szz)) +
+    (+SxypSyx*SyzpSzy + SxzpSzx*(SxxmSyy+Szz)) *
+    (-SxymSyx*SyzmSzy + SxzpSzx*(SxxpSyy+Szz)) +
+    (+SxypSyx*SyzmSzy + SxzmSzx*(SxxmSyy-Szz)) *
+    (-SxymSyx*SyzpSzy + SxzmSzx*(SxxpSyy-Szz));
+
+  /* newton-rhapson. */
+  for (i = 0; i < 50; i++) {
+    double Eprev = E;
+    x2 = E * E;
+    const double b = (x2 + C2) * E;
+    const double a = b + C1;
+    const double delta = (a * E + C0) / (2.0 * x2 * E + b + a);
+    E -= delta;
+
+    /* break on convergence. */
+    if (fabs(E - Eprev) < fabs(1.0e-11 * E))
+      break;
+  }
+
+  /* compute and return the sum of squared deviations. */
+  return 2.0 * (E0 - E);
+}
+
+/* enum_rmsd_init(): allocate the rmsd diversity index of an enumerator,
+ * along with the candidate arrays of each of its threads. the index is
+ * only allocated when a nonzero rmsd tolerance was requested.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_rmsd_init (enum_t *E) {
+  /* get the number of atoms in each solution. */
+  const unsigned int n = E->G->n_orig;
+
+  /* free any index from a previous enumeration. */
+  enum_rmsd_free(E);
+
+  /* return if no rmsd tolerance was requested. */
+  if (E->rmsd_tol <= 0.0)
+    return 1;
+
+  /* compute the grid spacing, which is the rmsd tolerance. */
+  E->rmsd_grid = sqrt(E->rmsd_tol / (double) n);
+
+  /* allocate the bucket heads of the hash table. */
+  E->rmsd_head = (unsigned int*)
+    malloc(ENUM_RMSD_BUCKETS * sizeof(unsigned int));
+  if (!E->rmsd_head)
+    throw("unable to allocate rmsd index buckets");
+
+  /* initialize the buckets as empty. */
+  for (unsigned int b = 0; b < ENUM_RMSD_BUCKETS; b++)
+    E->rmsd_head[b] = UINT_MAX;
+
+  /* allocate the candidate arrays of each thread. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    enum_thread_t *th = E->threads + t;
+    th->rmsd_pos = (vector_t*) malloc(n * sizeof(vector_t));
+    th->rmsd_prof = (double*)
+      malloc((n + ENUM_RMSD_GROUPS) * sizeof(double));
+
+    if (!th->rmsd_pos || !th->rmsd_prof)
+      throw("unable to allocate rmsd candidate of thread %u", t + 1);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_rmsd_free(): free the rmsd diversity index of an enumerator,
+ * and the candidate arrays of its threads.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ */
+void enum_rmsd_free (enum_t *E) {
+  /* free the stored solutions and the hash table. */
+  free(E->rmsd_head);
+  free(E->rmsd_next);
+  free(E->rmsd_key);
+  free(E->rmsd_prof);
+  free(E->rmsd_pos);
+
+  /* reset the index. */
+  E->rmsd_head = E->rmsd_next = NULL;
+  E->rmsd_key = NULL;
+  E->rmsd_prof = NULL;
+  E->rmsd_pos = NULL;
+  E->rmsd_n = E->rmsd_cap = 0;
+  E->rmsd_lookups = E->rmsd_compared = 0;
+
+  /* free the candidate arrays of each thread. */
+  for (unsigned int t = 0; E->threads && t < E->nthreads; t++) {
+    free(E->threads[t].rmsd_pos);
+    free(E->threads[t].rmsd_prof);
+    E->threads[t].rmsd_pos = NULL;
+    E->threads[t].rmsd_prof = NULL;
+  }
+}
+
+/* enum_rmsd_search(): search the rmsd diversity index for a stored
+ * solution within the rmsd tolerance of the candidate solution held
+ * by a thread. the caller must hold the index lock.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the candidate.
+ *  @first: index of the first stored solution to compare against.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) a stored solution lies
+ *  within the rmsd tolerance of the candidate.
+ */
+static int enum_rmsd_search (enum_thread_t *th, const unsigned int first) {
+  /* get references to the enumerator and the candidate arrays. */
+  enum_t *E = th->E;
+  const unsigned int n = E->G->n_orig;
+  const double *prof = th->rmsd_prof;
+  const double *key = prof + n;
+  const double tol = E->rmsd_tol;
+  const double tol2 = E->rmsd_grid * E->rmsd_grid;
+
+  /* declare variables for visiting the neighbouring cells:
+   *  @c0: grid cell of the candidate.
+   *  @c: grid cell being visited.
+   *  @seen: buckets already visited.
+   */
+  long c0[ENUM_RMSD_GROUPS], c[ENUM_RMSD_GROUPS];
+  unsigned int seen[27], nseen = 0;
+
+  /* loop over the cells neighbouring the candidate. */
+  enum_rmsd_cell(E, key, c0);
+  for (unsigned int m = 0; m < 27; m++) {
+    /* compute the cell indices and the bucket. */
+    c[0] = c0[0] + (long) (m % 3) - 1;
+    c[1] = c0[1] + (long) (m / 3 % 3) - 1;
+    c[2] = c0[2] + (long) (m / 9) - 1;
+    const unsigned int b = enum_rmsd_hash(c);
+
+    /* skip buckets that were already visited. */
+    unsigned int k;
+    for (k = 0; k < nseen && seen[k] != b; k++);
+    if (k < nseen)
+      continue;
+
+    seen[nseen++] = b;
+
+    /* loop over the solutions stored in the bucket. */
+    for (unsigned int s = E->rmsd_head[b]; s != UINT_MAX;
+         s = E->rmsd_next[s]) {
+      /* the bucket lists are ordered from newest to oldest. */
+      if (s < first)
+        break;
+
+      /* check the lower bound from the key vectors. */
+      const double *skey = E->rmsd_key + (unsigned long) s * ENUM_RMSD_GROUPS;
+      double d = 0.0;
+      for (unsigned int j = 0; j < ENUM_RMSD_GROUPS; j++)
+        d += (key[j] - skey[j]) * (key[j] - skey[j]);
+
+      if (d >= tol2)
+        continue;
+
+      /* check the lower bound from the radial profiles. */
+      const float *sprof = E->rmsd_prof + (unsigned long) s * n;
+      d = 0.0;
+      for (unsigned int i = 0; i < n && d < tol; i++)
+        d += (prof[i] - sprof[i]) * (prof[i] - sprof[i]);
+
+      if (d >= tol)
+        continue;
+
+      /* compute the full rmsd. */
+      __atomic_add_fetch(&E->rmsd_compared, 1, __ATOMIC_RELAXED);
+      const float *spos = E->rmsd_pos + (unsigned long) s * 3 * n;
+      if (enum_rmsd_sqdev(th->rmsd_pos, spos, n) < tol)
+        return 1;
+    }
+  }
+
+  /* no stored solution is within the tolerance. */
+  return 0;
+}
+
+/* enum_rmsd_novel(): check whether the centered solution held by a
+ * thread lies outside the rmsd tolerance of every solution stored in
+ * the rmsd diversity index.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the solution.
+ *  @nseen: pointer to the output number of stored solutions that were
+ *          compared against, for use by enum_rmsd_insert().
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the solution is novel.
+ */
+int enum_rmsd_novel (enum_thread_t *th, unsigned int *nseen) {
+  /* get references to the enumerator and the graph. */
+  enum_t *E = th->E;
+  graph_t *G = E->G;
+  const unsigned int n = G->n_orig;
+
+  /* get references to the candidate arrays. */
+  vector_t *pos = th->rmsd_pos;
+  double *prof = th->rmsd_prof;
+  double *key = prof + n;
+
+  /* pack the positions and compute the radial profile. */
+  for (unsigned int i = 0, j = 0; i < G->n_order; i++) {
+    if (G->orig[i])
+      continue;
+
+    pos[j] = th->state[i].pos;
+    prof[j] = sqrt(pos[j].x * pos[j].x +
+                   pos[j].y * pos[j].y +
+                   pos[j].z * pos[j].z);
+    j++;
+  }
+
+  /* sum the profile over contiguous groups of atoms into the key. */
+  for (unsigned int j = 0; j < ENUM_RMSD_GROUPS; j++) {
+    const unsigned int i0 = n * j / ENUM_RMSD_GROUPS;
+    const unsigned int i1 = n * (j + 1) / ENUM_RMSD_GROUPS;
+
+    key[j] = 0.0;
+    for (unsigned int i = i0; i < i1; i++)
+      key[j] += prof[i] * prof[i];
+
+    key[j] = sqrt(key[j] / (double) n);
+  }
+
+  /* count the lookup. */
+  __atomic_add_fetch(&E->rmsd_lookups, 1, __ATOMIC_RELAXED);
+
+  /* search the index while other threads may search it as well. */
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_rwlock_rdlock(&E->rmsd_lock);
+#endif
+  *nseen = E->rmsd_n;
+  const int found = enum_rmsd_search(th, 0);
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_rwlock_unlock(&E->rmsd_lock);
+#endif
+
+  /* return whether the solution is novel. */
+  return !found;
+}
+
+/* enum_rmsd_insert(): store the novel solution held by a thread into
+ * the rmsd diversity index, unless a solution within the tolerance of
+ * it was stored by another thread since it was checked by
+ * enum_rmsd_novel().
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the solution.
+ *  @nseen: number of stored solutions that were already compared.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the solution was stored.
+ */
+int enum_rmsd_insert (enum_thread_t *th, unsigned int nseen) {
+  /* get references to the enumerator and the candidate arrays. */
+  enum_t *E = th->E;
+  const unsigned int n = E->G->n_orig;
+  const double *prof = th->rmsd_prof;
+  const double *key = prof + n;
+  int ret = 0;
+
+  /* obtain exclusive access to the index. */
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_rwlock_wrlock(&E->rmsd_lock);
+#endif
+
+  /* compare against the solutions stored since the last check. */
+  if (E->rmsd_n > nseen && enum_rmsd_search(th, nseen))
+    goto final;
+
+  /* grow the stored solution arrays if they are full. */
+  if (E->rmsd_n == E->rmsd_cap) {
+    /* compute the new capacity. */
+    const unsigned int cap = (E->rmsd_cap ? 2 * E->rmsd_cap : 1024);
+
+    /* reallocate the arrays. */
+    unsigned int *next = (unsigned int*)
+      realloc(E->rmsd_next, cap * sizeof(unsigned int));
+    if (next) E->rmsd_next = next;
+
+    double *skey = (double*)
+      realloc(E->rmsd_key, (unsigned long) cap * ENUM_RMSD_GROUPS *
+                           sizeof(double));
+    if (skey) E->rmsd_key = skey;
+
+    float *sprof = (float*)
+      realloc(E->rmsd_prof, (unsigned long) cap * n * sizeof(float));
+    if (sprof) E->rmsd_prof = sprof;
+
+    float *spos = (float*)
+      realloc(E->rmsd_pos, (unsigned long) cap * 3 * n * sizeof(float));
+    if (spos) E->rmsd_pos = spos;
+
+    /* check that reallocation succeeded. */
+    if (!next || !skey || !sprof || !spos) {
+      /* accept the solution without storing it. */
+      warn("unable to grow rmsd index beyond %u solutions", E->rmsd_cap);
+      ret = 1;
+      goto final;
+    }
+
+    /* store the new capacity. */
+    E->rmsd_cap = cap;
+  }
+
+  /* store the key vector, radial profile and coordinates. */
+  const unsigned int s = E->rmsd_n;
+  float *sprof = E->rmsd_prof + (unsigned long) s * n;
+  float *spos = E->rmsd_pos + (unsigned long) s * 3 * n;
+  for (unsigned int j = 0; j < ENUM_RMSD_GROUPS; j++)
+    E->rmsd_key[(unsigned long) s * ENUM_RMSD_GROUPS + j] = key[j];
+
+  for (unsigned int i = 0; i < n; i++) {
+    sprof[i] = prof[i];
+    spos[3 * i] = th->rmsd_pos[i].x;
+    spos[3 * i + 1] = th->rmsd_pos[i].y;
+    spos[3 * i + 2] = th->rmsd_pos[i].z;
+  }
+
+  /* link the solution at the head of its bucket. */
+  long c[ENUM_RMSD_GROUPS];
+  enum_rmsd_cell(E, key, c);
+  const unsigned int b = enum_rmsd_hash(c);
+  E->rmsd_next[s] = E->rmsd_head[b];
+  E->rmsd_head[b] = s;
+  E->rmsd_n++;
+  ret = 1;
+
+final:
+  /* release the index. */
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_rwlock_unlock(&E->rmsd_lock);
+#endif
+
+  /* return whether the solution was stored. */
+  return ret;
+}
+
@@ -0,0 +1,14 @@
+
+/* ensure once-only inclusion. */
+#pragma once
+
+/* function declarations (enum-rmsd.c): */
+
+int enum_rmsd_init (enum_t *E);
+
+void enum_rmsd_free (enum_t *E);
+
+int enum_rmsd_novel (enum_thread_t *th, unsigned int *nseen);
+
+int enum_rmsd_insert (enum_thread_t *th, unsigned int nseen);
+
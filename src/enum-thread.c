@@ -3,85 +3,15 @@
 #include "enum.h"
 #include "enum-thread.h"
 #include "enum-write.h"
-
-/* state_div(): divide the size of a thread state into uniform pieces,
- * storing the result into the index of the thread state.
- *
- * arguments:
- *  @state: thread state to operate on.
- *  @len: number of elements in the state.
- *  @n: value to divide the state size by.
- */
-static void state_div (enum_thread_node_t *state,
-                       unsigned int len,
-                       unsigned int n) {
-  /* @bN: base-2 log of the tree size/leaf count.
-   * @bn: base-2 log of the division value.
-   * @bs: base-2 log of the quotient.
-   * @i: general-purpose loop counter.
-   */
-  double bN, bn, bs;
-  unsigned int i;
-
-  /* compute the tree size. */
-  for (i = 0, bN = 0.0; i < len; i++)
-    bN += log2((double) state[i].nb);
-
-  /* compute the quotient. */
-  bn = bN - log2((double) n);
-
-  /* loop to compute the division result. */
-  for (i = len - 1, bs = 0.0; i < len; i--) {
-    /* sum the current node size into the "stride". */
-    bs += log2((double) state[i].nb);
-
-    /* check if the "stride" is sufficiently large. */
-    if (bs == bn) {
-      /* equal: amounts to one step of the parent node index. */
-      state[i - 1].end = 1;
-      break;
-    }
-    else if (bs > bn) {
-      /* larger: compute the closest integer step amount based
-       * on the required amount of bits in the quotient.
-       */
-      bs -= log2((double) state[i].nb);
-      state[i].end = 1 << (unsigned int) floor(bn - bs);
-      break;
-    }
-  }
-}
-
-/* state_add(): add the indices of two states, storing the result into
- * the index of the destination (first) state.
- *
- * arguments:
- *  @dest: destination state in the sum.
- *  @src1: source state in the sum.
- *  @len: number of elements in each state.
- */
-static void state_add (enum_thread_node_t *dest,
-                       enum_thread_node_t *src,
-                       unsigned int len) {
-  /* initialize the output values. */
-  for (unsigned int i = 0; i < len; i++)
-    dest[i].end = 0;
-
-  /* loop over each index of the result. */
-  for (unsigned int i = len - 1; i < len; i--) {
-    /* compute the current term of the sum. */
-    dest[i].end += dest[i].idx + src[i].end;
-
-    /* perform any required carries. */
-    while (i && dest[i].nb && dest[i].end >= dest[i].nb) {
-      dest[i].end -= dest[i].nb;
-      dest[i - 1].end++;
-    }
-  }
-}
+#include "enum-reduce.h"
+#include "enum-rmsd.h"
+#include "enum-nogood.h"
+#include "enum-checkpoint.h"
+#include "enum-prune.h"
 
 /* state_valid(): check whether a state is "valid", meaning that its index
- * has not yet reached its end.
+ * has not yet passed its end. the indices and ends of a state are read
+ * as mixed-radix numbers, so the comparison is lexicographic.
  *
  * arguments:
  *  @state: state to check for validity.
@@ -92,13 +22,13 @@ static void state_add (enum_thread_node_t *dest,
  */
 static inline int state_valid (enum_thread_node_t *state,
                                unsigned int len) {
-  /* if any one index has passed the end value, return false. */
+  /* compare the index and the end at the first level where they differ. */
   for (unsigned int i = 0; i < len; i++) {
-    if (state[i].idx > state[i].end)
-      return 0;
+    if (state[i].idx != state[i].end)
+      return (state[i].idx < state[i].end);
   }
 
-  /* return true. */
+  /* the index equals the end: return true. */
   return 1;
 }
 
@@ -141,6 +71,27 @@ static inline unsigned int state_increment (enum_thread_node_t *state,
   return imod;
 }
 
+/* state_stale(): mark the quantities that a node shares with its siblings,
+ * i.e. the local frame and the reduced dihedrals, as belonging to a
+ * previous parent.
+ *
+ * arguments:
+ *  @node: pointer to the node whose parent has changed.
+ */
+static inline void state_stale (enum_thread_node_t *node) {
+  /* invalidate the reduced dihedrals and the local frame. */
+  node->n_omega = ENUM_REDUCE_STALE;
+  node->framed = 0;
+  node->batched = 0;
+
+  /* no failures have been seen under the new parent. normal descents
+   * start from the first sibling, so a later one marks a path that
+   * begins partway through a range, whose earlier siblings were never
+   * visited and from which nothing may be learned.
+   */
+  node->conf = (node->idx ? 0 : UINT_MAX);
+}
+
 /* state_widths(): compute the number of leaf nodes in the implicit
  * tree that are to the left and right of the tree path defined by
  * the current state.
@@ -176,147 +127,68 @@ static inline void state_widths (enum_thread_node_t *state,
   *wr = (double) log10l(R);
 }
 
-/* state_rmsd(): determine the rmsd-step of a given state.
- *
- * this function utilizes the quaternion characteristic polynomial method,
- * referenced here:
- *
- *  D. L. Theobald, "Rapid calculation of RMSD using a quaternion-based
- *  characteristic polynomial." Acta Crysta. A, 2005, 61(4): 478-480.
+/* enum_thread_state_new(): allocate a thread state array, aligned to
+ * and padded out to a whole number of memory pages.
  *
  * arguments:
- *  @G: graph data structure representing the problem.
- *  @state: state from which to compute the rmsd.
+ *  @n: number of nodes in the state array.
  *
  * returns:
- *  root-mean-square deviation (rmsd) from the previous solution to
- *  the current solution.
+ *  pointer to the newly allocated state array, or NULL on failure.
  */
-static inline double state_rmsd (graph_t *G, enum_thread_node_t *state) {
+enum_thread_node_t *enum_thread_state_new (const unsigned int n) {
   /* declare required variables:
+   *  @page: size of a memory page, in bytes.
+   *  @bytes: number of bytes to allocate.
+   *  @ptr: pointer to the allocated memory.
    */
-  double Sxx, Sxy, Sxz, Syx, Syy, Syz, Szx, Szy, Szz, G1, G2;
-  double x1, x2, y1, y2, z1, z2;
-  unsigned int i;
+  const long page = sysconf(_SC_PAGESIZE);
+  const unsigned long align = (page > 0 ? page : ENUM_CACHE_LINE);
+  unsigned long bytes = n * sizeof(enum_thread_node_t);
+  void *ptr;
 
-  /* gain access to the duplicate array. */
-  const unsigned int len = G->n_order;
-  const unsigned int *dup = G->orig;
+  /* round the size up to the next page boundary. */
+  bytes = (bytes + align - 1) / align * align;
 
-  /* initialize the inner product matrix. */
-  Sxx = Sxy = Sxz = 0.0;
-  Syx = Syy = Syz = 0.0;
-  Szx = Szy = Szz = 0.0;
-
-  /* loop to compute the inner product matrix. */
-  for (i = 0, G1 = 0.0, G2 = 0.0; i < len; i++) {
-    /* skip repeated vertices in the order. */
-    if (dup[i]) continue;
-
-    /* get the first coordinate. */
-    x1 = state[i].prev.x;
-    y1 = state[i].prev.y;
-    z1 = state[i].prev.z;
-
-    /* get the second coordinate. */
-    x2 = state[i].pos.x;
-    y2 = state[i].pos.y;
-    z2 = state[i].pos.z;
-
-    /* compute the inner product terms. */
-    G1 += x1 * x1 + y1 * y1 + z1 * z1;
-    G2 += x2 * x2 + y2 * y2 + z2 * z2;
-
-    /* update the first-row matrix elements. */
-    Sxx += x1 * x2;
-    Sxy += x1 * y2;
-    Sxz += x1 * z2;
-
-    /* update the second-row matrix elements. */
-    Syx += y1 * x2;
-    Syy += y1 * y2;
-    Syz += y1 * z2;
-
-    /* update the third-row matrix elements. */
-    Szx += z1 * x2;
-    Szy += z1 * y2;
-    Szz += z1 * z2;
-  }
-
-  /* compute the final inner product. */
-  const double E0 = (G1 + G2) * 0.5;
-  double E = E0;
-
-  /* compute squared matrix elements (diagonal). */
-  const double Sxx2 = Sxx * Sxx;
-  const double Syy2 = Syy * Syy;
-  const double Szz2 = Szz * Szz;
-
-  /* compute squared matrix elements (off-diagonals). */
-  const double Sxy2 = Sxy * Sxy;
-  const double Syz2 = Syz * Syz;
-  const double Sxz2 = Sxz * Sxz;
-
-  /* compute squared matrix elements (off-diagonals). */
-  const double Syx2 = Syx * Syx;
-  const double Szy2 = Szy * Szy;
-  const double Szx2 = Szx * Szx;
-
-  /* compute some temporaries... */
-  const double SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
-  const double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
-
-  /* ... and another temporary. */
-  const double C2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 +
-                            Sxz2 + Szx2 + Syz2 + Szy2);
-
-  /* ... and yet another temporary. */
-  const double C1 = 8.0 * (Sxx*Syz*Szy + Syy*Szx*Sxz + Szz*Sxy*Syx -
-                           Sxx*Syy*Szz - Syz*Szx*Sxy - Szy*Syx*Sxz);
-
-  /* ... and even more temporaries. */
-  const double SxzpSzx = Sxz + Szx;
-  const double SyzpSzy = Syz + Szy;
-  const double SxypSyx = Sxy + Syx;
-  const double SyzmSzy = Syz - Szy;
-  const double SxzmSzx = Sxz - Szx;
-  const double SxymSyx = Sxy - Syx;
-  const double SxxpSyy = Sxx + Syy;
-  const double SxxmSyy = Sxx - Syy;
-  const double Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
-
-  /* ... and one final temporary. */
-  const double C0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2 +
-    (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) *
-    (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2) +
-    (-SxzpSzx*SyzmSzy + SxymSyx*(SxxmSyy-Szz)) *
-    (-SxzmSzx*SyzpSzy + SxymSyx*(SxxmSyy+Szz)) +
-    (-SxzpSzx*SyzpSzy - SxypSyx*(SxxpSyy-Szz)) *
-    (-SxzmSzx*SyzmSzy - SxypSyx*(SxxpSyy+Szz)) +
-    (+SxypSyx*SyzpSzy + SxzpSzx*(SxxmSyy+Szz)) *
-    (-SxymSyx*SyzmSzy + SxzpSzx*(SxxpSyy+Szz)) +
-    (+SxypSyx*SyzmSzy + SxzmSzx*(SxxmSyy-Szz)) *
-    (-SxymSyx*SyzpSzy + SxzmSzx*(SxxpSyy-Szz));
-
-  /* newton-rhapson. */
-  for (i = 0; i < 50; i++) {
-    double Eprev = E;
-    x2 = E * E;
-    const double b = (x2 + C2) * E;
-    const double a = b + C1;
-    const double delta = (a * E + C0) / (2.0 * x2 * E + b + a);
-    E -= delta;
-
-    /* break on convergence. */
-    if (fabs(E - Eprev) < fabs(1.0e-11 * E))
-      break;
-  }
+  /* allocate the state array. */
+  if (posix_memalign(&ptr, align, bytes))
+    return NULL;
 
-  /* compute and return the rmsd. */
-  return 2.0 * (E0 - E);
+  /* return the new state array. */
+  return (enum_thread_node_t*) ptr;
 }
 
-/* enum_threads_init(): initialize a set of threads prior to use.
+/* enum_thread_stats_new(): allocate an array of statistics counters,
+ * aligned to and padded out to a whole number of cache lines.
+ *
+ * arguments:
+ *  @n: number of counters in the array.
+ *
+ * returns:
+ *  pointer to the newly allocated counter array, or NULL on failure.
+ */
+static unsigned long *enum_thread_stats_new (const unsigned int n) {
+  /* round the size up to the next cache line boundary. */
+  unsigned long bytes = (n ? n : 1) * sizeof(unsigned long);
+  bytes = (bytes + ENUM_CACHE_LINE - 1) / ENUM_CACHE_LINE * ENUM_CACHE_LINE;
+
+  /* allocate the counter array. */
+  void *ptr;
+  if (posix_memalign(&ptr, ENUM_CACHE_LINE, bytes))
+    return NULL;
+
+  /* return the new counter array. */
+  return (unsigned long*) ptr;
+}
+
+/* enum_threads_slice(): compute the first and last leaves of the slice
+ * of the tree that is to be enumerated, as mixed-radix state indices.
+ *
+ * the branch indices of the tree prefix fix the shallowest levels that
+ * have more than one branch. the leaves below the prefix are then cut
+ * into contiguous partitions at the shallowest level where there are at
+ * least as many sub-trees as partitions, so that every partition of a
+ * given tree is identical in every process that enumerates it.
  *
  * arguments:
  *  @E: pointer to the enumerator structure to modify.
@@ -324,148 +196,278 @@ static inline double state_rmsd (graph_t *G, enum_thread_node_t *state) {
  * returns:
  *  integer indicating whether (1) or not (0) the operation succeeded.
  */
-int enum_threads_init (enum_t *E) {
-  /* compute the branch counts at each level. */
-  for (unsigned int i = 0; i < E->G->n_order; i++) {
-    /* check the special case of single or duplicate nodes. */
-    if (i < 3 || E->G->orig[i]) {
-      E->threads[0].state[i].nb = 1;
+static int enum_threads_slice (enum_t *E) {
+  /* get references to the branch counts and the slice bounds. */
+  const enum_thread_node_t *state = E->threads[0].state;
+  const unsigned int len = E->G->n_order;
+  unsigned int *lo = E->slice_lo;
+  unsigned int *hi = E->slice_hi;
+  unsigned int i, j, L;
+
+  /* begin with the entire tree. */
+  for (i = 0; i < len; i++) {
+    lo[i] = 0;
+    hi[i] = state[i].nb - 1;
+  }
+
+  /* fix the branching levels covered by the prefix. */
+  for (i = 0, j = 0; i < len && j < E->n_prefix; i++) {
+    /* skip levels that do not branch. */
+    if (state[i].nb < 2)
       continue;
-    }
 
-    /* get the d(i,i-3) edge weight. */
-    const unsigned int i0 = E->G->order[i - 3];
-    const unsigned int i3 = E->G->order[i];
-    value_t d03 = graph_get_edge(E->G, i0, i3);
+    /* check that the branch index is in bounds. */
+    if (E->prefix[j] >= state[i].nb)
+      throw("prefix index %u out of bounds [0,%u] at level %u",
+            E->prefix[j], state[i].nb - 1, i);
 
-    /* set the branch count based on d(i,i-3) edge type. */
-    if (value_is_scalar(d03)) {
-      /* scalar edges produce two branches. */
-      E->threads[0].state[i].nb = 2;
-    }
-    else if (value_is_interval(d03)) {
-      /* interval edges produce multiple branches. */
-      unsigned int nb = (d03.u - d03.l) / E->eps;
-      if (nb > E->nbmax)
-        nb = E->nbmax;
-      else if (nb == 0)
-        nb = 1;
+    /* fix the level to the branch index. */
+    lo[i] = hi[i] = E->prefix[j++];
+  }
 
-      /* set the branch count. */
-      E->threads[0].state[i].nb = 2 * nb;
-    }
+  /* check that the whole prefix was used. */
+  if (j < E->n_prefix)
+    throw("prefix of %u indices exceeds the %u branching levels",
+          E->n_prefix, j);
 
-    /* refine the branch count in the case of dihedral edges. */
-    if (value_is_dihedral(d03)) {
-      /* dihedrals do not require sigma={+1,-1}, only sigma=+1. */
-      E->threads[0].state[i].nb /= 2;
-    }
+  /* compute the size of the slice below the prefix. */
+  E->logS = 0.0;
+  for (L = i; L < len; L++)
+    E->logS += log10((double) state[L].nb);
+
+  /* return if the tree is not partitioned. */
+  if (E->part_n < 2)
+    return 1;
+
+  /* find the shallowest level below the prefix that holds at least
+   * as many sub-trees as there are partitions.
+   */
+  unsigned long M = 1;
+  for (L = i; L < len; L++) {
+    M *= state[L].nb;
+    if (M >= E->part_n)
+      break;
   }
 
-  /* store the branch counts into every thread. */
-  for (unsigned int t = 1; t < E->nthreads; t++)
-    for (unsigned int i = 0; i < E->G->n_order; i++)
-      E->threads[t].state[i].nb = E->threads[0].state[i].nb;
+  /* check that every partition will be non-empty. */
+  if (L >= len)
+    throw("unable to divide %lu leaves into %u partitions", M, E->part_n);
+
+  /* compute the first and last sub-trees of the partition. */
+  const unsigned long N = E->part_n;
+  const unsigned long k = E->part_k - 1;
+  unsigned long a = M / N * k + M % N * k / N;
+  unsigned long b = M / N * (k + 1) + M % N * (k + 1) / N - 1;
+
+  /* update the slice size. */
+  E->logS += log10((double) (b - a + 1)) - log10((double) M);
+
+  /* write the sub-tree indices as mixed-radix state indices. */
+  for (j = L; j >= i && j < len; j--) {
+    lo[j] = a % state[j].nb;
+    hi[j] = b % state[j].nb;
+    a /= state[j].nb;
+    b /= state[j].nb;
+  }
 
-  /* check if more than one thread will be executed. */
-  if (E->nthreads > 1) {
-    /* determine the division of labor. */
-    state_div(E->threads[0].state, E->G->n_order, E->nthreads);
+  /* return success. */
+  return 1;
+}
 
-    /* set up the threads based on the computed division. */
-    for (unsigned int t = 1; t < E->nthreads; t++) {
-      /* compute the state start. */
-      for (unsigned int i = 0; i < E->G->n_order; i++)
-        E->threads[t].state[i].idx = E->threads[t - 1].state[i].end;
+/* enum_thread_in_slice(): check whether the sub-tree rooted at a node
+ * in the tree overlaps the slice of the tree to be enumerated.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ *  @state: state holding the path to the node.
+ *  @lev: level of the node in the tree.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the sub-tree lies at least
+ *  partly within the slice.
+ */
+static inline int enum_thread_in_slice (enum_t *E,
+                                        const enum_thread_node_t *state,
+                                        const unsigned int lev) {
+  /* compare the path with the first leaf of the slice. */
+  for (unsigned int i = 0; i <= lev; i++) {
+    if (state[i].idx != E->slice_lo[i]) {
+      if (state[i].idx < E->slice_lo[i])
+        return 0;
 
-      /* compute the state end. */
-      state_add(E->threads[t].state,
-                E->threads[0].state,
-                E->G->n_order);
+      break;
     }
+  }
 
-    /* set the end state. */
-    for (unsigned int t = 1; t < E->nthreads; t++)
-      for (unsigned int i = 0; i < E->G->n_order; i++)
-        E->threads[t - 1].state[i].end = E->threads[t].state[i].idx;
+  /* compare the path with the last leaf of the slice. */
+  for (unsigned int i = 0; i <= lev; i++) {
+    if (state[i].idx != E->slice_hi[i])
+      return (state[i].idx < E->slice_hi[i]);
   }
 
-  /* set the end state to the problem size. */
-  for (unsigned int i = 0; i < E->G->n_order; i++) {
-    E->threads[E->nthreads - 1].state[i].end =
-    E->threads[E->nthreads - 1].state[i].nb - 1;
+  /* the path lies within the slice. */
+  return 1;
+}
+
+/* enum_threads_symmetry(): locate the symmetry levels of the tree, at
+ * which the set of solutions is closed under a partial reflection of all
+ * atoms embedded at or below the level, through the plane of the three
+ * atoms that precede it. a level is a symmetry level when every edge
+ * that crosses it (i.e. joins an atom above it to an atom at or below
+ * it) starts at one of the three atoms in the plane, and when no deeper
+ * level embeds from a dihedral that differs from its mirror image.
+ *
+ * symmetry levels only branch on sigma=+1, which halves their branch
+ * counts, and the sigma=-1 halves are recovered by reflecting every
+ * solution found in the remaining tree.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_threads_symmetry (enum_t *E) {
+  /* get references to the graph and the branch counts. */
+  graph_t *G = E->G;
+  enum_thread_node_t *state = E->threads[0].state;
+  const unsigned int len = G->n_order;
+
+  /* reset the symmetry levels. */
+  for (unsigned int i = 0; i < len; i++)
+    state[i].sym = 0;
+
+  free(E->sym_lev);
+  E->sym_lev = NULL;
+  E->n_sym = 0;
+
+  /* return if no symmetry was requested. */
+  if (!E->symmetry)
+    return 1;
+
+  /* mirror images of solutions are not feasible if any pruning method
+   * distinguishes them.
+   */
+  if (E->chiral) {
+    warn("symmetry is unavailable with chirality-dependent pruning");
+    return 1;
   }
 
-  /* set the start state to the initial index. */
-  for (unsigned int t = 0; t < E->nthreads; t++)
-    for (unsigned int i = 0; i < E->G->n_order; i++)
-      E->threads[t].state[i].start = E->threads[t].state[i].idx;
+  /* reduced intervals spread the samples of a level over the whole
+   * circle, so halving them does not keep only one of its mirror images.
+   */
+  if (E->reduce) {
+    warn("symmetry is unavailable with interval reduction");
+    return 1;
+  }
 
-  /* initialize the energies. */
-  for (unsigned int t = 0; t < E->nthreads; t++)
-    for (unsigned int i = 0; i < E->G->n_order; i++)
-      E->threads[t].state[i].energy = 0.0;
+  /* allocate the symmetry level array and the crossing counts. */
+  E->sym_lev = (unsigned int*) malloc(len * sizeof(unsigned int));
+  long *cross = (long*) calloc(len + 1, sizeof(long));
+  if (!E->sym_lev || !cross) {
+    free(cross);
+    throw("unable to allocate symmetry arrays");
+  }
 
-  /* compute the tree size. */
-  for (unsigned int i = 0; i < E->G->n_order; i++) {
-    if (i >= 3)  {
-       /* get the d(i,i-3) edge weight. */
-       const unsigned int i0 = E->G->order[i - 3];
-       const unsigned int i1 = E->G->order[i - 2];
-       const unsigned int i2 = E->G->order[i - 1];
-       const unsigned int i3 = E->G->order[i];
+  /* count the edges that cross each level: an edge between the first
+   * occurrences a < b crosses the levels (a,b].
+   */
+  for (unsigned int u = 0; u < G->nv; u++) {
+    for (unsigned int w = u + 1; w < G->nv; w++) {
+      /* get the first occurrences of the edge vertices. */
+      unsigned int a = G->ordrev[u];
+      unsigned int b = G->ordrev[w];
+      if (a >= len || b >= len || !graph_has_edge(G, u, w))
+        continue;
+
+      /* mark the crossed range of levels. */
+      cross[a < b ? a + 1 : b + 1]++;
+      cross[a < b ? b + 1 : a + 1]--;
+    }
+  }
 
-       /* get the residue indices. */
-       unsigned int r0 = E->P->atoms[i0].res_id;
-       unsigned int r1 = E->P->atoms[i1].res_id;
-       unsigned int r2 = E->P->atoms[i2].res_id;
-       unsigned int r3 = E->P->atoms[i3].res_id;
-       info("r0:%d, r1:%d, r2:%d, r3:%d", r0 + 1, r1 + 1, r2 + 1, r3 + 1);
+  /* accumulate the crossing counts. */
+  for (unsigned int i = 1; i <= len; i++)
+    cross[i] += cross[i - 1];
 
-       /* get the atom names. */
-       const char *atom0 = E->P->atoms[i0].name;
-       const char *atom1 = E->P->atoms[i1].name;
-       const char *atom2 = E->P->atoms[i2].name;
-       const char *atom3 = E->P->atoms[i3].name;
-       info("atom0:%s, atom1:%s, atom2:%s, atom3:%s", atom0, atom1, atom2, atom3);
+  /* loop over the levels in reverse, tracking whether any deeper level
+   * embeds from a dihedral that its mirror image would violate.
+   */
+  int chiral = 0;
+  for (unsigned int lev = len; lev-- > 3;) {
+    /* skip duplicate levels. */
+    if (G->orig[lev])
+      continue;
 
-       value_t d03 = graph_get_edge(E->G, i0, i3);
-       info("edge (i,i-3) i-3: %d.%s, i-2: %d.%s, i-1: %d.%s, i: %d.%s, d03.u: %f, d03.l: %f, E->threads[0].state[i].nb: %d",r0 + 1, atom0, r1 + 1, atom1, r2 + 1, atom2, r3 + 1, atom3, d03.u, d03.l, E->threads[0].state[i].nb);
+    /* get the d(i,i-3) edge of the level. */
+    value_t d03 = graph_get_edge(G, G->order[lev - 3], G->order[lev]);
+    if (value_is_dihedral(d03)) {
+      /* mirror images negate the dihedral, which only remains within
+       * the discretized interval if the interval is centered on zero.
+       */
+      d03 = value_bound(value_scal(*d03.src, M_PI / 180.0),
+                        value_interval(-M_PI, M_PI));
+      if (fabs(d03.l + d03.u) > 1.0e-9)
+        chiral = 1;
+
+      /* dihedral levels do not branch on sigma. */
+      continue;
+    }
+
+    /* symmetry levels must branch on sigma above any chiral level. */
+    if (chiral || state[lev].nb < 2)
+      continue;
+
+    /* subtract the crossing edges that start in the plane. */
+    long n = cross[lev];
+    for (unsigned int j = 1; j <= 3; j++) {
+      /* skip plane vertices that were already counted. */
+      const unsigned int p = G->order[lev - j];
+      if ((j > 1 && p == G->order[lev - 1]) ||
+          (j > 2 && p == G->order[lev - 2]))
+        continue;
+
+      /* count the edges from the plane vertex to deeper vertices. */
+      for (unsigned int w = 0; w < G->nv; w++) {
+        if (G->ordrev[w] >= lev && G->ordrev[w] < len &&
+            graph_has_edge(G, p, w))
+          n--;
       }
-    E->logW += log10((double) E->threads[0].state[i].nb);
+    }
+
+    /* store the level if no other edge crosses it. */
+    if (n == 0)
+      state[lev].sym = 1;
   }
 
-  /* output an informational message about the tree size. */
-  info("dense tree size: 10^%.3lf leaves", E->logW);
+  /* store the symmetry levels in increasing order, halving their
+   * branch counts.
+   */
+  for (unsigned int lev = 3; lev < len; lev++) {
+    if (!state[lev].sym)
+      continue;
 
-  /* return success. */
-  return 1;
-}
+    /* do not exceed the maximum number of mirror images. */
+    if (E->n_sym == ENUM_SYMMETRY_MAX) {
+      warn("using only the first %u symmetry levels", ENUM_SYMMETRY_MAX);
+      for (; lev < len; lev++)
+        state[lev].sym = 0;
 
-/* enum_thread_feasible(): determine whether an enumeration tree node
- * is feasible or not.
- *
- * arguments:
- *  @th: pointer to the thread to feasibility-check.
- *
- * returns:
- *  integer indicating whether (1) or not (0) the atom is feasible.
- */
-static inline int enum_thread_feasible (enum_thread_t *th) {
-  /* get local references to the pruning data. */
-  enum_t *E = th->E;
-  void **data = E->prune_data[th->level];
-  enum_prune_test_fn *func = E->prune[th->level];
-  const unsigned int n = E->prune_sz[th->level];
-
-  /* loop over the array of pruning function pointers. */
-  for (unsigned int i = 0; i < n; i++) {
-    /* return infeasible if any function returns a prune. */
-    if ((func[i])(E, th, data[i]))
-      return 0;
+      break;
+    }
+
+    /* store the level. */
+    E->sym_lev[E->n_sym++] = lev;
+    state[lev].nb /= 2;
   }
 
-  /* return feasible. */
+  /* free the crossing counts. */
+  free(cross);
+
+  /* output an informational message about the symmetry levels. */
+  info("partial reflection symmetry at %u levels", E->n_sym);
+
+  /* return success. */
   return 1;
 }
 
@@ -528,73 +530,2273 @@ static inline void enum_thread_lerp_index (const unsigned int i,
   *lerp = (N > 1 ? ((double) idx) / ((double) (N - 1)) : 0.5);
 }
 
-/* enum_thread_timer(): timer thread function for enumeration timing
- * information.
+/* enum_threads_plan(): compute the embedding plan of every level of
+ * the tree, which holds the distances, angle and branch schedule that
+ * every thread needs to embed the atom at the level. the branch counts
+ * and symmetry levels must already be known.
  *
  * arguments:
- *  @pdata: pointer to the enumerator data structure.
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
  */
-void *enum_thread_timer (void *pdata) {
-  /* get a reference to the current enumerator. */
-  enum_t *E = (enum_t*) pdata;
-
-  /* get references to commonly used sizes. */
-  const unsigned int nt = E->nthreads;
-  const unsigned int len = E->G->n_order;
+static int enum_threads_plan (enum_t *E) {
+  /* get references to the graph and the node states. */
+  graph_t *G = E->G;
+  const enum_thread_node_t *state = E->threads[0].state;
+  const unsigned int len = G->n_order;
+  const unsigned int *order = G->order;
+
+  /* allocate the array of plans. */
+  E->plan = (enum_plan_t*) calloc(len, sizeof(enum_plan_t));
+  if (!E->plan)
+    throw("unable to allocate embedding plans");
+
+  /* count the branches in the schedules of all embedded levels. */
+  unsigned long nw = 0;
+  for (unsigned int lev = 3; lev < len; lev++) {
+    if (!G->orig[lev])
+      nw += state[lev].nb;
+  }
 
-  /* initialize the timer. */
-  unsigned int last_nsol = 0;
-  double t = 0.0, dt = 1.0;
+  /* allocate the shared storage for the schedules. */
+  E->plan_w = (double*) malloc((4 * nw + 1) * sizeof(double));
+  if (!E->plan_w)
+    throw("unable to allocate embedding plan schedules");
 
-  /* loop until the master thread cancels us. */
-  while (1) {
-    /* sleep for the required duration. */
-    sleep((unsigned int) (dt * 60.0));
-    t += dt;
+  /* loop over the embedded levels of the tree. */
+  double *w = E->plan_w;
+  for (unsigned int lev = 3; lev < len; lev++) {
+    /* skip duplicate atoms, which are never embedded. */
+    if (G->orig[lev])
+      continue;
 
-    /* start outputting timing information. */
-    info("elapsed time: %.0lf min.", t);
+    /* get the edges to the atom to be embedded. */
+    enum_plan_t *plan = E->plan + lev;
+    value_t d03 = graph_get_edge(G, order[lev - 3], order[lev]);
+    const double d12 = graph_get_edge_exact(G, order[lev - 2],
+                                            order[lev - 1]);
+
+    /* store the exact distances and the angle at the nearest atom. */
+    plan->d13 = graph_get_edge_exact(G, order[lev - 2], order[lev]);
+    plan->d23 = graph_get_edge_exact(G, order[lev - 1], order[lev]);
+    plan->ct = distances_to_angle(d12, plan->d13, plan->d23);
+    plan->st = sqrt(1.0 - plan->ct * plan->ct);
+
+    /* convert dihedrals into radians within [-pi,pi]. */
+    plan->dihed = value_is_dihedral(d03);
+    if (plan->dihed)
+      d03 = value_bound(value_scal(*d03.src, M_PI / 180.0),
+                        value_interval(-M_PI, M_PI));
+
+    /* assign the schedule storage of the level. */
+    plan->nb = state[lev].nb;
+    plan->w = w;
+    plan->sig = w + plan->nb;
+    plan->cw = w + 2 * plan->nb;
+    plan->sw = w + 3 * plan->nb;
+    w += 4 * plan->nb;
+
+    /* compute the edge value and sign of each branch. symmetry levels
+     * only hold the even, sigma=+1 indices of distances and angles.
+     */
+    const unsigned int k = state[lev].sym;
+    for (unsigned int i = 0; i < plan->nb; i++) {
+      double lerp;
+      enum_thread_lerp_index(i << k, plan->nb << k, plan->dihed,
+                             plan->sig + i, &lerp);
 
-    /* compute the log-width of each thread. */
-    for (unsigned int tid = 0; tid < nt; tid++) {
-      /* compute the thread width. */
-      double L1 = 0.0;
-      double L2 = 0.0;
-      state_widths(E->threads[tid].state, len, &L1, &L2);
+      plan->w[i] = d03.l + (d03.u - d03.l) * lerp;
 
-      /* write the current thread information. */
-      /* fprintf(stderr, "   #%-3u: ~10^%.3lf min. remaining\n",
-              tid + 1, L2 - L1 + log10(t)); */
-      fprintf(stderr, "   #%-3u: ~10^%.3lf min. remaining, done: ~10^%.3lf, todo:~10^%.3lf\n",
-              tid + 1, L2 - L1 + log10(t),L1,L2);
+      /* tabulate the cosines and sines of planned dihedrals. */
+      if (plan->dihed)
+        sincos(plan->w[i], plan->sw + i, plan->cw + i);
     }
-
-    /* if the number of solutions has not increased since our
-     * last timing report, increase the delay time, up to a maximum
-     * of two hours between reports. when a solution is logged, set
-     * the delay time back to the minimum.
-     */
-    if (E->nsol <= last_nsol)
-      dt = (dt * 5.0 > 120.0 ? 120.0 : dt * 5.0);
-    else
-      dt = 1.0;
-
-    /* store the new solution count. */
-    last_nsol = E->nsol;
   }
 
-  /* end thread execution. */
-  return NULL;
+  /* return success. */
+  return 1;
 }
 
-/* enum_thread_execute(): core thread function for enumerator threads.
+/* enum_threads_batch_init(): allocate the sibling batches of every
+ * thread, at each level of the tree that embeds more than one sibling.
  *
  * arguments:
- *  @pdata: pointer to the current enumerator thread data structure.
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
  */
-void *enum_thread_execute (void *pdata) {
+static int enum_threads_batch_init (enum_t *E) {
+  /* get references to the graph and the branch counts. */
+  const graph_t *G = E->G;
+  const enum_thread_node_t *state = E->threads[0].state;
+
+  /* count the siblings at every batched level. */
+  unsigned long nw = 0;
+  for (unsigned int lev = 3; lev < G->n_order; lev++) {
+    if (!G->orig[lev] && state[lev].nb > 1)
+      nw += state[lev].nb;
+  }
+
+  /* loop over the threads. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    /* allocate the positions and flags of all batches at once. */
+    enum_thread_t *th = E->threads + t;
+    free(th->batch);
+    th->batch = (double*) malloc(3 * nw * sizeof(double) + nw + 1);
+    if (!th->batch)
+      throw("unable to allocate sibling batches of thread %u", t + 1);
+
+    /* assign the storage of each batched level. */
+    double *w = th->batch;
+    unsigned char *alive = (unsigned char*) (th->batch + 3 * nw);
+    for (unsigned int lev = 3; lev < G->n_order; lev++) {
+      /* skip levels that are not batched. */
+      enum_thread_node_t *node = th->state + lev;
+      if (G->orig[lev] || node->nb < 2)
+        continue;
+
+      /* point the node into the storage. */
+      node->bx = w;
+      node->by = w + node->nb;
+      node->bz = w + 2 * node->nb;
+      node->alive = alive;
+      node->batched = 0;
+      w += 3 * node->nb;
+      alive += node->nb;
+    }
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_thread_kind_size(): get the number of tests of a given kind held
+ * by a prune kernel.
+ *
+ * arguments:
+ *  @K: pointer to the prune kernel to access.
+ *  @kind: kind of tests to count.
+ *
+ * returns:
+ *  number of tests of the requested kind.
+ */
+static unsigned int enum_thread_kind_size (const enum_kernel_t *K,
+                                           const unsigned int kind) {
+  /* return the size of the array of the requested kind. */
+  switch (kind) {
+    case ENUM_KERNEL_PAIR:  return K->n_pair;
+    case ENUM_KERNEL_UPPER: return K->n_upper;
+    case ENUM_KERNEL_QUAD:  return K->n_quad;
+    case ENUM_KERNEL_TERM:  return K->n_term;
+    case ENUM_KERNEL_FUNC:  return K->n_func;
+    default: break;
+  }
+
+  /* unknown kinds hold no tests. */
+  return 0;
+}
+
+/* enum_threads_adapt_init(): allocate the adaptive pruning states of
+ * every thread, with the kinds of tests of each level in their default
+ * order.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_threads_adapt_init (enum_t *E) {
+  /* loop over the threads. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    /* allocate and zero the states of every level. */
+    enum_thread_t *th = E->threads + t;
+    free(th->adapt);
+    th->adapt = (enum_adapt_t*) calloc(E->G->n_order, sizeof(enum_adapt_t));
+    if (!th->adapt)
+      throw("unable to allocate adaptive pruning of thread %u", t + 1);
+
+    /* list the non-empty kinds of tests of each level. */
+    for (unsigned int lev = 0; lev < E->G->n_order; lev++) {
+      enum_adapt_t *A = th->adapt + lev;
+      for (unsigned int kind = 0; kind < ENUM_KERNEL_KINDS; kind++) {
+        if (enum_thread_kind_size(E->kern + lev, kind))
+          A->order[A->n_order++] = kind;
+      }
+    }
+
+    /* no tests are deferred initially. */
+    th->n_deferred = 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_threads_backjump_init(): allocate the dead sibling flags of every
+ * thread.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_threads_backjump_init (enum_t *E) {
+  /* get references to the graph and the branch counts. */
+  const graph_t *G = E->G;
+  const enum_thread_node_t *state = E->threads[0].state;
+
+  /* count the siblings at every learning level. */
+  unsigned long nw = 0;
+  for (unsigned int lev = 3; lev < G->n_order; lev++) {
+    if (!G->orig[lev])
+      nw += state[lev].nb;
+  }
+
+  /* loop over the threads. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    /* allocate and clear the flags of all levels at once. */
+    enum_thread_t *th = E->threads + t;
+    free(th->dead);
+    th->dead = (unsigned char*) calloc(nw + 1, 1);
+    if (!th->dead)
+      throw("unable to allocate dead siblings of thread %u", t + 1);
+
+    /* assign the flags of each learning level. */
+    unsigned char *dead = th->dead;
+    for (unsigned int lev = 3; lev < G->n_order; lev++) {
+      enum_thread_node_t *node = th->state + lev;
+      if (G->orig[lev])
+        continue;
+
+      node->dead = dead;
+      dead += node->nb;
+    }
+
+    /* reset the counters. */
+    th->learned = th->skipped = 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_threads_init(): initialize a set of threads prior to use.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_threads_init (enum_t *E) {
+  /* compute the branch counts at each level. */
+  for (unsigned int i = 0; i < E->G->n_order; i++) {
+    /* check the special case of single or duplicate nodes. */
+    if (i < 3 || E->G->orig[i]) {
+      E->threads[0].state[i].nb = 1;
+      continue;
+    }
+
+    /* get the d(i,i-3) edge weight. */
+    const unsigned int i0 = E->G->order[i - 3];
+    const unsigned int i3 = E->G->order[i];
+    value_t d03 = graph_get_edge(E->G, i0, i3);
+
+    /* set the branch count based on d(i,i-3) edge type. */
+    if (value_is_scalar(d03)) {
+      /* scalar edges produce two branches. */
+      E->threads[0].state[i].nb = 2;
+    }
+    else if (value_is_interval(d03)) {
+      /* interval edges produce multiple branches. */
+      unsigned int nb = (d03.u - d03.l) / E->eps;
+      if (nb > E->nbmax)
+        nb = E->nbmax;
+      else if (nb == 0)
+        nb = 1;
+
+      /* set the branch count. */
+      E->threads[0].state[i].nb = 2 * nb;
+    }
+
+    /* refine the branch count in the case of dihedral edges. */
+    if (value_is_dihedral(d03)) {
+      /* dihedrals do not require sigma={+1,-1}, only sigma=+1. */
+      E->threads[0].state[i].nb /= 2;
+    }
+  }
+
+  /* locate the symmetry levels of the tree. */
+  if (!enum_threads_symmetry(E))
+    throw("unable to locate symmetry levels");
+
+  /* compute the embedding plans of every level. */
+  if (!enum_threads_plan(E))
+    throw("unable to compute embedding plans");
+
+  /* store the branch counts into every thread. */
+  for (unsigned int t = 1; t < E->nthreads; t++) {
+    for (unsigned int i = 0; i < E->G->n_order; i++) {
+      E->threads[t].state[i].nb = E->threads[0].state[i].nb;
+      E->threads[t].state[i].sym = E->threads[0].state[i].sym;
+    }
+  }
+
+  /* allocate the rmsd diversity index, if requested. */
+  if (!enum_rmsd_init(E))
+    throw("unable to initialize rmsd diversity index");
+
+  /* allocate the reduced intervals of every thread, if requested. */
+  if (E->reduce && !enum_reduce_init(E))
+    throw("unable to initialize interval reduction");
+
+  /* allocate the clash grids of every thread, if requested. */
+  if (E->clash_rad && !enum_prune_clash_alloc(E))
+    throw("unable to initialize clash grids");
+
+  /* allocate the sibling batches of every thread, if requested. */
+  if (E->batch && !enum_threads_batch_init(E))
+    throw("unable to initialize sibling batches");
+
+  /* allocate the adaptive pruning states of every thread, if requested. */
+  if (E->adaptive && !enum_threads_adapt_init(E))
+    throw("unable to initialize adaptive pruning");
+
+  /* reduced intervals depend on every preceding atom, so the failures
+   * of their siblings cannot be localized.
+   */
+  if (E->reduce && (E->backjump || E->nogood)) {
+    warn("backjumping and nogoods are unavailable with reduced intervals");
+    E->backjump = E->nogood = 0;
+  }
+
+  /* allocate the dead sibling flags of every thread, if requested. */
+  if (E->backjump && !enum_threads_backjump_init(E))
+    throw("unable to initialize backjumping");
+
+  /* allocate the shared nogood table, if requested. */
+  if (E->nogood && !enum_nogood_init(E))
+    throw("unable to initialize nogood table");
+
+  /* start every thread at the first index of the tree. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    for (unsigned int i = 0; i < E->G->n_order; i++) {
+      E->threads[t].state[i].idx = 0;
+      E->threads[t].state[i].start = 0;
+      E->threads[t].state[i].end = 0;
+    }
+  }
+
+  /* compute the slice of the tree to be enumerated. */
+  if (!enum_threads_slice(E))
+    throw("unable to compute enumerator tree slice");
+
+  /* give the entire slice to the first thread. the remaining threads
+   * begin idle, and obtain work by splitting the ranges of busy threads.
+   */
+  for (unsigned int i = 0; i < E->G->n_order; i++) {
+    E->threads[0].state[i].idx = E->slice_lo[i];
+    E->threads[0].state[i].start = E->slice_lo[i];
+    E->threads[0].state[i].end = E->slice_hi[i];
+  }
+
+  /* initialize the scheduler state of each thread. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    E->threads[t].id = t;
+    E->threads[t].req = E->threads[t].victim = -1;
+    E->threads[t].working = E->threads[t].granted = (t == 0);
+    E->threads[t].nodes = 0;
+    E->threads[t].steals = 0;
+    E->threads[t].busy = 0.0;
+    E->threads[t].stall = 0.0;
+  }
+
+  /* allocate the pruning statistics counters of each thread. */
+  for (unsigned int t = 0; t < E->nthreads; t++) {
+    /* free any counters from a previous enumeration. */
+    free(E->threads[t].stats);
+
+    /* allocate and zero the counters. */
+    E->threads[t].stats = enum_thread_stats_new(E->nstats);
+    if (!E->threads[t].stats)
+      throw("unable to allocate statistics of thread %u", t + 1);
+
+    /* allocate the mirror image positions, if required. */
+    free(E->threads[t].mirror);
+    E->threads[t].mirror = NULL;
+    if (E->n_sym) {
+      E->threads[t].mirror = (vector_t*)
+        malloc(E->G->n_order * sizeof(vector_t));
+
+      if (!E->threads[t].mirror)
+        throw("unable to allocate mirror positions of thread %u", t + 1);
+    }
+
+    memset(E->threads[t].stats, 0, E->nstats * sizeof(unsigned long));
+  }
+
+  /* initialize the global scheduler state. */
+  E->nidle = E->nthreads - 1;
+  E->done = 0;
+
+  /* initialize the energies. */
+  for (unsigned int t = 0; t < E->nthreads; t++)
+    for (unsigned int i = 0; i < E->G->n_order; i++)
+      E->threads[t].state[i].energy = 0.0;
+
+  /* compute the tree size. */
+  for (unsigned int i = 0; i < E->G->n_order; i++) {
+    if (i >= 3)  {
+       /* get the d(i,i-3) edge weight. */
+       const unsigned int i0 = E->G->order[i - 3];
+       const unsigned int i1 = E->G->order[i - 2];
+       const unsigned int i2 = E->G->order[i - 1];
+       const unsigned int i3 = E->G->order[i];
+
+       /* get the residue indices. */
+       unsigned int r0 = E->P->atoms[i0].res_id;
+       unsigned int r1 = E->P->atoms[i1].res_id;
+       unsigned int r2 = E->P->atoms[i2].res_id;
+       unsigned int r3 = E->P->atoms[i3].res_id;
+       info("r0:%d, r1:%d, r2:%d, r3:%d", r0 + 1, r1 + 1, r2 + 1, r3 + 1);
+
+       /* get the atom names. */
+       const char *atom0 = E->P->atoms[i0].name;
+       const char *atom1 = E->P->atoms[i1].name;
+       const char *atom2 = E->P->atoms[i2].name;
+       const char *atom3 = E->P->atoms[i3].name;
+       info("atom0:%s, atom1:%s, atom2:%s, atom3:%s", atom0, atom1, atom2, atom3);
+
+       value_t d03 = graph_get_edge(E->G, i0, i3);
+       info("edge (i,i-3) i-3: %d.%s, i-2: %d.%s, i-1: %d.%s, i: %d.%s, d03.u: %f, d03.l: %f, E->threads[0].state[i].nb: %d",r0 + 1, atom0, r1 + 1, atom1, r2 + 1, atom2, r3 + 1, atom3, d03.u, d03.l, E->threads[0].state[i].nb);
+      }
+    E->logW += log10((double) E->threads[0].state[i].nb);
+  }
+
+  /* output an informational message about the tree size. */
+  info("dense tree size: 10^%.3lf leaves", E->logW);
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_thread_dist2(): compute the squared distance between two
+ * positions.
+ *
+ * arguments:
+ *  @a, @b: pointers to the two positions.
+ *
+ * returns:
+ *  squared euclidean distance between the positions.
+ */
+static inline double enum_thread_dist2 (const vector_t *a,
+                                        const vector_t *b) {
+  /* compute and return the squared distance. */
+  const double dx = a->x - b->x;
+  const double dy = a->y - b->y;
+  const double dz = a->z - b->z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+/* enum_thread_term_chunk(): sum a chunk of energy terms of a single
+ * type of a prune kernel. the terms are first computed into a small
+ * array without any branches, so that the loop over them vectorizes,
+ * and then summed.
+ *
+ * arguments:
+ *  @state: array of tree nodes holding the atom positions.
+ *  @T: pointer to the energy terms of the type.
+ *  @type: type of the energy terms.
+ *  @i0: index of the first term of the chunk.
+ *  @m: number of terms in the chunk, at most ENERGY_CHUNK.
+ *
+ * returns:
+ *  energy contribution of the chunk.
+ */
+static ENUM_TARGET_CLONES
+double enum_thread_term_chunk (const enum_thread_node_t *restrict state,
+                               const enum_kernel_term_t *restrict T,
+                               const unsigned int type,
+                               const unsigned int i0,
+                               const unsigned int m) {
+  /* get pretty handles to the term arrays of the chunk. */
+  const unsigned int *l0 = T->lev[0] + i0, *l1 = T->lev[1] + i0;
+  const unsigned int *l2 = T->lev[2] + i0, *l3 = T->lev[3] + i0;
+  const double *c0 = T->c[0] + i0, *c1 = T->c[1] + i0, *c2 = T->c[2] + i0;
+  double e[ENERGY_CHUNK];
+
+  /* compute the terms of the chunk. */
+  switch (type) {
+    /* close contacts. */
+    case ENERGY_CONTACT:
+      for (unsigned int k = 0; k < m; k++) {
+        const double r = c1[k] / enum_thread_dist2(&state[l0[k]].pos,
+                                                   &state[l1[k]].pos);
+        e[k] = c0[k] * r * r * r;
+      }
+      break;
+
+    /* bonded distances. */
+    case ENERGY_BOND:
+      for (unsigned int k = 0; k < m; k++) {
+        const double dd = sqrt(enum_thread_dist2(&state[l0[k]].pos,
+                                                 &state[l1[k]].pos)) - c1[k];
+        e[k] = c0[k] * dd * dd;
+      }
+      break;
+
+    /* non-bonded distances. */
+    case ENERGY_DISTANCE:
+      for (unsigned int k = 0; k < m; k++) {
+        const double lg = log(c1[k] * enum_thread_dist2(&state[l0[k]].pos,
+                                                        &state[l1[k]].pos));
+        e[k] = c0[k] * lg * lg;
+      }
+      break;
+
+    /* two-bond angles, from the cosine of the angle. */
+    case ENERGY_ANGLE:
+      for (unsigned int k = 0; k < m; k++) {
+        const vector_t *x0 = &state[l0[k]].pos;
+        const vector_t *x1 = &state[l1[k]].pos;
+        const vector_t *x2 = &state[l2[k]].pos;
+        const double ax = x0->x - x1->x, ay = x0->y - x1->y,
+                     az = x0->z - x1->z;
+        const double bx = x2->x - x1->x, by = x2->y - x1->y,
+                     bz = x2->z - x1->z;
+
+        const double a2 = ax * ax + ay * ay + az * az;
+        const double b2 = bx * bx + by * by + bz * bz;
+        const double c = (ax * bx + ay * by + az * bz) / sqrt(a2 * b2);
+        e[k] = c0[k] + c * (c1[k] + c * c2[k]);
+      }
+      break;
+
+    /* dihedral angles, from the cosine and sine of the angle. */
+    case ENERGY_DIHEDRAL:
+      for (unsigned int k = 0; k < m; k++) {
+        /* compute the three bond vectors. */
+        const vector_t *x0 = &state[l0[k]].pos;
+        const vector_t *x1 = &state[l1[k]].pos;
+        const vector_t *x2 = &state[l2[k]].pos;
+        const vector_t *x3 = &state[l3[k]].pos;
+        const double ax = x0->x - x1->x, ay = x0->y - x1->y,
+                     az = x0->z - x1->z;
+        const double bx = x1->x - x2->x, by = x1->y - x2->y,
+                     bz = x1->z - x2->z;
+        const double cx = x2->x - x3->x, cy = x2->y - x3->y,
+                     cz = x2->z - x3->z;
+
+        /* compute the normals of the two planes. */
+        const double n1x = ay * bz - az * by, n1y = az * bx - ax * bz,
+                     n1z = ax * by - ay * bx;
+        const double n2x = by * cz - bz * cy, n2y = bz * cx - bx * cz,
+                     n2z = bx * cy - by * cx;
+
+        /* compute the cosine and sine of the angle, up to a common
+         * positive factor, and normalize them.
+         */
+        const double mx = n1y * bz - n1z * by, my = n1z * bx - n1x * bz,
+                     mz = n1x * by - n1y * bx;
+        const double x = sqrt(bx * bx + by * by + bz * bz) *
+                         (n1x * n2x + n1y * n2y + n1z * n2z);
+        const double y = mx * n2x + my * n2y + mz * n2z;
+        const double r = sqrt(x * x + y * y);
+        const double cw = (r > 0.0 ? x / r : 1.0);
+        const double sw = (r > 0.0 ? y / r : 0.0);
+        e[k] = c0[k] + cw * c1[k] + sw * c2[k];
+      }
+      break;
+
+    /* otherwise, do nothing. */
+    default:
+      return 0.0;
+  }
+
+  /* sum and return the terms. */
+  double sum = 0.0;
+  for (unsigned int k = 0; k < m; k++)
+    sum += e[k];
+
+  return sum;
+}
+
+/* enum_thread_pairs(): run the two-sided distance tests of a prune
+ * kernel on the current node of a thread.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node passed the tests.
+ */
+static inline int enum_thread_pairs (enum_thread_t *th,
+                                     const enum_kernel_t *K) {
+  /* get the current position. */
+  const enum_thread_node_t *state = th->state;
+  const vector_t x = state[th->level].pos;
+
+  /* loop over the tests. */
+  for (unsigned int i = 0; i < K->n_pair; i++) {
+    const enum_kernel_pair_t *p = K->pair + i;
+    const double d2 = enum_thread_dist2(&state[p->lev].pos, &x);
+
+    enum_stat_inc(th, p->stat);
+    if (d2 < p->lo2 || d2 > p->hi2) {
+      enum_stat_inc(th, p->stat + 1);
+      th->culprit = p->conf;
+      return 0;
+    }
+  }
+
+  /* the node passed. */
+  return 1;
+}
+
+/* enum_thread_uppers(): run the upper bound distance tests of a prune
+ * kernel on the current node of a thread, computing each distance once
+ * for every run of tests against the same earlier atom.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node passed the tests.
+ */
+static inline int enum_thread_uppers (enum_thread_t *th,
+                                      const enum_kernel_t *K) {
+  /* get the current position. */
+  const enum_thread_node_t *state = th->state;
+  const vector_t x = state[th->level].pos;
+  unsigned int prev = th->level;
+  double d2 = 0.0;
+
+  /* loop over the tests. */
+  for (unsigned int i = 0; i < K->n_upper; i++) {
+    const enum_kernel_pair_t *p = K->upper + i;
+    if (p->lev != prev) {
+      d2 = enum_thread_dist2(&state[p->lev].pos, &x);
+      prev = p->lev;
+    }
+
+    enum_stat_inc(th, p->stat);
+    if (d2 > p->hi2) {
+      enum_stat_inc(th, p->stat + 1);
+      th->culprit = p->conf;
+      return 0;
+    }
+  }
+
+  /* the node passed. */
+  return 1;
+}
+
+/* enum_thread_quads(): run the dihedral angle tests of a prune kernel
+ * on the current node of a thread.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node passed the tests.
+ */
+static inline int enum_thread_quads (enum_thread_t *th,
+                                     const enum_kernel_t *K) {
+  /* get the node positions. */
+  enum_thread_node_t *state = th->state;
+
+  /* loop over the tests. */
+  for (unsigned int i = 0; i < K->n_quad; i++) {
+    const enum_kernel_quad_t *q = K->quad + i;
+    const double omega = vector_dihedral(&state[q->lev[0]].pos,
+                                         &state[q->lev[1]].pos,
+                                         &state[q->lev[2]].pos,
+                                         &state[q->lev[3]].pos);
+
+    /* check the angle against the bounds, shifted by one turn either
+     * way, and prune if none of them contain it.
+     */
+    enum_stat_inc(th, q->stat);
+    if (!(omega >= q->l - 2.0 * M_PI && omega <= q->u - 2.0 * M_PI) &&
+        !(omega >= q->l && omega <= q->u) &&
+        !(omega >= q->l + 2.0 * M_PI && omega <= q->u + 2.0 * M_PI)) {
+      enum_stat_inc(th, q->stat + 1);
+      th->culprit = q->conf;
+      return 0;
+    }
+  }
+
+  /* the node passed. */
+  return 1;
+}
+
+/* enum_thread_terms(): sum the energy terms of a prune kernel at the
+ * current node of a thread, one type and chunk at a time, checking the
+ * partial energy of the node and the least energy of the deeper levels
+ * after each chunk, and store the energy of the node.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node passed the tests.
+ */
+static inline int enum_thread_terms (enum_thread_t *th,
+                                     const enum_kernel_t *K) {
+  /* get the node energies. */
+  enum_thread_node_t *state = th->state;
+  const double E0 = state[th->level - 1].energy;
+
+  /* return if the level holds no terms, carrying over the energy of the
+   * parent, as no terms are added.
+   */
+  if (!K->n_term) {
+    state[th->level].energy = E0;
+    return 1;
+  }
+
+  double Enew = 0.0, tol;
+  int ret = 1;
+
+  /* compare against the tolerance, less the least energy below. */
+  __atomic_load(&th->E->energy_tol, &tol, __ATOMIC_RELAXED);
+  tol -= th->E->energy_lb[th->level];
+
+  /* loop over the term types. */
+  for (unsigned int type = 0; type < ENERGY_TYPES && ret; type++) {
+    const enum_kernel_term_t *T = K->term + type;
+    if (!T->n)
+      continue;
+
+    /* sum the terms of the type in chunks. */
+    enum_stat_inc(th, T->stat);
+    for (unsigned int i = 0; i < T->n; i += ENERGY_CHUNK) {
+      const unsigned int m = (T->n - i < ENERGY_CHUNK
+                               ? T->n - i : ENERGY_CHUNK);
+      Enew += enum_thread_term_chunk(state, T, type, i, m);
+
+      if (E0 + Enew > tol) {
+        /* the energy of the node sums terms from every level above. */
+        enum_stat_inc(th, T->stat + 1);
+        th->culprit = 0;
+        ret = 0;
+        break;
+      }
+    }
+  }
+
+  /* store the energy and return. */
+  state[th->level].energy = E0 + Enew;
+  return ret;
+}
+
+/* enum_thread_funcs(): call the closures that were not merged into the
+ * tests of a prune kernel on the current node of a thread.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node passed the tests.
+ */
+static inline int enum_thread_funcs (enum_thread_t *th,
+                                     const enum_kernel_t *K) {
+  /* return infeasible if any closure returns a prune. */
+  for (unsigned int i = 0; i < K->n_func; i++) {
+    if ((K->func[i])(th->E, th, K->data[i])) {
+      th->culprit = 0;
+      return 0;
+    }
+  }
+
+  /* the node passed. */
+  return 1;
+}
+
+/* enum_thread_kind(): run a single kind of tests of a prune kernel on
+ * the current node of a thread.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *  @kind: kind of tests to run.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node passed the tests.
+ */
+static inline int enum_thread_kind (enum_thread_t *th,
+                                    const enum_kernel_t *K,
+                                    const unsigned int kind) {
+  /* run the tests of the requested kind. */
+  switch (kind) {
+    case ENUM_KERNEL_PAIR:  return enum_thread_pairs(th, K);
+    case ENUM_KERNEL_UPPER: return enum_thread_uppers(th, K);
+    case ENUM_KERNEL_QUAD:  return enum_thread_quads(th, K);
+    case ENUM_KERNEL_TERM:  return enum_thread_terms(th, K);
+    case ENUM_KERNEL_FUNC:  return enum_thread_funcs(th, K);
+    default: break;
+  }
+
+  /* unknown kinds always pass. */
+  return 1;
+}
+
+/* enum_thread_adapt_rate(): compute the measured yield of a kind of
+ * tests at a single level, in prunes per nanosecond of testing.
+ *
+ * arguments:
+ *  @A: pointer to the adaptive pruning state of the level.
+ *  @kind: kind of tests to compute the yield of.
+ *
+ * returns:
+ *  yield of the kind, or zero if it has not been timed yet.
+ */
+static double enum_thread_adapt_rate (const enum_adapt_t *A,
+                                      const unsigned int kind) {
+  /* the yield is undefined until the kind has been run and timed. */
+  if (!A->runs[kind] || !A->samples[kind] || A->ns[kind] <= 0.0)
+    return 0.0;
+
+  /* divide the prune fraction by the mean duration of a run. */
+  const double p = (double) A->prunes[kind] / (double) A->runs[kind];
+  const double t = A->ns[kind] / (double) A->samples[kind];
+  return p / t;
+}
+
+/* enum_thread_adapt(): reorder the kinds of tests of a level by their
+ * measured yield, and defer the kinds that have never pruned to the
+ * leaves. energy terms and unmerged closures are never deferred, as
+ * the former store node energies, and the latter may hold state.
+ *
+ * arguments:
+ *  @th: pointer to the thread owning the adaptive pruning state.
+ *  @A: pointer to the adaptive pruning state of the level.
+ */
+static void enum_thread_adapt (enum_thread_t *th, enum_adapt_t *A) {
+  /* sort the kinds by decreasing yield. */
+  for (unsigned int i = 1; i < A->n_order; i++) {
+    const unsigned char kind = A->order[i];
+    const double rate = enum_thread_adapt_rate(A, kind);
+
+    unsigned int j = i;
+    for (; j > 0 && enum_thread_adapt_rate(A, A->order[j - 1]) < rate; j--)
+      A->order[j] = A->order[j - 1];
+
+    A->order[j] = kind;
+  }
+
+  /* defer the kinds that have never pruned after enough runs. */
+  for (unsigned int i = 0; i < A->n_order; i++) {
+    const unsigned int kind = A->order[i];
+    if (kind == ENUM_KERNEL_TERM || kind == ENUM_KERNEL_FUNC ||
+        (A->deferred & (1U << kind)) ||
+        A->runs[kind] < ENUM_ADAPT_WARMUP || A->prunes[kind])
+      continue;
+
+    A->deferred |= 1U << kind;
+    th->n_deferred++;
+  }
+}
+
+/* enum_thread_adaptive(): determine whether an enumeration tree node is
+ * feasible using adaptive pruning, which runs the kinds of tests of the
+ * prune kernel in the order of their measured yield, and skips deferred
+ * kinds.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *  @K: pointer to the prune kernel of the current level.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the atom is feasible.
+ */
+static int enum_thread_adaptive (enum_thread_t *th,
+                                 const enum_kernel_t *K) {
+  /* get the adaptive pruning state of the level. */
+  enum_adapt_t *A = th->adapt + th->level;
+  const unsigned int batched = th->state[th->level].batched;
+
+  /* time a sample of the checks, and periodically reorder the kinds. */
+  const int timed = !(A->calls & ENUM_ADAPT_SAMPLE);
+  if (++A->calls % ENUM_ADAPT_PERIOD == 0)
+    enum_thread_adapt(th, A);
+
+  /* loop over the kinds of tests in their current order. */
+  for (unsigned int i = 0; i < A->n_order; i++) {
+    /* skip deferred kinds, and tests already applied to the batch. */
+    const unsigned int kind = A->order[i];
+    if ((A->deferred & (1U << kind)) ||
+        (batched && kind == ENUM_KERNEL_PAIR))
+      continue;
+
+    /* run the kind, timing it if the check is sampled. */
+    const double t0 = (timed ? enum_thread_clock() : 0.0);
+    const int pass = enum_thread_kind(th, K, kind);
+    if (timed) {
+      A->ns[kind] += 1.0e9 * (enum_thread_clock() - t0);
+      A->samples[kind]++;
+    }
+
+    /* count the run, and return infeasible on a prune. */
+    A->runs[kind]++;
+    if (!pass) {
+      A->prunes[kind]++;
+      return 0;
+    }
+  }
+
+  /* return feasible. */
+  return 1;
+}
+
+/* enum_thread_validate(): run the tests that adaptive pruning deferred
+ * at each level of the complete embedding held by a thread. a kind of
+ * tests that prunes a level is no longer deferred at that level.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the leaf to validate.
+ *
+ * returns:
+ *  shallowest level at which the embedding is infeasible, or the length
+ *  of the order if the embedding passed every deferred test.
+ */
+static unsigned int enum_thread_validate (enum_thread_t *th) {
+  /* get the length of the order and the kernels. */
+  const unsigned int len = th->E->G->n_order;
+  const enum_kernel_t *kern = th->E->kern;
+  unsigned int lev, ret = len;
+
+  /* loop over the levels, from the shallowest. */
+  for (lev = 3; lev < len && ret == len; lev++) {
+    /* skip levels without deferred tests. */
+    enum_adapt_t *A = th->adapt + lev;
+    if (!A->deferred)
+      continue;
+
+    /* run each deferred kind at the level. */
+    th->level = lev;
+    for (unsigned int kind = 0; kind < ENUM_KERNEL_KINDS; kind++) {
+      if (!(A->deferred & (1U << kind)) ||
+          (th->state[lev].batched && kind == ENUM_KERNEL_PAIR))
+        continue;
+
+      /* restore the kind at the level if it prunes the embedding. */
+      A->runs[kind]++;
+      if (!enum_thread_kind(th, kern + lev, kind)) {
+        A->prunes[kind]++;
+        A->deferred &= ~(1U << kind);
+        th->n_deferred--;
+        ret = lev;
+        break;
+      }
+    }
+  }
+
+  /* restore the level of the leaf and return. */
+  th->level = len - 1;
+  return ret;
+}
+
+/* enum_thread_feasible(): determine whether an enumeration tree node
+ * is feasible or not, by running the prune kernel of its level. the
+ * tests are run by kind: distance tests first, as they are cheapest,
+ * followed by dihedral tests, energy terms and unmerged closures.
+ *
+ * arguments:
+ *  @th: pointer to the thread to feasibility-check.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the atom is feasible.
+ */
+static inline int enum_thread_feasible (enum_thread_t *th) {
+  /* get the prune kernel of the current level. */
+  const enum_kernel_t *K = th->E->kern + th->level;
+
+  /* run the kinds in their measured order, if requested. */
+  if (th->adapt)
+    return enum_thread_adaptive(th, K);
+
+  /* run each kind in turn. batched nodes already passed the two-sided
+   * distance tests.
+   */
+  return (th->state[th->level].batched || enum_thread_pairs(th, K)) &&
+         enum_thread_uppers(th, K) &&
+         enum_thread_quads(th, K) &&
+         enum_thread_terms(th, K) &&
+         enum_thread_funcs(th, K);
+}
+
+/* enum_thread_lower_energy(): lower the energy tolerance of an
+ * enumerator to the energy of an accepted solution, unless another
+ * thread has already lowered it below that energy.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *  @U: energy of the accepted solution.
+ */
+static inline void enum_thread_lower_energy (enum_t *E, double U) {
+  /* read the current tolerance. */
+  double tol;
+  __atomic_load(&E->energy_tol, &tol, __ATOMIC_RELAXED);
+
+  /* attempt to replace the tolerance while the energy is lower. */
+  while (U < tol) {
+    if (__atomic_compare_exchange(&E->energy_tol, &tol, &U, 1,
+                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      return;
+  }
+}
+
+/* enum_thread_frame(): compute the local frame spanned by the three
+ * atoms that precede a given level of the tree. the frame only depends
+ * on the parent of the level, and is shared by all its siblings.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the partial embedding.
+ *  @lev: tree level of the atom to embed.
+ */
+static inline void enum_thread_frame (enum_thread_t *th,
+                                      const unsigned int lev) {
+  /* get references to the thread state and the level plan. */
+  enum_thread_node_t *state = th->state;
+  enum_thread_node_t *node = state + lev;
+  const enum_plan_t *plan = th->E->plan + lev;
+
+  /* define vector quantities and extra scalars for embedding the atom. */
+  vector_t x0, x1, x2, r01, r02, r12, rv;
+  double fp, fv, fd;
+
+  /* pull some embedded atom positions into local variables. */
+  x0 = state[lev - 3].pos;
+  x1 = state[lev - 2].pos;
+  x2 = state[lev - 1].pos;
+
+  /* r01 = x1 - x0 == x_{i-2} - x_{i-3} */
+  r01.x = x1.x - x0.x;
+  r01.y = x1.y - x0.y;
+  r01.z = x1.z - x0.z;
+
+  /* r02 = x2 - x0 == x_{i-1} - x_{i-3} */
+  r02.x = x2.x - x0.x;
+  r02.y = x2.y - x0.y;
+  r02.z = x2.z - x0.z;
+
+  /* r12 = x2 - x1 == x_{i-1} - x_{i-2} */
+  r12.x = x2.x - x1.x;
+  r12.y = x2.y - x1.y;
+  r12.z = x2.z - x1.z;
+
+  /* rv = cross(r12, r01) */
+  rv.x = r12.y * r01.z - r12.z * r01.y;
+  rv.y = r12.z * r01.x - r12.x * r01.z;
+  rv.z = r12.x * r01.y - r12.y * r01.x;
+
+  /* fd = dot(r12, r01) */
+  fd = r12.x * r01.x + r12.y * r01.y + r12.z * r01.z;
+
+  /* compute the distance between the two nearest preceding atoms. */
+  const double d12 = sqrt(r12.x * r12.x + r12.y * r12.y + r12.z * r12.z);
+
+  /* get the planned distance and angle to the atom to be embedded. */
+  const double d23 = plan->d23;
+  const double ct = plan->ct;
+
+  /* compute the scale factor for all p-vectors. */
+  fv = plan->st / sqrt(rv.x * rv.x + rv.y * rv.y + rv.z * rv.z);
+  fp = -d23 / d12;
+
+  /* compute the first anchor position, relative to the preceding atom,
+   * so that the frame is unaffected when solutions are centered.
+   */
+  node->p1.x = fp * ct * r12.x;
+  node->p1.y = fp * ct * r12.y;
+  node->p1.z = fp * ct * r12.z;
+
+  /* compute the second anchor position. */
+  fp *= fv;
+  node->p2.x = fp * (d12 * d12 * r01.x - fd * r12.x);
+  node->p2.y = fp * (d12 * d12 * r01.y - fd * r12.y);
+  node->p2.z = fp * (d12 * d12 * r01.z - fd * r12.z);
+
+  /* compute the third anchor position. */
+  node->p3.x = fp * d12 * rv.x;
+  node->p3.y = fp * d12 * rv.y;
+  node->p3.z = fp * d12 * rv.z;
+
+  /* at levels that branch on a d(i,i-3) distance, split the cosine
+   * of the dihedral (see distances_to_dihedral()) into the terms that
+   * are shared by all siblings.
+   */
+  if (!plan->dihed && !node->omega) {
+    /* compute the remaining distances between the preceding atoms. */
+    const double d01 = sqrt(r01.x * r01.x + r01.y * r01.y + r01.z * r01.z);
+    const double d02 = sqrt(r02.x * r02.x + r02.y * r02.y + r02.z * r02.z);
+    const double d13 = plan->d13;
+
+    /* compute the cosines of the angles at the two middle atoms. */
+    const double b = 0.5 * (d13*d13 + d12*d12 - d23*d23) / (d13*d12);
+    const double c = 0.5 * (d01*d01 + d12*d12 - d02*d02) / (d01*d12);
+    const double s = 1.0 / sqrt((1.0 - b*b) * (1.0 - c*c));
+
+    /* store the coefficients of the squared d(i,i-3) distance. */
+    node->k0 = (0.5 * (d01*d01 + d13*d13) / (d01*d13) - b * c) * s;
+    node->k1 = 0.5 * s / (d01*d13);
+  }
+
+  node->framed = 1;
+}
+
+/* enum_thread_embed(): compute the position of the atom at a given
+ * level of the tree, based on the local frame of its parent and the
+ * current state index of the level.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the partial embedding.
+ *  @lev: tree level of the atom to embed.
+ */
+static inline void enum_thread_embed (enum_thread_t *th,
+                                      const unsigned int lev) {
+  /* get references to the node and the level plan. */
+  enum_thread_node_t *node = th->state + lev;
+  const enum_plan_t *plan = th->E->plan + lev;
+
+  /* define angular quantities for embedding the atom. */
+  double cw, sw;
+
+  /* compute the local frame, once for all siblings. */
+  if (!node->framed)
+    enum_thread_frame(th, lev);
+
+  /* determine the cosine and sine of omega. */
+  if (node->omega) {
+    /* reduced case: use the discretized dihedral of the node. */
+    cw = node->cw[node->idx];
+    sw = node->sw[node->idx];
+  }
+  else if (plan->dihed) {
+    /* dihedral case: directly use the planned dihedral. */
+    cw = plan->cw[node->idx];
+    sw = plan->sw[node->idx];
+  }
+  else {
+    /* distance/angle case: compute omega from the planned
+     * d(i,i-3) edge value and sign.
+     */
+    const double d03 = plan->w[node->idx];
+    cw = node->k0 - node->k1 * d03 * d03;
+    cw = (cw < -1.0 ? -1.0 : cw > 1.0 ? 1.0 : cw);
+    sw = plan->sig[node->idx] * sqrt(1.0 - cw * cw);
+  }
+
+  /* compute and store the newly embedded atom position. */
+  const vector_t *x2 = &node[-1].pos;
+  node->pos.x = x2->x + node->p1.x + cw * node->p2.x + sw * node->p3.x;
+  node->pos.y = x2->y + node->p1.y + cw * node->p2.y + sw * node->p3.y;
+  node->pos.z = x2->z + node->p1.z + cw * node->p2.z + sw * node->p3.z;
+}
+
+/* enum_thread_batch_trig(): embed a batch of siblings from tabulated
+ * cosines and sines of their dihedrals.
+ *
+ * arguments:
+ *  @cw, @sw: arrays of cosines and sines of omega of each sibling.
+ *  @n: number of siblings in the batch.
+ *  @p1, @p2, @p3: anchor vectors of the local frame.
+ *  @bx, @by, @bz: output arrays of sibling positions.
+ */
+static ENUM_TARGET_CLONES
+void enum_thread_batch_trig (const double *restrict cw,
+                             const double *restrict sw,
+                             const unsigned int n,
+                             const vector_t p1, const vector_t p2,
+                             const vector_t p3,
+                             double *restrict bx,
+                             double *restrict by,
+                             double *restrict bz) {
+  /* loop over the siblings in the batch. */
+  for (unsigned int k = 0; k < n; k++) {
+    bx[k] = p1.x + cw[k] * p2.x + sw[k] * p3.x;
+    by[k] = p1.y + cw[k] * p2.y + sw[k] * p3.y;
+    bz[k] = p1.z + cw[k] * p2.z + sw[k] * p3.z;
+  }
+}
+
+/* enum_thread_batch_dist(): embed a batch of siblings from planned
+ * d(i,i-3) distances and signs of sin(omega).
+ *
+ * arguments:
+ *  @w, @sig: arrays of distances and signs of each sibling.
+ *  @n: number of siblings in the batch.
+ *  @k0, @k1: coefficients of the cosine of omega in the local frame.
+ *  @p1, @p2, @p3: anchor vectors of the local frame.
+ *  @bx, @by, @bz: output arrays of sibling positions.
+ */
+static ENUM_TARGET_CLONES
+void enum_thread_batch_dist (const double *restrict w,
+                             const double *restrict sig,
+                             const unsigned int n,
+                             const double k0, const double k1,
+                             const vector_t p1, const vector_t p2,
+                             const vector_t p3,
+                             double *restrict bx,
+                             double *restrict by,
+                             double *restrict bz) {
+  /* loop over the siblings in the batch. */
+  for (unsigned int k = 0; k < n; k++) {
+    /* compute the cosine and sine of omega. */
+    double cw = k0 - k1 * w[k] * w[k];
+    cw = (cw < -1.0 ? -1.0 : cw > 1.0 ? 1.0 : cw);
+    const double sw = sig[k] * sqrt(1.0 - cw * cw);
+
+    /* compute the sibling position. */
+    bx[k] = p1.x + cw * p2.x + sw * p3.x;
+    by[k] = p1.y + cw * p2.y + sw * p3.y;
+    bz[k] = p1.z + cw * p2.z + sw * p3.z;
+  }
+}
+
+/* enum_thread_batch_pair(): prune a batch of sibling positions against
+ * the squared distance bounds to a single earlier atom.
+ *
+ * arguments:
+ *  @bx, @by, @bz: arrays of sibling positions.
+ *  @alive: array of flags marking the surviving siblings.
+ *  @n: number of siblings in the batch.
+ *  @x, @y, @z: position of the earlier atom.
+ *  @lo2, @hi2: squared bounds on the distance to the earlier atom.
+ *  @nt: pointer to the output number of tested siblings.
+ *
+ * returns:
+ *  number of siblings pruned by the bounds.
+ */
+static ENUM_TARGET_CLONES
+unsigned int enum_thread_batch_pair (const double *restrict bx,
+                                     const double *restrict by,
+                                     const double *restrict bz,
+                                     unsigned char *restrict alive,
+                                     const unsigned int n,
+                                     const double x, const double y,
+                                     const double z, const double lo2,
+                                     const double hi2, unsigned int *nt) {
+  /* declare variables for counting tested and pruned siblings. */
+  unsigned int tested = 0, pruned = 0;
+
+  /* loop over the siblings in the batch. */
+  for (unsigned int k = 0; k < n; k++) {
+    /* compute the squared distance to the earlier atom. */
+    const double dx = bx[k] - x;
+    const double dy = by[k] - y;
+    const double dz = bz[k] - z;
+    const double d2 = dx * dx + dy * dy + dz * dz;
+
+    /* test the surviving siblings against the bounds. */
+    const unsigned char out = (d2 < lo2) | (d2 > hi2);
+    tested += alive[k];
+    pruned += alive[k] & out;
+    alive[k] &= !out;
+  }
+
+  /* return the counts. */
+  *nt = tested;
+  return pruned;
+}
+
+/* enum_thread_batch(): embed every remaining sibling at a given level
+ * of the tree at once, and apply the two-sided distance tests of its
+ * prune kernel to the whole batch.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the partial embedding.
+ *  @lev: tree level of the atoms to embed.
+ */
+static inline void enum_thread_batch (enum_thread_t *th,
+                                      const unsigned int lev) {
+  /* get references to the node and the level plan. */
+  enum_thread_node_t *node = th->state + lev;
+  const enum_plan_t *plan = th->E->plan + lev;
+  enum_t *E = th->E;
+
+  /* compute the local frame, once for all siblings. */
+  if (!node->framed)
+    enum_thread_frame(th, lev);
+
+  /* get the range of remaining siblings. */
+  const unsigned int k0 = node->idx;
+  const unsigned int nb = (node->omega ? node->n_omega : node->nb);
+  const unsigned int n = (nb > k0 ? nb - k0 : 0);
+
+  /* embed the remaining siblings, relative to the preceding atom. */
+  if (node->omega)
+    enum_thread_batch_trig(node->cw + k0, node->sw + k0, n,
+                           node->p1, node->p2, node->p3,
+                           node->bx + k0, node->by + k0, node->bz + k0);
+  else if (plan->dihed)
+    enum_thread_batch_trig(plan->cw + k0, plan->sw + k0, n,
+                           node->p1, node->p2, node->p3,
+                           node->bx + k0, node->by + k0, node->bz + k0);
+  else
+    enum_thread_batch_dist(plan->w + k0, plan->sig + k0, n,
+                           node->k0, node->k1,
+                           node->p1, node->p2, node->p3,
+                           node->bx + k0, node->by + k0, node->bz + k0);
+
+  /* mark every remaining sibling as alive, and count them. */
+  memset(node->alive + k0, 1, n);
+  th->nodes += n;
+
+  /* apply the two-sided distance tests to the whole batch, with the
+   * earlier atoms relative to the preceding atom.
+   */
+  const enum_kernel_t *K = E->kern + lev;
+  const vector_t x0 = node[-1].pos;
+  for (unsigned int i = 0; i < K->n_pair && n; i++) {
+    const enum_kernel_pair_t *p = K->pair + i;
+    const vector_t *xb = &th->state[p->lev].pos;
+    unsigned int nt;
+    const unsigned int np =
+      enum_thread_batch_pair(node->bx + k0, node->by + k0, node->bz + k0,
+                             node->alive + k0, n, xb->x - x0.x,
+                             xb->y - x0.y, xb->z - x0.z,
+                             p->lo2, p->hi2, &nt);
+
+    /* count the tests and prunes. */
+    enum_stat_add(th, p->stat, nt);
+    enum_stat_add(th, p->stat + 1, np);
+
+    /* stop once no siblings remain. */
+    if (nt == np)
+      break;
+  }
+
+  /* mark the batch as belonging to the current parent. */
+  node->batched = 1;
+}
+
+/* enum_thread_place(): position the atom at a given level of the tree,
+ * either by embedding it directly or by taking it from the batch of
+ * its siblings.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the partial embedding.
+ *  @lev: tree level of the atom to position.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the atom survived the
+ *  batched tests.
+ */
+static inline int enum_thread_place (enum_thread_t *th,
+                                     const unsigned int lev) {
+  /* get a reference to the node. */
+  enum_thread_node_t *node = th->state + lev;
+
+  /* embed the atom directly at levels that are not batched. */
+  if (!node->alive) {
+    enum_thread_embed(th, lev);
+    th->nodes++;
+    return 1;
+  }
+
+  /* embed the batch of siblings, once for each parent. */
+  if (!node->batched)
+    enum_thread_batch(th, lev);
+
+  /* skip siblings that were pruned as part of the batch. */
+  const unsigned int k = node->idx;
+  if (!node->alive[k])
+    return 0;
+
+  /* take the position from the batch. */
+  const vector_t *x2 = &node[-1].pos;
+  node->pos.x = x2->x + node->bx[k];
+  node->pos.y = x2->y + node->by[k];
+  node->pos.z = x2->z + node->bz[k];
+  return 1;
+}
+
+/* enum_thread_reduced(): determine whether the current node at a given
+ * level of the tree has a dihedral to embed with. the reduced dihedrals
+ * of a level are computed once for all siblings, when the first of them
+ * is reached, and levels that do not branch on reduced intervals always
+ * have dihedrals.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the partial embedding.
+ *  @lev: tree level of the atom to embed.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the node may be embedded.
+ *  when zero, the node and all its later siblings are infeasible.
+ */
+static inline int enum_thread_reduced (enum_thread_t *th,
+                                       const unsigned int lev) {
+  /* get a reference to the node. */
+  enum_thread_node_t *node = th->state + lev;
+
+  /* check if the level branches on reduced intervals. */
+  if (!node->omega)
+    return 1;
+
+  /* compute the reduced dihedrals for the current parent. */
+  if (node->n_omega == ENUM_REDUCE_STALE)
+    enum_reduce(th, lev);
+
+  /* return whether the node index lies within the dihedrals. */
+  return (node->idx < node->n_omega);
+}
+
+/* enum_thread_embed_base(): compute the positions of the first three
+ * atoms of the order, which are common to every tree node.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the partial embedding.
+ */
+static inline void enum_thread_embed_base (enum_thread_t *th) {
+  /* get references to the thread state and the graph. */
+  enum_thread_node_t *state = th->state;
+  graph_t *G = th->E->G;
+
+  /* get the distances required to embed the first three atoms. */
+  const double d01 = graph_get_edge_exact(G, G->order[0], G->order[1]);
+  const double d02 = graph_get_edge_exact(G, G->order[0], G->order[2]);
+  const double d12 = graph_get_edge_exact(G, G->order[1], G->order[2]);
+
+  /* compute the cosine and sine of the angle formed by the atoms. */
+  const double ct = distances_to_angle(d01, d02, d12);
+  const double st = sqrt(1.0 - ct * ct);
+
+  /* initialize the first three atom positions. */
+  vector_set(&state[0].pos, 0.0, 0.0, 0.0);
+  vector_set(&state[1].pos, -d01, 0.0, 0.0);
+  vector_set(&state[2].pos, d12 * ct - d01, d12 * st, 0.0);
+}
+
+/* enum_threads_frontier(): expand the shallowest levels of the tree
+ * breadth-first into a compact array of feasible prefixes, which are
+ * then handed out to the enumerator threads for depth-first traversal.
+ *
+ * each level is expanded and pruned in a single batch over all the
+ * prefixes that survived the level before it. the expansion stops
+ * early if the next level would not fit into the frontier arrays.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_threads_frontier (enum_t *E) {
+  /* declare required variables:
+   *  @th: thread used as scratch space for embedding and pruning.
+   *  @D: number of levels allocated for each frontier prefix.
+   *  @n, @m: number of prefixes in the current and next frontiers.
+   *  @cap: maximum number of prefixes held in each frontier.
+   *  @cur: index of the current frontier arrays.
+   */
+  enum_thread_t *th = E->threads;
+  enum_thread_node_t *state = th->state;
+  const unsigned int len = E->G->n_order;
+  const unsigned int *dup = E->G->orig;
+  unsigned int D, lev, n, m, cur;
+  unsigned long bytes, cap;
+
+  /* declare the current and next frontier arrays. */
+  unsigned int *idx[2] = { NULL, NULL };
+  vector_t *pos[2] = { NULL, NULL };
+  double *energy[2] = { NULL, NULL };
+
+  /* return if no frontier was requested, or if the tree is too shallow
+   * to leave any levels for depth-first traversal.
+   */
+  D = 3 + E->frontier_lev;
+  if (D > len - 1)
+    D = len - 1;
+  if (E->frontier_lev == 0 || D <= 3)
+    return 1;
+
+  /* compute the frontier capacity. */
+  bytes = D * (sizeof(unsigned int) + sizeof(vector_t) + sizeof(double));
+  cap = ENUM_FRONTIER_BYTES / (2 * bytes);
+
+  /* allocate the current and next frontier arrays. */
+  for (cur = 0; cur < 2; cur++) {
+    idx[cur] = (unsigned int*) malloc(cap * D * sizeof(unsigned int));
+    pos[cur] = (vector_t*) malloc(cap * D * sizeof(vector_t));
+    energy[cur] = (double*) malloc(cap * D * sizeof(double));
+  }
+
+  /* check that allocation succeeded. */
+  if (!idx[0] || !pos[0] || !energy[0] ||
+      !idx[1] || !pos[1] || !energy[1]) {
+    /* free the allocated arrays. */
+    for (cur = 0; cur < 2; cur++) {
+      free(idx[cur]);
+      free(pos[cur]);
+      free(energy[cur]);
+    }
+
+    /* raise an exception. */
+    throw("unable to allocate frontier of %lu prefixes", cap);
+  }
+
+  /* initialize the frontier with the root prefix. */
+  enum_thread_embed_base(th);
+  for (unsigned int i = 0; i < 3; i++) {
+    idx[0][i] = 0;
+    pos[0][i] = state[i].pos;
+    energy[0][i] = 0.0;
+  }
+
+  /* expand the frontier one level at a time. */
+  for (lev = 3, n = 1, cur = 0; lev < D && n; lev++) {
+    /* get the branch count of the level. */
+    const unsigned int nb = state[lev].nb;
+
+    /* stop expanding if the next frontier could overflow. */
+    if ((unsigned long) n * nb > cap) {
+      warn("frontier truncated at level %u (%u prefixes)", lev, n);
+      break;
+    }
+
+    /* get references to the current and next frontier arrays. */
+    const unsigned int *cidx = idx[cur];
+    const vector_t *cpos = pos[cur];
+    const double *cenergy = energy[cur];
+    unsigned int *nidx = idx[cur ^ 1];
+    vector_t *npos = pos[cur ^ 1];
+    double *nenergy = energy[cur ^ 1];
+    m = 0;
+
+    /* loop over the prefixes in the current frontier. */
+    for (unsigned int p = 0; p < n; p++) {
+      /* load the prefix into the scratch thread. */
+      for (unsigned int i = 0; i < lev; i++) {
+        state[i].idx = cidx[p * D + i];
+        state[i].pos = cpos[p * D + i];
+        state[i].energy = cenergy[p * D + i];
+      }
+
+      /* the frame and reduced dihedrals of the children depend on
+       * the prefix, as does the clash grid.
+       */
+      state_stale(state + lev);
+      if (E->clash_rad)
+        enum_prune_clash_reset(th);
+
+      /* loop over the children of the prefix. */
+      for (unsigned int c = 0; c < nb; c++) {
+        /* skip children that lie outside the slice of the tree. */
+        state[lev].idx = c;
+        if (!enum_thread_in_slice(E, state, lev))
+          continue;
+
+        /* embed the child, or copy it for duplicate atoms, which add
+         * no energy to their parent.
+         */
+        if (dup[lev]) {
+          state[lev].pos = state[lev - dup[lev]].pos;
+          state[lev].energy = state[lev - 1].energy;
+        }
+        else {
+          /* stop once the reduced dihedrals of the prefix run out. */
+          if (!enum_thread_reduced(th, lev))
+            break;
+
+          /* embed the child and check its feasibility. */
+          enum_thread_embed(th, lev);
+          th->level = lev;
+          th->nodes++;
+          if (!enum_thread_feasible(th))
+            continue;
+        }
+
+        /* store the feasible child into the next frontier. */
+        for (unsigned int i = 0; i <= lev; i++) {
+          nidx[m * D + i] = state[i].idx;
+          npos[m * D + i] = state[i].pos;
+          nenergy[m * D + i] = state[i].energy;
+        }
+
+        /* move to the next slot of the next frontier. */
+        m++;
+      }
+    }
+
+    /* swap the current and next frontiers. */
+    n = m;
+    cur ^= 1;
+
+    /* output an informational message about the frontier size. */
+    info("frontier level %u: %u prefixes", lev, n);
+  }
+
+  /* compact the prefixes if the expansion stopped early. */
+  for (unsigned int p = 0; lev < D && p < n; p++) {
+    for (unsigned int i = 0; i < lev; i++) {
+      idx[cur][p * lev + i] = idx[cur][p * D + i];
+      pos[cur][p * lev + i] = pos[cur][p * D + i];
+      energy[cur][p * lev + i] = energy[cur][p * D + i];
+    }
+  }
+
+  /* free the unused frontier arrays. */
+  free(idx[cur ^ 1]);
+  free(pos[cur ^ 1]);
+  free(energy[cur ^ 1]);
+
+  /* store the final frontier into the enumerator. */
+  E->frontier_idx = idx[cur];
+  E->frontier_pos = pos[cur];
+  E->frontier_energy = energy[cur];
+  E->frontier_depth = lev;
+  E->frontier_sz = n;
+  E->frontier_next = 0;
+
+  /* every thread now begins idle, and obtains work from the frontier. */
+  for (unsigned int t = 0; t < E->nthreads; t++)
+    E->threads[t].working = E->threads[t].granted = 0;
+
+  /* update the global scheduler state. */
+  E->nidle = E->nthreads;
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_thread_claim(): hand the next unclaimed range of the tree that
+ * was saved in a checkpoint, or otherwise the next unclaimed prefix of
+ * the frontier, to a thread. the thread receives the embedded positions
+ * of every level above the range, and the range of the levels below it.
+ *
+ * arguments:
+ *  @th: pointer to the thread that requires work.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) a range was claimed.
+ */
+static int enum_thread_claim (enum_thread_t *th) {
+  /* get references to the enumerator and the thread state. */
+  enum_t *E = th->E;
+  enum_thread_node_t *state = th->state;
+  const unsigned int len = E->G->n_order;
+  const unsigned int D = E->frontier_depth;
+
+  /* resume the next saved range, if any remain. */
+  if (E->resume_next < E->resume_sz) {
+    /* get the node states of the saved range. */
+    const enum_thread_node_t *saved = E->resume_state +
+      (unsigned long) len * E->resume_next;
+
+    /* restore the thread range and the embedded path. */
+    for (unsigned int i = 0; i < len; i++) {
+      state[i].idx = saved[i].idx;
+      state[i].start = saved[i].start;
+      state[i].end = saved[i].end;
+      state[i].pos = saved[i].pos;
+      state[i].energy = saved[i].energy;
+    }
+
+    /* begin embedding where the range was stopped. */
+    th->level = E->resume_level[E->resume_next++];
+    return 1;
+  }
+
+  /* return if the frontier has been exhausted. */
+  if (E->frontier_next >= E->frontier_sz)
+    return 0;
+
+  /* get the offset of the next prefix in the frontier arrays. */
+  const unsigned long p = (unsigned long) D * E->frontier_next++;
+  int at_lo = 1, at_hi = 1;
+
+  /* fix the thread range to the prefix at the frontier levels, and
+   * check whether the prefix lies on either edge of the tree slice.
+   */
+  for (unsigned int i = 0; i < D; i++) {
+    state[i].idx = state[i].start = state[i].end = E->frontier_idx[p + i];
+    state[i].pos = E->frontier_pos[p + i];
+    state[i].energy = E->frontier_energy[p + i];
+    at_lo = (at_lo && state[i].idx == E->slice_lo[i]);
+    at_hi = (at_hi && state[i].idx == E->slice_hi[i]);
+  }
+
+  /* open the thread range at all deeper levels, up to the edges of
+   * the tree slice.
+   */
+  for (unsigned int i = D; i < len; i++) {
+    state[i].idx = state[i].start = (at_lo ? E->slice_lo[i] : 0);
+    state[i].end = (at_hi ? E->slice_hi[i] : state[i].nb - 1);
+  }
+
+  /* begin embedding just below the prefix. */
+  th->level = D;
+  return 1;
+}
+
+/* enum_thread_timer(): timer thread function for enumeration timing
+ * information.
+ *
+ * arguments:
+ *  @pdata: pointer to the enumerator data structure.
+ */
+void *enum_thread_timer (void *pdata) {
+  /* get a reference to the current enumerator. */
+  enum_t *E = (enum_t*) pdata;
+
+  /* get references to commonly used sizes. */
+  const unsigned int nt = E->nthreads;
+  const unsigned int len = E->G->n_order;
+
+  /* initialize the timer. */
+  unsigned int last_nsol = 0;
+  double t = 0.0, dt = 1.0;
+
+  /* loop until the master thread cancels us. */
+  while (1) {
+    /* sleep for the required duration. */
+    sleep((unsigned int) (dt * 60.0));
+    t += dt;
+
+    /* start outputting timing information. */
+    info("elapsed time: %.0lf min.", t);
+
+#ifdef __IBP_HAVE_PTHREAD
+    /* lock the scheduler while the thread states are read, and do
+     * not allow cancellation until the lock has been released.
+     */
+    int cstate;
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cstate);
+    pthread_mutex_lock(&E->sched_mutex);
+#endif
+
+    /* compute the log-width of each thread. */
+    for (unsigned int tid = 0; tid < nt; tid++) {
+      /* skip threads that are waiting for work. */
+      if (!E->threads[tid].working) {
+        fprintf(stderr, "   #%-3u: idle\n", tid + 1);
+        continue;
+      }
+
+      /* compute the thread width. */
+      double L1 = 0.0;
+      double L2 = 0.0;
+      state_widths(E->threads[tid].state, len, &L1, &L2);
+
+      /* write the current thread information. */
+      /* fprintf(stderr, "   #%-3u: ~10^%.3lf min. remaining\n",
+              tid + 1, L2 - L1 + log10(t)); */
+      fprintf(stderr, "   #%-3u: ~10^%.3lf min. remaining, done: ~10^%.3lf, todo:~10^%.3lf\n",
+              tid + 1, L2 - L1 + log10(t),L1,L2);
+    }
+
+#ifdef __IBP_HAVE_PTHREAD
+    /* release the scheduler and allow cancellation. */
+    pthread_mutex_unlock(&E->sched_mutex);
+    pthread_setcancelstate(cstate, NULL);
+#endif
+
+    /* if the number of solutions has not increased since our
+     * last timing report, increase the delay time, up to a maximum
+     * of two hours between reports. when a solution is logged, set
+     * the delay time back to the minimum.
+     */
+    if (E->nsol <= last_nsol)
+      dt = (dt * 5.0 > 120.0 ? 120.0 : dt * 5.0);
+    else
+      dt = 1.0;
+
+    /* store the new solution count. */
+    last_nsol = E->nsol;
+  }
+
+  /* end thread execution. */
+  return NULL;
+}
+
+/* enum_thread_clock(): read the monotonic system clock.
+ *
+ * returns:
+ *  current value of the monotonic clock, in seconds.
+ */
+double enum_thread_clock (void) {
+  /* read the clock and convert the result into seconds. */
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+}
+
+#ifdef __IBP_HAVE_PTHREAD
+
+/* enum_thread_donate(): answer a pending work request made to a thread
+ * by splitting its remaining range of the tree.
+ *
+ * the range is split at the shallowest level where the index of the
+ * thread has not yet reached its end. the thread keeps the lower half
+ * of the unexplored siblings at that level (along with the sub-tree it
+ * is currently traversing), and the requesting thread receives the
+ * upper half along with the embedded path above the split level. if no
+ * such level exists, the request is declined. if the level lies below
+ * the embedded part of the path, the request is left pending.
+ *
+ * arguments:
+ *  @th: pointer to the thread that received a work request.
+ *  @lev: next level to be embedded by the thread.
+ */
+static void enum_thread_donate (enum_thread_t *th, unsigned int lev) {
+  /* get references to the enumerator and the thread state. */
+  enum_t *E = th->E;
+  enum_thread_node_t *state = th->state;
+  const unsigned int len = E->G->n_order;
+  unsigned int l, k;
+
+  /* find the shallowest level with unexplored siblings. */
+  for (l = 0; l < len && state[l].idx == state[l].end; l++);
+
+  /* if that level lies below the embedded part of our path, wait until
+   * the path has been embedded before answering the request.
+   */
+  if (l < len && l >= lev)
+    return;
+
+  /* obtain a lock on the scheduler. */
+  pthread_mutex_lock(&E->sched_mutex);
+
+  /* get and clear the request. */
+  const int r = th->req;
+  th->req = -1;
+
+  /* check that the request is still pending. */
+  if (r >= 0) {
+    /* get the requesting thread and its state. */
+    enum_thread_t *thief = E->threads + r;
+    enum_thread_node_t *tstate = thief->state;
+
+    /* check if the remaining range may be split. */
+    if (l < len) {
+      /* compute the last sibling index kept by the current thread. */
+      const unsigned int mid =
+        state[l].idx + (state[l].end - state[l].idx) / 2;
+
+      /* the requesting thread shares our embedded path above the split
+       * level, and begins embedding at the split level.
+       */
+      for (k = 0; k < l; k++) {
+        tstate[k].idx = tstate[k].start = tstate[k].end = state[k].idx;
+        tstate[k].pos = state[k].pos;
+        tstate[k].energy = state[k].energy;
+      }
+
+      /* it receives the upper half of the siblings at the split level. */
+      tstate[l].idx = tstate[l].start = mid + 1;
+      tstate[l].end = state[l].end;
+      state[l].end = mid;
+
+      /* and it inherits our end below the split level. */
+      for (k = l + 1; k < len; k++) {
+        tstate[k].idx = tstate[k].start = 0;
+        tstate[k].end = state[k].end;
+        state[k].end = state[k].nb - 1;
+      }
+
+      /* mark the requesting thread as working. */
+      thief->level = (l < 3 ? 3 : l);
+      thief->granted = 1;
+      thief->working = 1;
+      thief->steals++;
+      E->nidle--;
+    }
+
+    /* answer the request and wake up the waiting threads. */
+    thief->victim = -1;
+    pthread_cond_broadcast(&E->sched_cond);
+  }
+
+  /* release the lock on the scheduler. */
+  pthread_mutex_unlock(&E->sched_mutex);
+}
+
+#endif /* __IBP_HAVE_PTHREAD */
+
+/* enum_thread_acquire(): obtain a range of the tree for a thread to
+ * traverse. a thread that already holds a range returns immediately.
+ * otherwise, the thread requests work from the busy threads until it
+ * is granted a range, or until no work remains in the tree.
+ *
+ * arguments:
+ *  @th: pointer to the thread that requires work.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the thread holds a range
+ *  of the tree that requires traversal.
+ */
+static int enum_thread_acquire (enum_thread_t *th) {
+#ifdef __IBP_HAVE_PTHREAD
+  /* get a reference to the enumerator. */
+  enum_t *E = th->E;
+
+  /* obtain a lock on the scheduler. */
+  pthread_mutex_lock(&E->sched_mutex);
+
+  /* check if the thread has finished its previous range. */
+  if (th->working && !th->granted) {
+    /* mark the thread as idle. */
+    th->working = 0;
+    E->nidle++;
+
+    /* decline any request that we did not answer during traversal. */
+    if (th->req >= 0) {
+      E->threads[th->req].victim = -1;
+      th->req = -1;
+    }
+
+    /* wake up the waiting threads. */
+    pthread_cond_broadcast(&E->sched_cond);
+  }
+
+  /* loop until work is granted or no work remains. */
+  while (1) {
+    /* check if work has been granted to us. */
+    if (th->granted) {
+      th->granted = 0;
+      break;
+    }
+
+    /* claim the next prefix of the frontier, if any remain. */
+    if (enum_thread_claim(th)) {
+      th->working = 1;
+      E->nidle--;
+      break;
+    }
+
+    /* check if the enumeration has completed or been cut short. */
+    if (E->nidle == E->nthreads || E->term ||
+        (E->nmax && __atomic_load_n(&E->nsol, __ATOMIC_RELAXED) >= E->nmax))
+      E->done = 1;
+
+    /* return if no work remains. */
+    if (E->done) {
+      pthread_cond_broadcast(&E->sched_cond);
+      pthread_mutex_unlock(&E->sched_mutex);
+      return 0;
+    }
+
+    /* if we have no pending request, search for a busy thread. */
+    if (th->victim < 0) {
+      for (unsigned int i = 1; i < E->nthreads; i++) {
+        /* get the candidate thread. */
+        enum_thread_t *v = E->threads + (th->id + i) % E->nthreads;
+
+        /* request work from the first busy, unrequested thread. */
+        if (v->working && v->req < 0) {
+          v->req = th->id;
+          th->victim = v->id;
+          break;
+        }
+      }
+    }
+
+    /* wait for the next scheduler event. */
+    pthread_cond_wait(&E->sched_cond, &E->sched_mutex);
+  }
+
+  /* release the lock on the scheduler. */
+  pthread_mutex_unlock(&E->sched_mutex);
+  return 1;
+#else
+  /* single-threaded: traverse the initial range exactly once. */
+  if (th->granted) {
+    th->granted = 0;
+    return 1;
+  }
+
+  /* otherwise, traverse the saved ranges and prefixes in turn. */
+  th->working = enum_thread_claim(th);
+  return th->working;
+#endif
+}
+
+/* enum_thread_accept(): center the complete solution held by a thread,
+ * check it against the rmsd-step and energy tolerances, and pass it to
+ * the output system.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the solution.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) enumeration may continue,
+ *  which is false once the solution limit has been reached.
+ */
+static int enum_thread_accept (enum_thread_t *th) {
+  /* get references to the thread state and the graph. */
+  enum_thread_node_t *state = th->state;
+  graph_t *G = th->E->G;
+  enum_t *E = th->E;
+
+  /* get a reference to the length of the order. */
+  const unsigned int len = G->n_order;
+  const unsigned int *dup = G->orig;
+
+  /* define quantities for centering candidate solutions. */
+  vector_t x0;
+  double fp;
+
+  /* compute the center of the structure. */
+  x0.x = x0.y = x0.z = 0.0;
+  for (unsigned int i = 0; i < len; i++) {
+    if (!dup[i]) {
+      x0.x += state[i].pos.x;
+      x0.y += state[i].pos.y;
+      x0.z += state[i].pos.z;
+    }
+  }
+
+  /* scale the computed mean value. */
+  fp = 1.0 / ((double) G->n_orig);
+  x0.x *= fp;
+  x0.y *= fp;
+  x0.z *= fp;
+
+  /* center the coordinates of the current candidate solution. */
+  for (unsigned int i = 0; i < len; i++) {
+    state[i].pos.x -= x0.x;
+    state[i].pos.y -= x0.y;
+    state[i].pos.z -= x0.z;
+  }
+
+  /* read the energy tolerance. */
+  const double U = state[len - 1].energy;
+  double tol;
+  __atomic_load(&E->energy_tol, &tol, __ATOMIC_RELAXED);
+
+  /* reject the solution if:
+   *  1. the candidate lies within the rmsd tolerance of any stored solution.
+   *  2. the energy of the candidate solution is too high.
+   *  3. another thread stored a similar solution in the meantime.
+   */
+  unsigned int nseen = 0;
+  if ((E->rmsd_tol > 0.0 && !enum_rmsd_novel(th, &nseen)) || U > tol ||
+      (E->rmsd_tol > 0.0 && !enum_rmsd_insert(th, nseen))) {
+    __atomic_add_fetch(&E->nrej, 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  /* only an accepted solution lowers the tolerance of every thread. */
+  enum_thread_lower_energy(E, U);
+
+  /* when minimizing, the solution becomes the incumbent of the thread,
+   * and is only written if it remains the best of all threads.
+   */
+  if (E->minimize) {
+    const unsigned int inc = __atomic_add_fetch(&E->nsol, 1,
+                                                __ATOMIC_RELAXED);
+    info("incumbent %u found, U = %.32le",
+         inc, state[len - 1].energy);
+
+    if (!enum_write_keep(E, th, state[len - 1].energy)) {
+      /* raise an exception and end enumeration. */
+      raise("failed to keep incumbent %u", inc);
+      __atomic_store_n(&E->term, 1, __ATOMIC_RELAXED);
+    }
+
+    return 1;
+  }
+
+  /* claim the next solution index, unless the limit is reached. */
+  unsigned int isol = __atomic_load_n(&E->nsol, __ATOMIC_RELAXED);
+  do {
+    if (E->nmax && isol >= E->nmax)
+      return 0;
+  }
+  while (!__atomic_compare_exchange_n(&E->nsol, &isol, isol + 1, 1,
+                                      __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED));
+
+  /* write some output. */
+  isol++;
+  info("solution %u found, U = %.32le",
+       isol, state[len - 1].energy);
+
+  /* pass the solution to the output system. */
+  if (E->write_pack && !enum_write_frame(E, th, isol)) {
+    /* raise an exception and end enumeration. */
+    raise("failed to write solution %u", isol);
+    __atomic_store_n(&E->term, 1, __ATOMIC_RELAXED);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_thread_reflect(): reflect the positions of every atom that was
+ * embedded at or below a given level of the tree, through the plane of
+ * the three atoms that precede the level.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the solution.
+ *  @lev: symmetry level at which to reflect the solution.
+ */
+static inline void enum_thread_reflect (enum_thread_t *th,
+                                        const unsigned int lev) {
+  /* get references to the thread state and the graph. */
+  enum_thread_node_t *state = th->state;
+  graph_t *G = th->E->G;
+
+  /* compute the unit normal of the plane. */
+  vector_t a = state[lev - 3].pos;
+  vector_t u = state[lev - 2].pos;
+  vector_t v = state[lev - 1].pos;
+  vector_t n;
+  vector_axpy(&u, -1.0, &a);
+  vector_axpy(&v, -1.0, &a);
+  vector_cross(&u, &v, &n);
+  vector_normalize(&n);
+
+  /* reflect each atom whose original level is at or below the plane. */
+  for (unsigned int i = lev; i < G->n_order; i++) {
+    if (i - G->orig[i] < lev)
+      continue;
+
+    /* x <- x - 2 ((x - a) . n) n */
+    vector_t *x = &state[i].pos;
+    const double f = 2.0 * ((x->x - a.x) * n.x +
+                            (x->y - a.y) * n.y +
+                            (x->z - a.z) * n.z);
+    vector_axpy(x, -f, &n);
+  }
+}
+
+/* enum_thread_leaf(): output the complete solution held by a thread,
+ * followed by each of its mirror images under the partial reflections
+ * at the symmetry levels of the tree. the mirror images are visited in
+ * gray code order, so that each differs from the last by one reflection.
+ *
+ * arguments:
+ *  @th: pointer to the thread holding the solution.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) enumeration may continue.
+ */
+static int enum_thread_leaf (enum_thread_t *th) {
+  /* get references to the thread state and the enumerator. */
+  enum_thread_node_t *state = th->state;
+  enum_t *E = th->E;
+  const unsigned int len = E->G->n_order;
+
+  /* output the solution itself. */
+  if (!enum_thread_accept(th))
+    return 0;
+
+  /* centering the solution moved the atoms held in the clash grid, so
+   * the grid is rebuilt from the centered positions by the next check.
+   */
+  if (E->clash_rad)
+    enum_prune_clash_reset(th);
+
+  /* return if the tree holds no symmetry levels. */
+  if (!E->n_sym)
+    return 1;
+
+  /* save the solution positions. */
+  for (unsigned int i = 0; i < len; i++)
+    th->mirror[i] = state[i].pos;
+
+  /* loop over the mirror images of the solution. */
+  int ret = 1;
+  for (unsigned long m = 1; ret && m < (1UL << E->n_sym); m++) {
+    /* the gray code of @m flips the reflection at its lowest set bit. */
+    const unsigned int k = __builtin_ctzl(m);
+    enum_thread_reflect(th, E->sym_lev[k]);
+
+    /* output the mirror image. */
+    ret = enum_thread_accept(th);
+  }
+
+  /* restore the solution positions, which the sub-tree embeds from. */
+  for (unsigned int i = 0; i < len; i++)
+    state[i].pos = th->mirror[i];
+
+  /* return whether enumeration may continue. */
+  return ret;
+}
+
+/* enum_thread_backtrack(): move an enumerator thread past a node that
+ * either failed or finished, learning from its failures when requested.
+ *
+ * the failures under each parent are summarized by the shallowest level
+ * whose branch they depend on. once every sibling of a level has been
+ * visited, the summary of the level becomes a failure of its parent.
+ * a node whose failures only depend on its own branch and deeper ones
+ * fails under every parent, and is marked dead so that it is skipped
+ * without embedding the next time its level is reached. the branches of
+ * a node whose failures depend on a few levels above it are stored as
+ * a nogood instead, when requested.
+ *
+ * arguments:
+ *  @th: pointer to the enumerator thread to modify.
+ *  @lev: level of the node to move past.
+ *  @c: shallowest level whose branch the failure of the node depends on,
+ *      or zero if the node did not fail.
+ *
+ * returns:
+ *  highest modified level of the state, as from state_increment().
+ */
+static inline unsigned int enum_thread_backtrack (enum_thread_t *th,
+                                                  const unsigned int lev,
+                                                  unsigned int c) {
+  /* get references to the state and its length. */
+  enum_thread_node_t *state = th->state;
+  const unsigned int len = th->E->G->n_order;
+
+  /* loop upwards over the levels whose siblings are exhausted. */
+  if (th->E->backjump || th->E->nogood) {
+    for (unsigned int j = lev; j >= 3; j--) {
+      /* mark the node dead if its failures do not depend on its parent. */
+      enum_thread_node_t *node = state + j;
+      if (c >= j && node->dead) {
+        if (!node->dead[node->idx]) {
+          node->dead[node->idx] = 1;
+          th->learned++;
+        }
+      }
+
+      /* otherwise, store the failing branches as a nogood. */
+      else if (c && th->E->nogood_key)
+        enum_nogood_insert(th, j, c);
+
+      /* merge the failure into the summary of the level. */
+      if (c < node->conf)
+        node->conf = c;
+
+      /* stop once the level still has siblings to visit. */
+      if (node->idx + 1 < node->nb)
+        break;
+
+      /* the failures of the level are a failure of its parent. */
+      c = node->conf;
+    }
+  }
+
+  /* move to the next node. */
+  return state_increment(state, len, lev);
+}
+
+/* enum_thread_search(): traverse the range of the tree currently held
+ * by an enumerator thread.
+ *
+ * arguments:
+ *  @thread: pointer to the enumerator thread to execute.
+ */
+static void enum_thread_search (enum_thread_t *thread) {
   /* get references to the current thread data. */
-  enum_thread_t *thread = (enum_thread_t*) pdata;
   enum_thread_node_t *state = thread->state;
   graph_t *G = thread->E->G;
   enum_t *E = thread->E;
@@ -604,40 +2806,49 @@ void *enum_thread_execute (void *pdata) {
   const unsigned int *dup = G->orig;
   unsigned int lev = thread->level;
 
-  /* get the distances required to embed the first three atoms. */
-  double d01 = graph_get_edge_exact(G, G->order[0], G->order[1]);
-  double d02 = graph_get_edge_exact(G, G->order[0], G->order[2]);
-  double d12 = graph_get_edge_exact(G, G->order[1], G->order[2]);
-
-  /* define distances to each newly embedded atom. */
-  double d03, d13, d23;
-  value_t val03;
-
-  /* compute the cosine and sine of the angle formed by the atoms. */
-  double ct = distances_to_angle(d01, d02, d12);
-  double st = sqrt(1.0 - ct * ct);
+  /* initialize the first three atom positions, unless the thread
+   * received them along with an embedded path.
+   */
+  if (lev <= 3)
+    enum_thread_embed_base(thread);
 
-  /* define dihedral angular quantities for embedding atoms. */
-  double cw, sw, sig, lerp;
+  /* the frames and reduced dihedrals held by the thread belong to a
+   * previous path.
+   */
+  for (unsigned int i = 0; i < len; i++)
+    state_stale(state + i);
 
-  /* define vector quantities and extra scalars for embedding atoms. */
-  vector_t x0, x1, x2, x3, r01, r02, r12, rv, p1, p2, p3;
-  double fp, fv, fd;
+  /* the clash grid of the thread holds the atoms of a previous path. */
+  if (E->clash_rad)
+    enum_prune_clash_reset(thread);
 
-  /* initialize the first three atom positions. */
-  vector_set(&state[0].pos, 0.0, 0.0, 0.0);
-  vector_set(&state[1].pos, -d01, 0.0, 0.0);
-  vector_set(&state[2].pos, d12 * ct - d01, d12 * st, 0.0);
+  /* the siblings that precede the first path were not visited by the
+   * thread, so nothing may be learned from its parents.
+   */
+  for (unsigned int i = 0; (E->backjump || E->nogood) && i < len; i++)
+    state[i].conf = 0;
 
   /* loop over the set of states apportioned to the thread. */
   while (state_valid(state, len)) {
     /* check if we should terminate enumeration. */
-    if (E->term)
-      return NULL;
+    if (__atomic_load_n(&E->term, __ATOMIC_RELAXED))
+      return;
 
     /* check if we've computed enough solutions. */
-    if (E->nmax && E->nsol >= E->nmax)
-      return NULL;
+    if (E->nmax && __atomic_load_n(&E->nsol, __ATOMIC_RELAXED) >= E->nmax)
+      return;
+
+    /* wait at this safe point while a checkpoint is written. */
+    if (__atomic_load_n(&E->ckpt_req, __ATOMIC_RELAXED)) {
+      enum_checkpoint_park(thread, lev);
+      continue;
+    }
+
+#ifdef __IBP_HAVE_PTHREAD
+    /* split our range if another thread has requested work. */
+    if (__atomic_load_n(&thread->req, __ATOMIC_RELAXED) >= 0)
+      enum_thread_donate(thread, lev);
+#endif
 
     /* embed all modified atoms in the state. */
     while (lev < len) {
@@ -647,199 +2858,166 @@ void *enum_thread_execute (void *pdata) {
 
       /* check for duplicate atoms. */
       if (dup[lev]) {
-        /* store the previously computed position, and move on. */
+        /* store the previously computed position, and move on. the
+         * energy of the parent carries over, as no terms are added.
+         */
         state[lev].pos = state[lev - dup[lev]].pos;
-        state[lev].energy = state[lev - dup[lev]].energy;
-        lev++; continue;
+        state[lev].energy = state[lev - 1].energy;
+        if (++lev < len)
+          state_stale(state + lev);
+
+        continue;
       }
 
-      /* pull some embedded atom positions into local variables. */
-      x0 = state[lev - 3].pos;
-      x1 = state[lev - 2].pos;
-      x2 = state[lev - 1].pos;
-
-      /* r01 = x1 - x0 == x_{i-2} - x_{i-3} */
-      r01.x = x1.x - x0.x;
-      r01.y = x1.y - x0.y;
-      r01.z = x1.z - x0.z;
-
-      /* r02 = x2 - x0 == x_{i-1} - x_{i-3} */
-      r02.x = x2.x - x0.x;
-      r02.y = x2.y - x0.y;
-      r02.z = x2.z - x0.z;
-
-      /* r12 = x2 - x1 == x_{i-1} - x_{i-2} */
-      r12.x = x2.x - x1.x;
-      r12.y = x2.y - x1.y;
-      r12.z = x2.z - x1.z;
-
-      /* rv = cross(r12, r01) */
-      rv.x = r12.y * r01.z - r12.z * r01.y;
-      rv.y = r12.z * r01.x - r12.x * r01.z;
-      rv.z = r12.x * r01.y - r12.y * r01.x;
-
-      /* fd = dot(r12, r01) */
-      fd = r12.x * r01.x + r12.y * r01.y + r12.z * r01.z;
-
-      /* compute distances between the previously embedded atoms. */
-      d01 = sqrt(r01.x * r01.x + r01.y * r01.y + r01.z * r01.z);
-      d02 = sqrt(r02.x * r02.x + r02.y * r02.y + r02.z * r02.z);
-      d12 = sqrt(r12.x * r12.x + r12.y * r12.y + r12.z * r12.z);
-
-      /* obtain distances to the atom to be embedded. */
-      val03 = graph_get_edge(G, G->order[lev - 3], G->order[lev]);
-      d13 = graph_get_edge_exact(G, G->order[lev - 2], G->order[lev]);
-      d23 = graph_get_edge_exact(G, G->order[lev - 1], G->order[lev]);
-
-      /* compute the cosine and sine of theta. */
-      ct = distances_to_angle(d12, d13, d23);
-      st = sqrt(1.0 - ct * ct);
-
-      /* determine the cosine and sine of omega. */
-      if (value_is_dihedral(val03)) {
-        /* dihedral case: directly interpolate the cosine and sine. */
-        val03 = value_bound(value_scal(*val03.src, M_PI / 180.0),
-                            value_interval(-M_PI, M_PI));
-
-        /* compute the interpolation factor and the sign. */
-        enum_thread_lerp_index(state[lev].idx, state[lev].nb, 1,
-                               &sig, &lerp);
-
-        /* compute the current d(i,i-3) edge value. */
-        d03 = val03.l + (val03.u - val03.l) * lerp;
-
-        /* compute the cosine and sine of omega. */
-        cw = cos(d03);
-        sw = sin(d03);
+      /* skip the remaining siblings once the reduced dihedrals run out. */
+      if (!enum_thread_reduced(thread, lev)) {
+        state[lev].idx = state[lev].nb - 1;
+        lev = state_increment(state, len, lev);
+        goto infeasible;
       }
-      else {
-        /* distance/angle case: determine the sign and
-         * interpolation factors from the value of the
-         * thread state index.
-         */
-        enum_thread_lerp_index(state[lev].idx, state[lev].nb, 0,
-                               &sig, &lerp);
 
-        /* compute the current d(i,i-3) edge value. */
-        d03 = val03.l + (val03.u - val03.l) * lerp;
+      /* skip siblings that are known to fail under every parent. */
+      if (state[lev].dead && state[lev].dead[state[lev].idx]) {
+        thread->skipped++;
+        lev = enum_thread_backtrack(thread, lev, lev);
+        goto infeasible;
+      }
 
-        /* compute the cosine and sine of omega. */
-        cw = distances_to_dihedral(d01, d02, d03, d12, d13, d23);
-        cw = (cw < -1.0 ? -1.0 : cw > 1.0 ? 1.0 : cw);
-        sw = sig * sqrt(1.0 - cw * cw);
+      /* skip nodes that complete a known nogood. */
+      if (E->nogood_key) {
+        const unsigned int c = enum_nogood_find(thread, lev);
+        if (c) {
+          thread->avoided++;
+          lev = enum_thread_backtrack(thread, lev, c);
+          goto infeasible;
+        }
       }
 
-      /* compute the scale factor for all p-vectors. */
-      fv = st / sqrt(rv.x * rv.x + rv.y * rv.y + rv.z * rv.z);
-      fp = -d23 / d12;
-
-      /* compute the first anchor position. */
-      p1.x = fp * ((ct + 1.0 / fp) * x2.x - ct * x1.x);
-      p1.y = fp * ((ct + 1.0 / fp) * x2.y - ct * x1.y);
-      p1.z = fp * ((ct + 1.0 / fp) * x2.z - ct * x1.z);
-
-      /* compute the second anchor position. */
-      fp *= fv;
-      p2.x = fp * (d12 * d12 * r01.x - fd * r12.x);
-      p2.y = fp * (d12 * d12 * r01.y - fd * r12.y);
-      p2.z = fp * (d12 * d12 * r01.z - fd * r12.z);
-
-      /* compute the third anchor position. */
-      p3.x = fp * d12 * rv.x;
-      p3.y = fp * d12 * rv.y;
-      p3.z = fp * d12 * rv.z;
-
-      /* compute and store the newly embedded atom position. */
-      x3.x = p1.x + cw * p2.x + sw * p3.x;
-      x3.y = p1.y + cw * p2.y + sw * p3.y;
-      x3.z = p1.z + cw * p2.z + sw * p3.z;
-      state[lev].pos = x3;
-
-      /* check feasibility of the newly embedded atom. */
+      /* embed the atom at the current level, and check its feasibility. */
       thread->level = lev;
-      if (!enum_thread_feasible(thread)) {
+      thread->culprit = 0;
+      if (!enum_thread_place(thread, lev) ||
+          !enum_thread_feasible(thread)) {
         /* infeasible:
          *  1. skip all sub-trees of the infeasible atom/node.
          *  2. move back into the loop without incrementing.
          */
-        lev = state_increment(state, len, lev);
+        lev = enum_thread_backtrack(thread, lev, thread->culprit);
         goto infeasible;
       }
 
       /* check if the atom is feasible and terminal. */
       if (lev == len - 1) {
-        /* compute the center of the structure. */
-        x0.x = x0.y = x0.z = 0.0;
-        for (unsigned int i = 0; i < len; i++) {
-          if (!dup[i]) {
-            x0.x += state[i].pos.x;
-            x0.y += state[i].pos.y;
-            x0.z += state[i].pos.z;
+        /* run the tests deferred by adaptive pruning, and skip the
+         * sub-tree of the shallowest level that fails them.
+         */
+        if (thread->n_deferred) {
+          const unsigned int bad = enum_thread_validate(thread);
+          if (bad < len) {
+            lev = enum_thread_backtrack(thread, bad, 0);
+            goto infeasible;
           }
         }
 
-        /* scale the computed mean value. */
-        fp = 1.0 / ((double) G->n_orig);
-        x0.x *= fp;
-        x0.y *= fp;
-        x0.z *= fp;
-
-        /* center the coordinates of the current candidate solution. */
-        for (unsigned int i = 0; i < len; i++) {
-          state[i].pos.x -= x0.x;
-          state[i].pos.y -= x0.y;
-          state[i].pos.z -= x0.z;
-        }
+        /* output the solution and its mirror images. */
+        if (!enum_thread_leaf(thread))
+          return;
 
-        /* break if:
-         *  1. the rmsd-step of the candidate solution is too low.
-         *  2. the energy of the candidate solution is too high.
-         */
-        if (state_rmsd(G, state) < E->rmsd_tol ||
-            state[len - 1].energy > E->energy_tol) {
-          E->nrej++;
-          break;
-        }
+        /* move on to the next leaf. */
+        break;
+      }
+
+      /* move down a level, where the frame and reduced dihedrals of
+       * the new parent have yet to be computed.
+       */
+      if (++lev < len)
+        state_stale(state + lev);
+    }
+
+    /* increment the state. */
+    lev = enum_thread_backtrack(thread, len - 1, 0);
+
+/* causes the thread to re-enter the level loop without an increment. */
+infeasible:;
+  }
+}
 
-        /* store the new solution into the "previous" slot. */
-        for (unsigned int i = 0; i < len; i++)
-          state[i].prev = state[i].pos;
+/* enum_thread_bind(): prepare an enumerator thread for execution on
+ * its own processor. if requested, the thread is first pinned to a
+ * processor, and its state and counter arrays are then reallocated
+ * and copied from within the thread, so that first-touch page placement
+ * puts them on the memory node local to the thread.
+ *
+ * arguments:
+ *  @th: pointer to the enumerator thread to prepare.
+ */
+static void enum_thread_bind (enum_thread_t *th) {
+  /* get a reference to the enumerator. */
+  enum_t *E = th->E;
 
 #ifdef __IBP_HAVE_PTHREAD
-        /* obtain a lock on the write mutex. */
-        pthread_mutex_lock(&E->write_mutex);
+  /* pin the thread to a processor, if requested. */
+  if (E->affinity && E->ncpus) {
+    /* build a processor set holding a single processor. */
+    const unsigned int cpu = E->cpus[th->id % E->ncpus];
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    /* set the affinity of the thread. */
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus))
+      warn("unable to pin thread %u to processor %u", th->id + 1, cpu);
+  }
 #endif
 
-        /* increment the solution count. */
-        E->nsol++;
-        E->energy_tol = state[len - 1].energy;
+  /* allocate new state and counter arrays from within the thread. */
+  enum_thread_node_t *state = enum_thread_state_new(E->G->n_order);
+  unsigned long *stats = enum_thread_stats_new(E->nstats);
+  if (!state || !stats) {
+    free(state);
+    free(stats);
+    return;
+  }
+
+#ifdef __IBP_HAVE_PTHREAD
+  /* lock the scheduler while the state array is replaced. */
+  pthread_mutex_lock(&E->sched_mutex);
+#endif
 
-        /* write some output. */
-        info("solution %u found, U = %.32le",
-             E->nsol, E->energy_tol);
+  /* move the thread state into the new array. */
+  memcpy(state, th->state, E->G->n_order * sizeof(enum_thread_node_t));
+  free(th->state);
+  th->state = state;
 
-        /* write the solution. */
-        if (E->write_data && !E->write_data(E, thread)) {
-          /* raise an exception and end thread execution. */
-          raise("failed to write solution %u", E->nsol);
-          return NULL;
-        }
+  /* move the thread counters into the new array. */
+  memcpy(stats, th->stats, E->nstats * sizeof(unsigned long));
+  free(th->stats);
+  th->stats = stats;
 
 #ifdef __IBP_HAVE_PTHREAD
-        /* unlock the write mutex. */
-        pthread_mutex_unlock(&E->write_mutex);
+  /* release the lock on the scheduler. */
+  pthread_mutex_unlock(&E->sched_mutex);
 #endif
-      }
+}
 
-      /* move down a level. */
-      lev++;
-    }
+/* enum_thread_execute(): core thread function for enumerator threads.
+ *
+ * arguments:
+ *  @pdata: pointer to the current enumerator thread data structure.
+ */
+void *enum_thread_execute (void *pdata) {
+  /* get a reference to the current thread data. */
+  enum_thread_t *thread = (enum_thread_t*) pdata;
 
-    /* increment the state. */
-    lev = state_increment(state, len, len - 1);
+  /* pin the thread and localize its state. */
+  enum_thread_bind(thread);
 
-/* causes the thread to re-enter the level loop without an increment. */
-infeasible:;
+  /* traverse ranges of the tree until no work remains. */
+  while (enum_thread_acquire(thread)) {
+    /* traverse the current range, and time the traversal. */
+    const double t0 = enum_thread_clock();
+    enum_thread_search(thread);
+    thread->busy += enum_thread_clock() - t0;
   }
 
   /* end thread execution. */
@@ -4,8 +4,14 @@
 
 /* function declarations (enum-thread.c): */
 
+enum_thread_node_t *enum_thread_state_new (const unsigned int n);
+
 int enum_threads_init (enum_t *E);
 
+int enum_threads_frontier (enum_t *E);
+
+double enum_thread_clock (void);
+
 void *enum_thread_timer (void *pdata);
 
 void *enum_thread_execute (void *pdata);
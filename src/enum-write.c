@@ -12,6 +12,335 @@
  *  - enum_write_close_function  /
  */
 
+/* * * * * * * * * * * * * * RING: * * * * * * * * * * * * */
+
+/* solutions are passed from the enumerator threads to the output system
+ * through a bounded ring of preallocated frames, which is a variant of
+ * the multi-producer queue of d. vyukov. each frame carries a sequence
+ * number: a frame is free for filling when its sequence number equals
+ * the position claimed by a producer, and is ready for writing when its
+ * sequence number is one past that position.
+ *
+ * producers claim positions by atomically advancing @frame_head, pack
+ * their solutions directly into the claimed frames, and publish them by
+ * storing the ready sequence number. a single writer thread consumes
+ * consecutive ready frames in batches, and frees them after writing.
+ */
+
+#ifdef __IBP_HAVE_PTHREAD
+
+/* enum_write_execute(): core thread function for the writer thread,
+ * which writes batches of ready frames until no more frames will be
+ * filled by the enumerator threads.
+ *
+ * arguments:
+ *  @pdata: pointer to the enumerator data structure.
+ */
+static void *enum_write_execute (void *pdata) {
+  /* declare required variables:
+   *  @batch: array of pointers to the frames of a batch.
+   *  @tail: sequence number of the next frame to write.
+   *  @failed: whether or not a write has failed.
+   */
+  enum_t *E = (enum_t*) pdata;
+  enum_frame_t *batch[ENUM_WRITE_BATCH];
+  const unsigned long mask = E->nframes - 1;
+  unsigned long tail = 0;
+  unsigned int n, failed = 0;
+
+  /* define the delay between polls of an empty ring. */
+  const struct timespec delay = { 0, 100000 };
+
+  /* loop until all frames have been written. */
+  while (1) {
+    /* read the completion flag before looking for ready frames. */
+    const unsigned int done = __atomic_load_n(&E->write_done,
+                                              __ATOMIC_ACQUIRE);
+
+    /* gather a batch of consecutive ready frames. */
+    for (n = 0; n < ENUM_WRITE_BATCH && n <= mask; n++) {
+      enum_frame_t *frame = E->frames + ((tail + n) & mask);
+      if (__atomic_load_n(&frame->seq, __ATOMIC_ACQUIRE) != tail + n + 1)
+        break;
+
+      batch[n] = frame;
+    }
+
+    /* wait for frames if none were ready. */
+    if (n == 0) {
+      if (done)
+        break;
+
+      nanosleep(&delay, NULL);
+      continue;
+    }
+
+    /* record the depth of the ring. */
+    const unsigned long depth =
+      __atomic_load_n(&E->frame_head, __ATOMIC_RELAXED) - tail;
+    E->write_depth += depth;
+    if (depth > E->write_maxdepth)
+      E->write_maxdepth = depth;
+
+    /* write the batch. after a failure, frames are only discarded. */
+    if (!failed && !E->write_data(E, batch, n)) {
+      /* raise an exception and end enumeration. */
+      raise("failed to write %u solutions", n);
+      __atomic_store_n(&E->term, 1, __ATOMIC_RELAXED);
+      failed = 1;
+    }
+
+    /* free the written frames for reuse. */
+    for (unsigned int i = 0; i < n; i++)
+      __atomic_store_n(&batch[i]->seq, tail + i + E->nframes,
+                       __ATOMIC_RELEASE);
+
+    /* advance past the written frames. */
+    tail += n;
+    E->write_frames += n;
+    E->write_batches++;
+  }
+
+  /* end thread execution. */
+  return NULL;
+}
+
+#endif /* __IBP_HAVE_PTHREAD */
+
+/* enum_write_start(): allocate the ring of output frames of an
+ * enumerator and start its writer thread.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to utilize.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_write_start (enum_t *E) {
+  /* initialize the output statistics. */
+  E->frame_head = 0;
+  E->write_done = 0;
+  E->write_frames = E->write_batches = E->write_depth = 0;
+  E->write_maxdepth = 0;
+
+  /* return if the output format writes nothing. */
+  if (!E->write_pack || !E->write_data)
+    return 1;
+
+#ifdef __IBP_HAVE_PTHREAD
+  /* size the ring within its byte budget. */
+  E->nframes = ENUM_WRITE_FRAMES;
+  while (E->nframes > 2 &&
+         (unsigned long) E->nframes * E->frame_bytes > ENUM_WRITE_BYTES)
+    E->nframes /= 2;
+#else
+  /* without threads, solutions are written through a single frame. */
+  E->nframes = 1;
+#endif
+
+  /* allocate the array of frames. */
+  if (posix_memalign((void**) &E->frames, ENUM_CACHE_LINE,
+                     E->nframes * sizeof(enum_frame_t)))
+    throw("unable to allocate ring of %u frames", E->nframes);
+
+  /* initialize the frames. */
+  for (unsigned int i = 0; i < E->nframes; i++) {
+    E->frames[i].seq = i;
+    E->frames[i].isol = E->frames[i].sz = 0;
+    E->frames[i].buf = (char*) malloc(E->frame_bytes);
+    if (!E->frames[i].buf)
+      throw("unable to allocate frame buffer (%u bytes)", E->frame_bytes);
+  }
+
+#ifdef __IBP_HAVE_PTHREAD
+  /* start the writer thread. */
+  if (pthread_create(&E->writer, NULL, enum_write_execute, (void*) E))
+    throw("unable to create writer thread");
+#endif
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_write_stop(): wait for the writer thread of an enumerator to
+ * write all filled frames, and free the ring of output frames.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to utilize.
+ */
+void enum_write_stop (enum_t *E) {
+  /* return if no ring was allocated. */
+  if (!E->frames)
+    return;
+
+#ifdef __IBP_HAVE_PTHREAD
+  /* signal that no more frames will be filled, and wait. */
+  __atomic_store_n(&E->write_done, 1, __ATOMIC_RELEASE);
+  pthread_join(E->writer, NULL);
+#endif
+
+  /* free the frame buffers and the ring. */
+  for (unsigned int i = 0; i < E->nframes; i++)
+    free(E->frames[i].buf);
+
+  free(E->frames);
+  E->frames = NULL;
+}
+
+/* enum_write_frame(): pass a solution held by an enumerator thread to
+ * the output system. the solution is packed into a free frame of the
+ * ring, and the thread continues without waiting for it to be written,
+ * unless the ring is full.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to utilize.
+ *  @th: pointer to the enumerator thread holding the solution.
+ *  @isol: index of the solution.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_write_frame (enum_t *E, enum_thread_t *th, unsigned int isol) {
+  /* declare required variables:
+   *  @frame: pointer to the claimed frame.
+   *  @ret: return value of the packing function.
+   */
+  enum_frame_t *frame;
+  int ret;
+
+#ifdef __IBP_HAVE_PTHREAD
+  /* claim the next free frame of the ring. */
+  const unsigned long mask = E->nframes - 1;
+  unsigned long pos = __atomic_load_n(&E->frame_head, __ATOMIC_RELAXED);
+  double t0 = 0.0;
+  while (1) {
+    /* compare the sequence number of the frame to our position. */
+    frame = E->frames + (pos & mask);
+    const long dif = (long) (__atomic_load_n(&frame->seq, __ATOMIC_ACQUIRE)
+                             - pos);
+
+    if (dif == 0) {
+      /* the frame is free: attempt to claim it. */
+      if (__atomic_compare_exchange_n(&E->frame_head, &pos, pos + 1, 1,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    }
+    else if (dif < 0) {
+      /* the ring is full: wait for the writer to free a frame. */
+      if (t0 == 0.0)
+        t0 = enum_thread_clock();
+
+      sched_yield();
+      pos = __atomic_load_n(&E->frame_head, __ATOMIC_RELAXED);
+    }
+    else {
+      /* another thread claimed the frame: reload our position. */
+      pos = __atomic_load_n(&E->frame_head, __ATOMIC_RELAXED);
+    }
+  }
+
+  /* account for any time spent waiting. */
+  if (t0 != 0.0)
+    th->stall += enum_thread_clock() - t0;
+
+  /* pack the solution and publish the frame to the writer. */
+  frame->isol = isol;
+  ret = E->write_pack(E, th, frame);
+  __atomic_store_n(&frame->seq, pos + 1, __ATOMIC_RELEASE);
+#else
+  /* pack the solution and write it immediately. */
+  frame = E->frames;
+  frame->isol = isol;
+  ret = (E->write_pack(E, th, frame) && E->write_data(E, &frame, 1));
+
+  /* account for the written frame. */
+  E->write_frames++;
+  E->write_batches++;
+#endif
+
+  /* return the result. */
+  return ret;
+}
+
+/* enum_write_keep(): store a solution held by an enumerator thread as
+ * the incumbent of the thread, when minimizing. the solution is packed
+ * into the incumbent frame of the thread, which is not written until
+ * the search has ended.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to utilize.
+ *  @th: pointer to the enumerator thread holding the solution.
+ *  @U: energy of the solution.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_write_keep (enum_t *E, enum_thread_t *th, double U) {
+  /* store the energy of the incumbent. */
+  th->best_energy = U;
+
+  /* return if the output format writes nothing. */
+  if (!E->write_pack || !E->write_data)
+    return 1;
+
+  /* allocate the incumbent frame on first use. */
+  if (!th->best.buf) {
+    th->best.buf = (char*) malloc(E->frame_bytes);
+    if (!th->best.buf)
+      throw("unable to allocate frame buffer (%u bytes)", E->frame_bytes);
+  }
+
+  /* pack the solution. */
+  th->best.isol = 1;
+  return E->write_pack(E, th, &th->best);
+}
+
+/* enum_write_best(): write the lowest-energy incumbent of all threads
+ * of an enumerator, once the search has ended and the writer thread
+ * has been stopped.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to utilize.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int enum_write_best (enum_t *E) {
+  /* find the thread holding the lowest-energy incumbent. */
+  enum_thread_t *best = NULL;
+  for (unsigned int i = 0; i < E->nthreads; i++) {
+    enum_thread_t *th = E->threads + i;
+    if (th->best_energy < INFINITY &&
+        (!best || th->best_energy < best->best_energy))
+      best = th;
+  }
+
+  /* return if no solution was found. */
+  if (!best) {
+    warn("no solution found to minimize");
+    return 1;
+  }
+
+  /* output the minimum energy. */
+  info("minimum found, U = %.32le", best->best_energy);
+
+  /* return if the output format writes nothing. */
+  if (!best->best.buf || !E->write_data)
+    return 1;
+
+  /* write the frame of the incumbent. */
+  enum_frame_t *frame = &best->best;
+  if (!E->write_data(E, &frame, 1))
+    throw("failed to write minimum-energy solution");
+
+  /* account for the written frame. */
+  E->write_frames++;
+  E->write_batches++;
+
+  /* return success. */
+  return 1;
+}
+
 /* * * * * * * * * * * * * * DCD: * * * * * * * * * * * * * */
 
 /* enum_write_dcd_open(): called to open a DCD output system.
@@ -27,6 +356,33 @@ int enum_write_dcd_open (enum_t *E) {
   double dbuf;
   char cbuf[160];
 
+  /* compute the size of each packed frame: three coordinate records,
+   * each surrounded by a pair of size integers.
+   */
+  E->frame_bytes = 3 * (2 * sizeof(int) + E->G->n_orig * sizeof(float));
+
+  /* when resuming from a checkpoint, append to the existing file after
+   * discarding any frames that were written after the checkpoint.
+   */
+  if (E->resume && E->resume_offset > 0) {
+    /* attempt to open the existing output file. */
+    fd = open(E->fname, O_WRONLY);
+    if (fd < 0)
+      throw("unable to open file '%s'", E->fname);
+
+    /* truncate the file to its size at the checkpoint. */
+    if (ftruncate(fd, E->resume_offset) ||
+        lseek(fd, 0, SEEK_END) != E->resume_offset) {
+      close(fd);
+      throw("unable to truncate file '%s' to %ld bytes",
+            E->fname, E->resume_offset);
+    }
+
+    /* store the file descriptor and return success. */
+    E->fd = fd;
+    return 1;
+  }
+
   /* attempt to open the output file. */
   fd = open(E->fname, O_CREAT | O_TRUNC | O_WRONLY,
             S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
@@ -95,65 +451,117 @@ void enum_write_dcd_close (enum_t *E) {
   E->fd = -1;
 }
 
-/* enum_write_dcd(): called to write a structure to (32-bit) DCD output.
+/* enum_write_dcd_pack(): called to pack a structure into a (32-bit)
+ * DCD frame.
  */
-int enum_write_dcd (enum_t *E, enum_thread_t *th) {
+int enum_write_dcd_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame) {
   /* declare required variables:
-   *  @xyz: current coordinate value, casted to a float.
+   *  @xyz: pointer to the coordinate values, casted to floats.
    *  @sz: size of each coordinate (x, y, z) record.
+   *  @buf: pointer to the current position in the frame.
    */
-  float xyz;
+  float *xyz;
+  char *buf;
   int sz;
 
-  /* compute and write the first size integer. */
-  sz = E->G->n_orig * sizeof(float);
-  write(E->fd, &sz, sizeof(int));
-
   /* locally store the thread length and originality array. */
   const unsigned int n = E->G->nv;
   const unsigned int max = E->G->n_order;
   const unsigned int *rev = E->G->ordrev;
+  const enum_thread_node_t *state = th->state;
 
-  /* x: write the current thread coordinates. */
+  /* compute the size of each coordinate record. */
+  sz = E->G->n_orig * sizeof(float);
+  buf = frame->buf;
+
+  /* x: pack the current thread coordinates. */
+  memcpy(buf, &sz, sizeof(int));
+  xyz = (float*) (buf + sizeof(int));
   for (unsigned int i = 0; i < n; i++) {
     /* skip duplicate atoms. */
     if (rev[i] >= max) continue;
 
-    /* write the value. */
-    xyz = (float) th->state[rev[i]].pos.x;
-    write(E->fd, &xyz, sizeof(float));
+    /* pack the value. */
+    *(xyz++) = (float) state[rev[i]].pos.x;
   }
 
-  /* write a pair of size integers. */
-  write(E->fd, &sz, sizeof(int));
-  write(E->fd, &sz, sizeof(int));
+  /* pack a pair of size integers. */
+  buf = (char*) xyz;
+  memcpy(buf, &sz, sizeof(int));
+  memcpy(buf + sizeof(int), &sz, sizeof(int));
 
-  /* y: write the current thread coordinates. */
+  /* y: pack the current thread coordinates. */
+  xyz = (float*) (buf + 2 * sizeof(int));
   for (unsigned int i = 0; i < n; i++) {
     /* skip duplicate atoms. */
     if (rev[i] >= max) continue;
 
-    /* write the value. */
-    xyz = (float) th->state[rev[i]].pos.y;
-    write(E->fd, &xyz, sizeof(float));
+    /* pack the value. */
+    *(xyz++) = (float) state[rev[i]].pos.y;
   }
 
-  /* write another pair of size integers. */
-  write(E->fd, &sz, sizeof(int));
-  write(E->fd, &sz, sizeof(int));
+  /* pack another pair of size integers. */
+  buf = (char*) xyz;
+  memcpy(buf, &sz, sizeof(int));
+  memcpy(buf + sizeof(int), &sz, sizeof(int));
 
-  /* z: write the current thread coordinates. */
+  /* z: pack the current thread coordinates. */
+  xyz = (float*) (buf + 2 * sizeof(int));
   for (unsigned int i = 0; i < n; i++) {
     /* skip duplicate atoms. */
     if (rev[i] >= max) continue;
 
-    /* write the value. */
-    xyz = (float) th->state[rev[i]].pos.z;
-    write(E->fd, &xyz, sizeof(float));
+    /* pack the value. */
+    *(xyz++) = (float) state[rev[i]].pos.z;
   }
 
-  /* write one final size integer. */
-  write(E->fd, &sz, sizeof(int));
+  /* pack one final size integer. */
+  buf = (char*) xyz;
+  memcpy(buf, &sz, sizeof(int));
+
+  /* store the frame size and return success. */
+  frame->sz = (buf + sizeof(int)) - frame->buf;
+  return 1;
+}
+
+/* enum_write_dcd(): called to write a batch of (32-bit) DCD frames,
+ * using as few system calls as possible.
+ */
+int enum_write_dcd (enum_t *E, enum_frame_t **frames, unsigned int n) {
+  /* declare required variables:
+   *  @iov: array of buffers for vectored output.
+   *  @niov: number of buffers to write in each call.
+   *  @nw: number of bytes written by each call.
+   */
+  struct iovec iov[ENUM_WRITE_BATCH];
+  unsigned int i, niov;
+  ssize_t nw;
+
+  /* build the array of frame buffers. */
+  for (i = 0; i < n; i++) {
+    iov[i].iov_base = frames[i]->buf;
+    iov[i].iov_len = frames[i]->sz;
+  }
+
+  /* write the frames, resuming after any partial writes. */
+  for (i = 0; i < n; i += niov) {
+    /* write as many buffers as allowed in one call. */
+    niov = (n - i > IOV_MAX ? IOV_MAX : n - i);
+    nw = writev(E->fd, iov + i, niov);
+    if (nw < 0)
+      throw("unable to write %u frames to '%s'", niov, E->fname);
+
+    /* skip past the completely written buffers. */
+    for (niov = 0; i + niov < n && (size_t) nw >= iov[i + niov].iov_len;
+         niov++)
+      nw -= iov[i + niov].iov_len;
+
+    /* adjust a partially written buffer. */
+    if (nw > 0) {
+      iov[i + niov].iov_base = (char*) iov[i + niov].iov_base + nw;
+      iov[i + niov].iov_len -= nw;
+    }
+  }
 
   /* return success. */
   return 1;
@@ -161,90 +569,154 @@ int enum_write_dcd (enum_t *E, enum_thread_t *th) {
 
 /* * * * * * * * * * * * * * PDB: * * * * * * * * * * * * * */
 
+/* ENUM_WRITE_PDB_MIN, ENUM_WRITE_PDB_MAX: bounds of the coordinates that
+ * fit into the eight-character fields of PDB atom records.
+ */
+#define ENUM_WRITE_PDB_MIN  -999.999
+#define ENUM_WRITE_PDB_MAX  9999.999
+
+/* enum_write_pdb_coord(): clamp a coordinate into the bounds of the
+ * fields of PDB atom records.
+ */
+static inline double enum_write_pdb_coord (const double x) {
+  return (x < ENUM_WRITE_PDB_MIN ? ENUM_WRITE_PDB_MIN :
+          x > ENUM_WRITE_PDB_MAX ? ENUM_WRITE_PDB_MAX : x);
+}
+
 /* enum_write_pdb_open(): called to open a PDB output system.
  */
 int enum_write_pdb_open (enum_t *E) {
-  /* attempt to create the output directory. */
-  if (mkdir(E->fname, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH))
+  /* attempt to create the output directory. when resuming from a
+   * checkpoint, the directory may already exist.
+   */
+  if (mkdir(E->fname, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) &&
+      !(E->resume && errno == EEXIST))
     throw("unable to create directory '%s'", E->fname);
 
+  /* compute an upper bound on the size of each packed frame: a header,
+   * the residue sequence and one line per atom.
+   */
+  E->frame_bytes = 512 + 81 * (E->P->n_res / 13 + 1) + 81 * E->G->n_orig;
+
   /* return success. */
   return 1;
 }
 
-/* enum_write_pdb(): called to write a structure to PDB output.
+/* enum_write_pdb_pack(): called to pack a structure into PDB text.
  */
-int enum_write_pdb (enum_t *E, enum_thread_t *th) {
+int enum_write_pdb_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame) {
   /* declare required variables:
    * @n: number of unique tree node pointers in the path.
+   * @buf: pointer to the current position in the frame.
+   * @end: pointer to the end of the frame.
    */
   unsigned int isol, i, l, n;
   peptide_atom_t *atom;
-  char *fname;
-  FILE *fh;
-
-  /* allocate the filename string. */
-  fname = (char*) malloc((strlen(E->fname) + 64) * sizeof(char));
-  if (!fname)
-    throw("unable to allocate filename string");
+  char *buf, *end;
 
   /* get the solution index. */
-  isol = E->nsol;
-
-  /* construct the filename string. */
-  sprintf(fname, "%s/%08u.pdb", E->fname, isol);
-
-  /* open the output file. */
-  fh = fopen(fname, "w");
-  if (!fh) {
-    /* free allocated memory and return failure. */
-    raise("unable to open '%s' for writing", fname);
-    free(fname);
-    return 0;
-  }
+  isol = frame->isol;
+  buf = frame->buf;
+  end = frame->buf + E->frame_bytes;
 
   /* print header information. */
-  fprintf(fh, "HEADER    ibp-ng\n");
-  fprintf(fh, "TITLE     ibp-ng solution %-24u\n", isol);
-  fprintf(fh, "%-78s\n", "COMPND");
+  buf += sprintf(buf, "HEADER    ibp-ng\n");
+  buf += sprintf(buf, "TITLE     ibp-ng solution %-24u\n", isol);
+  buf += sprintf(buf, "%-78s\n", "COMPND");
 
   /* output the residue sequence information. */
-  fprintf(fh, "SEQRES %-3u %c %4u  ", (l = 1), 'A', E->P->n_res);
+  buf += sprintf(buf, "SEQRES %-3u %c %4u  ", (l = 1), 'A', E->P->n_res);
   for (i = 0; i < E->P->n_res; i++) {
-    fprintf(fh, "%s ", peptide_get_resname(E->P, i));
+    buf += sprintf(buf, "%s ", peptide_get_resname(E->P, i));
 
     if (((i + 1) % 13) == 0 && i < E->P->n_res - 1)
-      fprintf(fh, "\nSEQRES %-3u %c %4u  ", l++, 'A', E->P->n_res);
+      buf += sprintf(buf, "\nSEQRES %-3u %c %4u  ", l++, 'A', E->P->n_res);
     else if (i == E->P->n_res - 1)
-      fprintf(fh, "\n");
+      buf += sprintf(buf, "\n");
   }
 
   /* loop over the current thread state. */
-  fprintf(fh, "%-6s    %-4u\n", "MODEL", 1);
+  buf += sprintf(buf, "%-6s    %-4u\n", "MODEL", 1);
   for (i = n = 0; i < E->G->nv; i++) {
     /* skip duplicate atoms. */
     if (E->G->ordrev[i] >= E->G->n_order)
       continue;
 
-    /* write the current atom information. */
+    /* write the current atom information, with its coordinates clamped
+     * into their fields.
+     */
     atom = E->P->atoms + i;
-    fprintf(fh, "%-6s%5u %-4s %3s %c%4u    %8.3lf%8.3lf%8.3lf"
-                "%6.2lf%6.2lf           %c\n",
-            "ATOM", n++, atom->name,
-            peptide_get_resname(E->P, atom->res_id),
-            'A', atom->res_id + 1,
-            th->state[E->G->ordrev[i]].pos.x,
-            th->state[E->G->ordrev[i]].pos.y,
-            th->state[E->G->ordrev[i]].pos.z,
-            1.0, 0.0,
-            atom->type[0]);
+    const vector_t *x = &th->state[E->G->ordrev[i]].pos;
+    const int len =
+      snprintf(buf, end - buf, "%-6s%5u %-4s %3s %c%4u    %8.3lf%8.3lf%8.3lf"
+                               "%6.2lf%6.2lf           %c\n",
+               "ATOM", n++, atom->name,
+               peptide_get_resname(E->P, atom->res_id),
+               'A', atom->res_id + 1,
+               enum_write_pdb_coord(x->x),
+               enum_write_pdb_coord(x->y),
+               enum_write_pdb_coord(x->z),
+               1.0, 0.0,
+               atom->type[0]);
+
+    /* check that the record fit into the frame. */
+    if (len < 0 || len >= end - buf)
+      throw("solution %u exceeds its frame of %u bytes",
+            isol, E->frame_bytes);
+
+    buf += len;
   }
 
   /* print footer information. */
-  fprintf(fh, "ENDMDL\nEND\n");
+  buf += sprintf(buf, "ENDMDL\nEND\n");
+
+  /* store the frame size and return success. */
+  frame->sz = buf - frame->buf;
+  return 1;
+}
+
+/* enum_write_pdb(): called to write a batch of structures to PDB output,
+ * one file per structure.
+ */
+int enum_write_pdb (enum_t *E, enum_frame_t **frames, unsigned int n) {
+  /* declare required variables:
+   *  @fname: filename string of each output file.
+   *  @fh: file handle of each output file.
+   */
+  char *fname;
+  FILE *fh;
+
+  /* allocate the filename string. */
+  fname = (char*) malloc((strlen(E->fname) + 64) * sizeof(char));
+  if (!fname)
+    throw("unable to allocate filename string");
+
+  /* loop over the frames in the batch. */
+  for (unsigned int i = 0; i < n; i++) {
+    /* construct the filename string. */
+    sprintf(fname, "%s/%08u.pdb", E->fname, frames[i]->isol);
+
+    /* open the output file. */
+    fh = fopen(fname, "w");
+    if (!fh) {
+      /* free allocated memory and return failure. */
+      raise("unable to open '%s' for writing", fname);
+      free(fname);
+      return 0;
+    }
+
+    /* write the packed frame and close the file. */
+    const int ok = (fwrite(frames[i]->buf, 1, frames[i]->sz, fh) ==
+                    frames[i]->sz);
+    if (fclose(fh) || !ok) {
+      /* free allocated memory and return failure. */
+      raise("unable to write '%s'", fname);
+      free(fname);
+      return 0;
+    }
+  }
 
   /* clean up and return success. */
-  fclose(fh);
   free(fname);
   return 1;
 }
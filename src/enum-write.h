@@ -2,17 +2,33 @@
 /* ensure once-only inclusion. */
 #pragma once
 
+/* function declarations (ring): */
+
+int enum_write_start (enum_t *E);
+
+void enum_write_stop (enum_t *E);
+
+int enum_write_frame (enum_t *E, enum_thread_t *th, unsigned int isol);
+
+int enum_write_keep (enum_t *E, enum_thread_t *th, double U);
+
+int enum_write_best (enum_t *E);
+
 /* function declarations (DCD): */
 
 int enum_write_dcd_open (enum_t *E);
 
 void enum_write_dcd_close (enum_t *E);
 
-int enum_write_dcd (enum_t *E, enum_thread_t *th);
+int enum_write_dcd_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame);
+
+int enum_write_dcd (enum_t *E, enum_frame_t **frames, unsigned int n);
 
 /* function declarations (PDB): */
 
 int enum_write_pdb_open (enum_t *E);
 
-int enum_write_pdb (enum_t *E, enum_thread_t *th);
+int enum_write_pdb_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame);
+
+int enum_write_pdb (enum_t *E, enum_frame_t **frames, unsigned int n);
 
@@ -4,16 +4,22 @@
 #include "enum-thread.h"
 #include "enum-write.h"
 #include "enum-prune.h"
+#include "enum-reduce.h"
+#include "enum-rmsd.h"
+#include "enum-nogood.h"
+#include "enum-checkpoint.h"
 
 /* enum_format_map_t: structure for mapping between output format names
  * and enumerated type values.
  */
 struct enum_format_map_t {
   /* @name: string name of the format.
-   * @write_open, @write_data, @write_close: format function pointers.
+   * @write_open, @write_pack, @write_data, @write_close: format
+   *  function pointers.
    */
   char *name;
   enum_write_open_fn write_open;
+  enum_write_pack_fn write_pack;
   enum_write_data_fn write_data;
   enum_write_close_fn write_close;
 };
@@ -24,11 +30,16 @@ struct enum_format_map_t {
 struct enum_prune_map_t {
   /* @name: string name of the pruning method.
    * @prune_init, @prune_test, @prune_report: pruning function pointers.
+   * @prune_compile: function merging closures into prune kernels.
+   * @chiral: whether or not the method distinguishes mirror images,
+   *          including the partial reflections of symmetry levels.
    */
   char *name;
   enum_prune_init_fn prune_init;
   enum_prune_test_fn prune_test;
   enum_prune_report_fn prune_report;
+  enum_prune_compile_fn prune_compile;
+  unsigned int chiral;
 };
 
 /* formats: mapping between name and type of all output formats
@@ -36,11 +47,12 @@ struct enum_prune_map_t {
  */
 static const struct enum_format_map_t formats[] = {
   /* null output format. writes absolutely nothing. */
-  { "null", NULL, NULL, NULL },
+  { "null", NULL, NULL, NULL, NULL },
 
   /* dcd output format. creates a single dcd trajectory file. */
   { "dcd",
     enum_write_dcd_open,
+    enum_write_dcd_pack,
     enum_write_dcd,
     enum_write_dcd_close
   },
@@ -48,12 +60,13 @@ static const struct enum_format_map_t formats[] = {
   /* pdb output format. creates a directory full of pdb files. */
   { "pdb",
     enum_write_pdb_open,
+    enum_write_pdb_pack,
     enum_write_pdb,
     NULL /* no close function required. */
   },
 
   /* null-terminator. */
-  { NULL, NULL, NULL, NULL }
+  { NULL, NULL, NULL, NULL, NULL }
 };
 
 /* pruners: mapping between name and pointer of all pruning method
@@ -64,46 +77,78 @@ static const struct enum_prune_map_t pruners[] = {
   { "dist",
     enum_prune_ddf_init,
     enum_prune_ddf,
-    enum_prune_ddf_report
+    enum_prune_ddf_report,
+    enum_prune_ddf_compile,
+    0
   },
 
   /* dihedral torsion feasibility. */
   { "dihe",
     enum_prune_dihe_init,
     enum_prune_taf,
-    enum_prune_dihe_report
+    enum_prune_dihe_report,
+    enum_prune_taf_compile,
+    1
   },
 
   /* improper torsion feasibility. */
   { "impr",
     enum_prune_impr_init,
     enum_prune_taf,
-    enum_prune_impr_report
+    enum_prune_impr_report,
+    enum_prune_taf_compile,
+    1
   },
 
-  /* shortest path feasibility. */
+  /* triangle (shortest path) feasibility. */
   { "path",
     enum_prune_path_init,
     enum_prune_path,
-    enum_prune_path_report
+    enum_prune_path_report,
+    enum_prune_path_compile,
+    0
   },
 
-  /* future distance feasibility. */
+  /* future distance feasibility, now subsumed by triangle feasibility. */
   { "future",
-    enum_prune_future_init,
-    enum_prune_future,
-    enum_prune_future_report
+    enum_prune_path_init,
+    enum_prune_path,
+    enum_prune_path_report,
+    enum_prune_path_compile,
+    0
   },
 
   /* energetic feasibility. */
   { "energy",
     enum_prune_energy_init,
     enum_prune_energy,
-    enum_prune_energy_report
+    enum_prune_energy_report,
+    enum_prune_energy_compile,
+    1
+  },
+
+  /* van der waals clash feasibility. tests pairs of atoms that share no
+   * edge, whose distances change under partial reflections.
+   */
+  { "clash",
+    enum_prune_clash_init,
+    enum_prune_clash,
+    enum_prune_clash_report,
+    NULL, /* called by the kernel as is. */
+    1
+  },
+
+  /* lookahead (forward checking) feasibility. */
+  { "lookahead",
+    enum_prune_lookahead_init,
+    enum_prune_lookahead,
+    enum_prune_lookahead_report,
+    NULL, /* called by the kernel as is. */
+    0
   },
 
   /* null-terminator. */
-  { NULL, NULL, NULL, NULL }
+  { NULL, NULL, NULL, NULL, NULL, 0 }
 };
 
 /* enum_init_threads(): set up the thread array of an enumerator in
@@ -119,39 +164,121 @@ static const struct enum_prune_map_t pruners[] = {
 static int enum_init_threads (enum_t *E, opts_t *opts) {
   /* declare required variables:
    *  @bytes: number of bytes to allocate for the thread array.
-   *  @offset: offset for initializing thread states.
-   *  @stride: stride for initializing thread states.
    */
-  unsigned long bytes, offset, stride;
-  char *stateptr;
+  unsigned long bytes;
 
   /* initialize the thread array and count. */
   E->threads = NULL;
   E->nthreads = opts->thread_num;
 
-  /* compute the number of bytes to allocate. */
-  bytes = E->G->n_order * sizeof(enum_thread_node_t);
-  bytes = E->nthreads * (sizeof(enum_thread_t) + bytes);
+  /* initialize the processor affinity variables. */
+  E->affinity = opts->affinity;
+  E->cpus = NULL;
+  E->ncpus = 0;
 
-  /* compute the thread offset and stride. */
-  offset = E->nthreads * sizeof(enum_thread_t);
-  stride = E->G->n_order * sizeof(enum_thread_node_t);
+  /* initialize the tree slice arrays. */
+  E->slice_lo = E->slice_hi = NULL;
+  E->prefix = NULL;
 
-  /* allocate the array of threads. */
-  E->threads = (enum_thread_t*) malloc(bytes);
-  if (!E->threads)
+#ifdef __IBP_HAVE_PTHREAD
+  /* initialize the scheduler mutex and condition. */
+  pthread_mutex_init(&E->sched_mutex, NULL);
+  pthread_cond_init(&E->sched_cond, NULL);
+
+  /* initialize the rmsd diversity index lock. */
+  pthread_rwlock_init(&E->rmsd_lock, NULL);
+
+  /* get the set of processors available to the process. */
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpus) == 0 &&
+      CPU_COUNT(&cpus) > 0) {
+    /* allocate the array of processor indices. */
+    E->cpus = (unsigned int*) malloc(CPU_COUNT(&cpus) *
+                                     sizeof(unsigned int));
+    if (!E->cpus)
+      throw("unable to allocate array of processor indices");
+
+    /* store the processor indices. */
+    for (unsigned int i = 0; i < CPU_SETSIZE; i++) {
+      if (CPU_ISSET(i, &cpus))
+        E->cpus[E->ncpus++] = i;
+    }
+  }
+#endif
+
+  /* use one thread per available processor if no count was given. */
+  if (E->nthreads == 0)
+    E->nthreads = (E->ncpus ? E->ncpus : 1);
+
+  /* initialize the breadth-first frontier. */
+  E->frontier_lev = opts->frontier;
+  E->frontier_depth = E->frontier_sz = E->frontier_next = 0;
+  E->frontier_idx = NULL;
+  E->frontier_pos = NULL;
+  E->frontier_energy = NULL;
+
+  /* initialize the tree slicing variables. */
+  E->part_k = opts->part_k;
+  E->part_n = opts->part_n;
+  E->n_prefix = opts->n_prefix;
+  E->logS = 0.0;
+
+  /* allocate the slice bounds and the tree prefix. */
+  E->slice_lo = (unsigned int*) malloc(E->G->n_order * sizeof(unsigned int));
+  E->slice_hi = (unsigned int*) malloc(E->G->n_order * sizeof(unsigned int));
+  E->prefix = (unsigned int*)
+    malloc((E->n_prefix ? E->n_prefix : 1) * sizeof(unsigned int));
+
+  /* check that allocation succeeded. */
+  if (!E->slice_lo || !E->slice_hi || !E->prefix)
+    throw("unable to allocate tree slice arrays");
+
+  /* store the tree prefix. */
+  for (unsigned int i = 0; i < E->n_prefix; i++)
+    E->prefix[i] = opts->prefix[i];
+
+  /* allocate the array of threads, aligned to cache lines in order to
+   * keep the threads from sharing any cache lines.
+   */
+  bytes = E->nthreads * sizeof(enum_thread_t);
+  if (posix_memalign((void**) &E->threads, ENUM_CACHE_LINE, bytes))
     throw("unable to allocate array of %u threads (%lu bytes)",
           E->nthreads, bytes);
 
+  /* initialize the thread state and statistics pointers. */
+  for (unsigned int i = 0; i < E->nthreads; i++) {
+    E->threads[i].state = NULL;
+    E->threads[i].stats = NULL;
+    E->threads[i].mirror = NULL;
+    E->threads[i].batch = NULL;
+    E->threads[i].adapt = NULL;
+    E->threads[i].n_deferred = 0;
+    E->threads[i].dead = NULL;
+    E->threads[i].culprit = 0;
+    E->threads[i].learned = E->threads[i].skipped = 0;
+    E->threads[i].avoided = 0;
+    E->threads[i].rmsd_pos = NULL;
+    E->threads[i].rmsd_prof = NULL;
+    E->threads[i].clash_head = E->threads[i].clash_next = NULL;
+    E->threads[i].clash_cell = E->threads[i].clash_mark = NULL;
+    E->threads[i].clash_top = E->threads[i].clash_stamp = 0;
+    E->threads[i].best.buf = NULL;
+    E->threads[i].best.seq = 0;
+    E->threads[i].best.isol = E->threads[i].best.sz = 0;
+    E->threads[i].best_energy = INFINITY;
+  }
+
   /* initialize the thread contents. */
   for (unsigned int i = 0; i < E->nthreads; i++) {
     /* store the enumerator pointer and set the initial level. */
     E->threads[i].E = E;
     E->threads[i].level = 3;
 
-    /* initialize the thread state pointer. */
-    stateptr = ((char*) E->threads) + offset + i * stride;
-    E->threads[i].state = (enum_thread_node_t*) stateptr;
+    /* allocate the thread state. */
+    E->threads[i].state = enum_thread_state_new(E->G->n_order);
+    if (!E->threads[i].state)
+      throw("unable to allocate state of thread %u", i + 1);
 
     /* loop over the positions in the order. */
     for (unsigned int j = 0; j < E->G->n_order; j++) {
@@ -159,10 +286,31 @@ static int enum_init_threads (enum_t *E, opts_t *opts) {
       E->threads[i].state[j].idx = 0;
       E->threads[i].state[j].end = 0;
       E->threads[i].state[j].nb = 0;
+      E->threads[i].state[j].sym = 0;
+
+      /* set the node interval reduction arrays. */
+      E->threads[i].state[j].isa = NULL;
+      E->threads[i].state[j].isb = NULL;
+      E->threads[i].state[j].isk = NULL;
+      E->threads[i].state[j].omega = NULL;
+      E->threads[i].state[j].cw = NULL;
+      E->threads[i].state[j].sw = NULL;
+      E->threads[i].state[j].n_omega = ENUM_REDUCE_STALE;
+      E->threads[i].state[j].framed = 0;
+
+      /* set the node batch arrays. */
+      E->threads[i].state[j].bx = NULL;
+      E->threads[i].state[j].by = NULL;
+      E->threads[i].state[j].bz = NULL;
+      E->threads[i].state[j].alive = NULL;
+      E->threads[i].state[j].batched = 0;
+
+      /* set the node backjumping variables. */
+      E->threads[i].state[j].dead = NULL;
+      E->threads[i].state[j].conf = 0;
 
       /* set the node coordinates. */
       vector_set(&E->threads[i].state[j].pos, 0.0, 0.0, 0.0);
-      vector_set(&E->threads[i].state[j].prev, 1.0e6, 1.0e6, 1.0e6);
     }
   }
 
@@ -188,14 +336,10 @@ static int enum_init_format (enum_t *E, opts_t *opts) {
 
   /* initialize with the default output system. */
   E->write_data = enum_write_dcd;
+  E->write_pack = enum_write_dcd_pack;
   E->write_open = enum_write_dcd_open;
   E->write_close = enum_write_dcd_close;
 
-#ifdef __IBP_HAVE_PTHREAD
-  /* initialize the write mutex. */
-  pthread_mutex_init(&E->write_mutex, NULL);
-#endif
-
   /* return if no output format was specified. */
   if (!opts->fmt_out)
     return 1;
@@ -206,6 +350,7 @@ static int enum_init_format (enum_t *E, opts_t *opts) {
     if (strcmp(formats[i].name, opts->fmt_out) == 0) {
       /* match found. store the function pointers. */
       E->write_data = formats[i].write_data;
+      E->write_pack = formats[i].write_pack;
       E->write_open = formats[i].write_open;
       E->write_close = formats[i].write_close;
 
@@ -218,6 +363,33 @@ static int enum_init_format (enum_t *E, opts_t *opts) {
   throw("unrecognized output format '%s'", opts->fmt_out);
 }
 
+/* enum_init_mode(): set the search mode of an enumerator by the string
+ * name of the mode, which has already been validated.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *  @opts: pointer to an options data structure to access.
+ */
+static void enum_init_mode (enum_t *E, opts_t *opts) {
+  /* enumerate solutions by default. */
+  E->minimize = (opts->mode && strcmp(opts->mode, "minimize") == 0);
+  if (!E->minimize)
+    return;
+
+  /* a solution limit or diversity filter would leave the minimum
+   * unproven, so neither applies.
+   */
+  if (E->nmax) {
+    warn("solution limit ignored when minimizing");
+    E->nmax = 0;
+  }
+
+  if (E->rmsd_tol > 0.0) {
+    warn("rmsd tolerance ignored when minimizing");
+    E->rmsd_tol = 0.0;
+  }
+}
+
 /* enum_init_prune_add(): register a pruning device with an enumerator by
  * the string name of the pruning device.
  *
@@ -242,6 +414,8 @@ static int enum_init_prune_add (enum_t *E, const char *name) {
     if (strcmp(pruners[i].name, name) == 0) {
       /* match found. get the pruning initialization function. */
       initfn = pruners[i].prune_init;
+      E->chiral |= pruners[i].chiral;
+      E->prune_mask |= 1U << i;
 
       /* loop over all levels of the graph order. */
       for (lev = 0; lev < E->G->n_order; lev++) {
@@ -293,6 +467,11 @@ static int enum_init_prune (enum_t *E, opts_t *opts) {
   if (!E->prune || !E->prune_sz || !E->prune_data)
     throw("unable to allocate pruning arrays");
 
+  /* initialize the statistics counter count, method mask and chirality. */
+  E->nstats = 0;
+  E->prune_mask = 0;
+  E->chiral = 0;
+
   /* initialize the inner arrays. */
   for (i = 0; i < E->G->n_order; i++) {
     E->prune[i] = NULL;
@@ -307,6 +486,68 @@ static int enum_init_prune (enum_t *E, opts_t *opts) {
       return 0;
   }
 
+  /* minimization prunes on the energy of the incumbent solution. */
+  if (E->minimize && !E->energy_lb)
+    throw("minimization requires the 'energy' pruning method");
+
+  /* accumulate the energy bounds of the deeper levels. */
+  if (E->energy_lb)
+    enum_prune_energy_bound(E);
+
+  /* return success. */
+  return 1;
+}
+
+/* enum_init_kernel(): compile the pruning closures registered at each
+ * level of an enumerator into the prune kernel of that level. closures
+ * of methods that provide no compile function are called by the kernel
+ * as they are.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+static int enum_init_kernel (enum_t *E) {
+  /* declare required variables:
+   *  @lev: level of the graph order.
+   *  @i: closure index.
+   *  @m: pruning method index.
+   */
+  unsigned int lev, i, m;
+
+  /* allocate the kernel array. */
+  E->kern = (enum_kernel_t*) calloc(E->G->n_order, sizeof(enum_kernel_t));
+  if (!E->kern)
+    throw("unable to allocate prune kernels");
+
+  /* loop over all levels of the graph order. */
+  for (lev = 0; lev < E->G->n_order; lev++) {
+    /* loop over the closures of the level. */
+    for (i = 0; i < E->prune_sz[lev]; i++) {
+      enum_prune_test_fn func = E->prune[lev][i];
+      void *data = E->prune_data[lev][i];
+
+      /* search for the pruning method of the closure. */
+      for (m = 0; pruners[m].name; m++) {
+        if (pruners[m].prune_test == func && pruners[m].prune_compile)
+          break;
+      }
+
+      /* merge the closure into the kernel, or keep it as is. */
+      if (pruners[m].name) {
+        if (!pruners[m].prune_compile(E, lev, data, E->kern + lev))
+          throw("unable to compile pruning method '%s'", pruners[m].name);
+      }
+      else if (!enum_prune_add_func(E->kern + lev, func, data))
+        return 0;
+    }
+
+    /* locate the branches that the outcome of each test depends on. */
+    enum_prune_set_conflicts(E, lev, E->kern + lev);
+  }
+
   /* return success. */
   return 1;
 }
@@ -353,9 +594,55 @@ enum_t *enum_new (peptide_t *P, graph_t *G, opts_t *opts) {
   /* initialize the termination variable. */
   E->term = 0;
 
+  /* initialize the checkpoint variables. */
+  E->ckpt_fname = (opts->fname_ckpt ? strdup(opts->fname_ckpt) : NULL);
+  E->ckpt_req = E->ckpt_stop = 0;
+  E->ckpt_parked = E->ckpt_count = 0;
+
+  /* initialize the resumption variables. */
+  E->resume = opts->resume;
+  E->resume_sz = E->resume_next = 0;
+  E->resume_level = NULL;
+  E->resume_state = NULL;
+  E->resume_stats = NULL;
+  E->resume_slice = NULL;
+  E->resume_frontier = E->resume_depth = E->resume_prefixes = 0;
+  E->resume_tol = INFINITY;
+  E->resume_offset = 0;
+
   /* store the branching control variables. */
   E->nbmax = opts->branch_max / 2;
   E->eps = opts->branch_eps;
+  E->reduce = opts->reduce;
+  E->batch = opts->batch;
+  E->adaptive = opts->adaptive;
+  E->backjump = opts->backjump;
+  E->nogood = opts->nogood;
+  E->nogood_fname = opts->fname_nogood;
+  E->nogood_key = NULL;
+  E->nogood_spans = E->nogood_reach = NULL;
+  E->nogood_sig = 0;
+  E->nogood_n = E->nogood_lost = E->nogood_loaded = 0;
+  E->n_reduce = 0;
+  E->symmetry = opts->symmetry;
+  E->sym_lev = NULL;
+  E->n_sym = 0;
+  E->plan = NULL;
+  E->plan_w = NULL;
+  E->kern = NULL;
+
+  /* initialize the clash radii and energy bounds. */
+  E->clash_rad = NULL;
+  E->clash_grid = 0.0;
+  E->clash_mask = 0;
+  E->energy_lb = NULL;
+
+  /* initialize the rmsd diversity index. */
+  E->rmsd_head = E->rmsd_next = NULL;
+  E->rmsd_key = NULL;
+  E->rmsd_prof = E->rmsd_pos = NULL;
+  E->rmsd_n = E->rmsd_cap = 0;
+  E->rmsd_lookups = E->rmsd_compared = 0;
 
   /* initialize the threads. */
   if (!enum_init_threads(E, opts)) {
@@ -369,6 +656,7 @@ enum_t *enum_new (peptide_t *P, graph_t *G, opts_t *opts) {
   E->ddf_tol = opts->ddf_tol;
   E->rmsd_tol = (double) G->n_orig * pow(opts->rmsd_tol, 2.0);
   E->energy_tol = INFINITY;
+  E->path_sample = opts->path_sample;
 
   /* set the enumerator output format. */
   if (!enum_init_format(E, opts)) {
@@ -378,6 +666,13 @@ enum_t *enum_new (peptide_t *P, graph_t *G, opts_t *opts) {
     return NULL;
   }
 
+  /* set the enumerator search mode. */
+  enum_init_mode(E, opts);
+
+  /* initialize the output frame ring. */
+  E->frames = NULL;
+  E->nframes = E->frame_bytes = 0;
+
   /* initialize the pruning methods. */
   if (!enum_init_prune(E, opts)) {
     /* raise an exception and return null. */
@@ -386,6 +681,14 @@ enum_t *enum_new (peptide_t *P, graph_t *G, opts_t *opts) {
     return NULL;
   }
 
+  /* compile the pruning closures into prune kernels. */
+  if (!enum_init_kernel(E)) {
+    /* raise an exception and return null. */
+    raise("unable to compile pruning methods");
+    enum_free(E);
+    return NULL;
+  }
+
   /* return the new structure pointer. */
   return E;
 }
@@ -405,16 +708,30 @@ void enum_free (enum_t *E) {
   if (!E) return;
 
 #ifdef __IBP_HAVE_PTHREAD
-  /* destroy the write mutex. */
-  pthread_mutex_destroy(&E->write_mutex);
+  /* destroy the scheduler mutex and condition. */
+  pthread_mutex_destroy(&E->sched_mutex);
+  pthread_cond_destroy(&E->sched_cond);
+  pthread_rwlock_destroy(&E->rmsd_lock);
 #endif
 
+  /* free the rmsd diversity index and the nogood table. */
+  enum_rmsd_free(E);
+  enum_nogood_free(E);
+
   /* cleanup the output system. */
+  enum_write_stop(E);
   if (E->write_close)
     E->write_close(E);
 
-  /* free the directory name string. */
+  /* free the directory name and checkpoint filename strings. */
   free(E->fname);
+  free(E->ckpt_fname);
+
+  /* free the saved ranges and statistics. */
+  free(E->resume_level);
+  free(E->resume_state);
+  free(E->resume_stats);
+  free(E->resume_slice);
 
   /* free the pruning function array. */
   if (E->prune) {
@@ -445,13 +762,158 @@ void enum_free (enum_t *E) {
   /* free the pruning test sizes. */
   free(E->prune_sz);
 
-  /* free the threads. */
-  free(E->threads);
+  /* free the prune kernels. */
+  if (E->kern) {
+    for (i = 0; i < E->G->n_order; i++) {
+      free(E->kern[i].pair);
+      free(E->kern[i].upper);
+      free(E->kern[i].quad);
+      free(E->kern[i].func);
+      free(E->kern[i].data);
+
+      for (unsigned int t = 0; t < ENERGY_TYPES; t++) {
+        for (unsigned int k = 0; k < 4; k++)
+          free(E->kern[i].term[t].lev[k]);
+
+        for (unsigned int k = 0; k < 3; k++)
+          free(E->kern[i].term[t].c[k]);
+      }
+    }
+
+    free(E->kern);
+  }
+
+  /* free the threads and their states. */
+  if (E->threads) {
+    for (i = 0; i < E->nthreads; i++) {
+      enum_reduce_free(E->threads + i);
+      free(E->threads[i].state);
+      free(E->threads[i].stats);
+      free(E->threads[i].mirror);
+      free(E->threads[i].batch);
+      free(E->threads[i].adapt);
+      free(E->threads[i].dead);
+      free(E->threads[i].clash_head);
+      free(E->threads[i].best.buf);
+    }
+
+    free(E->threads);
+  }
+
+  /* free the processor indices. */
+  free(E->cpus);
+
+  /* free the symmetry levels. */
+  free(E->sym_lev);
+
+  /* free the clash radii and the energy bounds. */
+  free(E->clash_rad);
+  free(E->energy_lb);
+
+  /* free the embedding plans. */
+  free(E->plan);
+  free(E->plan_w);
+
+  /* free the tree slice arrays. */
+  free(E->slice_lo);
+  free(E->slice_hi);
+  free(E->prefix);
+
+  /* free the frontier arrays. */
+  free(E->frontier_idx);
+  free(E->frontier_pos);
+  free(E->frontier_energy);
 
   /* finally, free the structure pointer. */
   free(E);
 }
 
+/* enum_report_adaptive(): output the decisions taken by adaptive pruning
+ * at each level where the kinds of tests were reordered or deferred.
+ * the measurements of all threads are summed, and each kind is listed
+ * with its yield in prunes per microsecond of testing.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator structure to access.
+ */
+static void enum_report_adaptive (enum_t *E) {
+  /* define the names of the kinds of tests. */
+  static const char *kinds[ENUM_KERNEL_KINDS] = {
+    "pair", "upper", "quad", "term", "func"
+  };
+
+  /* output an initial header. */
+  printf("\nAdaptive pruning [prunes/us]:\n");
+
+  /* loop over the levels of the graph order. */
+  for (unsigned int lev = 0; lev < E->G->n_order; lev++) {
+    /* get the kinds of tests of the level. */
+    const enum_adapt_t *A0 = E->threads[0].adapt + lev;
+    if (E->G->orig[lev] || A0->n_order < 1)
+      continue;
+
+    /* sum the measurements and deferrals of all threads. */
+    double rate[ENUM_KERNEL_KINDS];
+    unsigned int ndef[ENUM_KERNEL_KINDS], any = 0;
+    unsigned char order[ENUM_KERNEL_KINDS];
+    for (unsigned int j = 0; j < A0->n_order; j++) {
+      const unsigned int kind = A0->order[j];
+      unsigned long runs = 0, prunes = 0, samples = 0;
+      double ns = 0.0;
+
+      ndef[kind] = 0;
+      for (unsigned int t = 0; t < E->nthreads; t++) {
+        const enum_adapt_t *A = E->threads[t].adapt + lev;
+        runs += A->runs[kind];
+        prunes += A->prunes[kind];
+        samples += A->samples[kind];
+        ns += A->ns[kind];
+        ndef[kind] += !!(A->deferred & (1U << kind));
+      }
+
+      rate[kind] = (runs && samples && ns > 0.0
+                    ? 1.0e3 * (double) prunes / (double) runs /
+                      (ns / (double) samples)
+                    : 0.0);
+
+      any |= ndef[kind];
+    }
+
+    /* sort the kinds by decreasing summed yield. */
+    for (unsigned int j = 0; j < A0->n_order; j++) {
+      unsigned int k = j;
+      for (; k > 0 && rate[order[k - 1]] < rate[A0->order[j]]; k--)
+        order[k] = order[k - 1];
+
+      order[k] = A0->order[j];
+    }
+
+    /* skip levels that kept their default order and deferred nothing. */
+    unsigned int moved = 0;
+    for (unsigned int j = 1; j < A0->n_order; j++)
+      moved |= (order[j] < order[j - 1]);
+
+    if (!moved && !any)
+      continue;
+
+    /* output the atom of the level. */
+    const unsigned int ai = E->G->order[lev];
+    const unsigned int ri = E->P->atoms[ai].res_id;
+    printf("  %3s%-4u %-4s :", peptide_get_resname(E->P, ri), ri + 1,
+           E->P->atoms[ai].name);
+
+    /* output the kinds in their order. */
+    for (unsigned int j = 0; j < A0->n_order; j++) {
+      const unsigned int kind = order[j];
+      printf(" %s %.3g", kinds[kind], rate[kind]);
+      if (ndef[kind])
+        printf(" (deferred in %u/%u)", ndef[kind], E->nthreads);
+    }
+
+    printf("\n");
+  }
+}
+
 /* enum_report(): output a pruning report after enumeration.
  *
  * arguments:
@@ -469,8 +931,17 @@ static void enum_report (enum_t *E) {
   enum_prune_test_fn testfn;
   enum_prune_report_fn reportfn;
 
+#ifndef __IBP_HAVE_STATS
+  /* note that no pruning statistics were gathered. */
+  printf("\nPruning statistics were disabled at build time.\n");
+#endif
+
   /* loop over the pruning methods. */
   for (m = 0; pruners[m].name; m++) {
+    /* skip methods that alias an earlier method. */
+    for (i = 0; i < m && pruners[i].prune_init != pruners[m].prune_init; i++);
+    if (i < m) continue;
+
     /* output an initial header. */
     printf("\nPruning results [%s]:\n", pruners[m].name);
 
@@ -494,11 +965,116 @@ static void enum_report (enum_t *E) {
     }
   }
 
+  /* output the decisions of adaptive pruning. */
+  if (E->adaptive)
+    enum_report_adaptive(E);
+
+  /* output the siblings learned and skipped by backjumping. */
+  if (E->backjump) {
+    unsigned long learned = 0, skipped = 0;
+    for (i = 0; i < E->nthreads; i++) {
+      learned += E->threads[i].learned;
+      skipped += E->threads[i].skipped;
+    }
+
+    printf("\nBackjumping:\n"
+           "  Learned:  %16lu dead siblings\n"
+           "  Skipped:  %16lu nodes\n",
+           learned, skipped);
+  }
+
+  /* output the nogoods stored and the nodes they skipped. */
+  if (E->nogood) {
+    unsigned long avoided = 0;
+    for (i = 0; i < E->nthreads; i++)
+      avoided += E->threads[i].avoided;
+
+    printf("\nNogoods:\n"
+           "  Loaded:   %16lu nogoods\n"
+           "  Stored:   %16lu nogoods\n"
+           "  Dropped:  %16lu nogoods\n"
+           "  Skipped:  %16lu nodes\n",
+           E->nogood_loaded, E->nogood_n, E->nogood_lost, avoided);
+  }
+
+  /* output the slice of the tree that was enumerated. */
+  if (E->part_n > 1 || E->n_prefix)
+    printf("\nSlice:\n"
+           "  Partition:%16u of %u\n"
+           "  Prefix:   %16u levels\n"
+           "  Leaves:   %16.3lf log10 (of %.3lf)\n",
+           E->part_k, E->part_n, E->n_prefix, E->logS, E->logW);
+
+  /* output the partial reflection symmetry of the tree. */
+  if (E->n_sym)
+    printf("\nSymmetry:\n"
+           "  Levels:   %16u\n"
+           "  Mirrors:  %16lu per solution\n",
+           E->n_sym, (1UL << E->n_sym) - 1);
+
+  /* output the size of the breadth-first frontier. */
+  if (E->frontier_depth)
+    printf("\nFrontier:\n"
+           "  Levels:   %16u\n"
+           "  Prefixes: %16u\n",
+           E->frontier_depth - 3, E->frontier_sz);
+
+  /* output the utilisation of each thread. */
+  printf("\nThreads:\n");
+  for (i = 0; i < E->nthreads; i++) {
+    /* compute the fraction of wall time spent traversing the tree. */
+    const enum_thread_t *th = E->threads + i;
+    const double f = (E->wall > 0.0 ? th->busy / E->wall * 100.0 : 0.0);
+
+    /* output the statistics. */
+    printf("  #%-3u: %16lu nodes, %8u steals, %6.2lf%% busy\n",
+           i + 1, th->nodes, th->steals, f);
+  }
+
+  /* output the statistics of the output system. */
+  if (E->write_batches) {
+    /* sum the time spent by all threads waiting for free frames. */
+    double stall = 0.0;
+    for (i = 0; i < E->nthreads; i++)
+      stall += E->threads[i].stall;
+
+    /* output the statistics. */
+    printf("\nOutput:\n"
+           "  Frames:   %16lu\n"
+           "  Batches:  %16lu\n"
+           "  Depth:    %16.2lf mean, %u max (of %u)\n"
+           "  Stalled:  %16.3lf s\n",
+           E->write_frames, E->write_batches,
+           (double) E->write_depth / (double) E->write_batches,
+           E->write_maxdepth, E->nframes, stall);
+  }
+
+  /* output the efficiency of the rmsd diversity index. */
+  if (E->rmsd_lookups)
+    printf("\nDiversity:\n"
+           "  Stored:   %16u\n"
+           "  Lookups:  %16lu\n"
+           "  Compared: %16lu\n",
+           E->rmsd_n, E->rmsd_lookups, E->rmsd_compared);
+
+  /* output the number of checkpoints. */
+  if (E->ckpt_count)
+    printf("\nCheckpoints:\n"
+           "  Written:  %16u\n",
+           E->ckpt_count);
+
   /* output the number of solutions. */
   printf("\nSolutions:\n"
          "  Accepted: %16u\n"
          "  Rejected: %16u\n",
          E->nsol, E->nrej);
+
+  /* output the minimum energy, which is only proven if the search
+   * ran to completion.
+   */
+  if (E->minimize && E->nsol)
+    printf("  Minimum:  %16.6le%s\n", E->energy_tol,
+           E->term ? " (unproven)" : "");
 }
 
 /* enum_execute(): enumerate all solutions from an iDMDGP graph/peptide
@@ -512,8 +1088,14 @@ static void enum_report (enum_t *E) {
  *  failure.
  */
 int enum_execute (enum_t *E) {
-  /* initialize the solution count and open the output system. */
+  /* initialize the solution count. */
   E->nsol = 0;
+
+  /* read the checkpoint to resume from. */
+  if (E->resume && !enum_checkpoint_read(E))
+    throw("unable to resume enumeration");
+
+  /* open the output system. */
   if (E->write_open && !E->write_open(E))
     throw("unable to open enumerator output");
 
@@ -521,6 +1103,37 @@ int enum_execute (enum_t *E) {
   if (!enum_threads_init(E))
     throw("unable to initialize enumerator threads");
 
+  /* start the wall clock. */
+  E->wall = enum_thread_clock();
+
+#if defined(__IBP_HAVE_PTHREAD)
+  /* block the interrupt and checkpoint signals in every thread created
+   * from here on, so that they are only ever handled by this thread.
+   */
+  sigset_t sigs, sigs_prev;
+  sigemptyset(&sigs);
+  sigaddset(&sigs, SIGINT);
+  sigaddset(&sigs, SIGUSR1);
+  sigaddset(&sigs, SIGALRM);
+  pthread_sigmask(SIG_BLOCK, &sigs, &sigs_prev);
+#endif
+
+  /* start the writer thread. */
+  if (!enum_write_start(E))
+    throw("unable to start enumerator output");
+
+  /* expand the breadth-first frontier of the tree. */
+  if (!enum_threads_frontier(E))
+    throw("unable to expand enumerator frontier");
+
+  /* run the distance tests that failed most often in the frontier first. */
+  if (E->frontier_depth)
+    enum_prune_sort_pairs(E);
+
+  /* restore the remaining work from the checkpoint. */
+  if (E->resume && !enum_checkpoint_restore(E))
+    throw("unable to resume enumeration");
+
 #if defined(__IBP_HAVE_PTHREAD)
 #if defined(__IBP_HAVE_CUDA)
 
@@ -549,6 +1162,9 @@ int enum_execute (enum_t *E) {
       throw("unable to create thread %u of %u", i + 1, E->nthreads);
   }
 
+  /* handle signals in this thread again. */
+  pthread_sigmask(SIG_SETMASK, &sigs_prev, NULL);
+
   /* wait for all threads to exit. */
   for (unsigned int i = 0; i < E->nthreads; i++)
     pthread_join(E->threads[i].thread, NULL);
@@ -563,6 +1179,26 @@ int enum_execute (enum_t *E) {
 
 #endif /* __IBP_HAVE_PTHREAD */
 
+  /* stop the wall clock. */
+  E->wall = enum_thread_clock() - E->wall;
+
+  /* wait for all solutions to be written. */
+  enum_write_stop(E);
+
+  /* write the minimum-energy solution, when minimizing. */
+  if (E->minimize && !enum_write_best(E))
+    raise("unable to write minimum-energy solution");
+
+  /* if the enumeration ran to completion, write a final checkpoint that
+   * holds no remaining work.
+   */
+  if (E->ckpt_fname && !E->term && !(E->nmax && E->nsol >= E->nmax))
+    enum_checkpoint_write(E);
+
+  /* write the nogoods learned so far, for reruns of the instance. */
+  if (E->nogood_fname)
+    enum_nogood_save(E);
+
   /* close the output system. */
   if (E->write_close)
     E->write_close(E);
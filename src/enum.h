@@ -6,10 +6,16 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <limits.h>
+#include <sys/uio.h>
 
 /* include the pthread header. */
 #ifdef __IBP_HAVE_PTHREAD
 #include <pthread.h>
+#include <sched.h>
 #endif
 
 /* include the peptide, graph and options headers. */
@@ -21,11 +27,111 @@
 #include "intervals.h"
 #include "vector.h"
 
+/* ENUM_CACHE_LINE: size of a cache line, in bytes. every enumerator
+ * thread is aligned to this size in order to avoid false sharing.
+ */
+#define ENUM_CACHE_LINE  64
+
+/* ENUM_WRITE_FRAMES: maximum number of frames in the output ring.
+ * ENUM_WRITE_BYTES: maximum number of bytes to allocate for the ring.
+ * ENUM_WRITE_BATCH: maximum number of frames written in one batch.
+ */
+#define ENUM_WRITE_FRAMES  1024
+#define ENUM_WRITE_BYTES   (1UL << 26)
+#define ENUM_WRITE_BATCH   256
+
+/* ENUM_FRONTIER_BYTES: maximum number of bytes to allocate for the
+ * breadth-first frontier of the enumeration tree.
+ */
+#define ENUM_FRONTIER_BYTES  (1UL << 28)
+
+/* ENUM_CHECKPOINT_MAGIC: identifier string at the start of every
+ * checkpoint file.
+ * ENUM_CHECKPOINT_VERSION: version number of the checkpoint format.
+ */
+#define ENUM_CHECKPOINT_MAGIC    "IBPCKPT"
+#define ENUM_CHECKPOINT_VERSION  3
+
+/* ENUM_REDUCE_STALE: sentinel omega count marking a reduced level whose
+ * discretized dihedral angles must be recomputed before use.
+ */
+#define ENUM_REDUCE_STALE  UINT_MAX
+
+/* ENUM_SYMMETRY_MAX: maximum number of symmetry levels, which bounds
+ * the number of mirror images of each solution.
+ */
+#define ENUM_SYMMETRY_MAX  63
+
+/* ENUM_RMSD_GROUPS: number of atom groups summed into the key vector of
+ * each solution in the rmsd diversity index.
+ * ENUM_RMSD_BUCKETS: number of hash table buckets in the index.
+ */
+#define ENUM_RMSD_GROUPS   3
+#define ENUM_RMSD_BUCKETS  (1U << 16)
+
+/* ENUM_KERNEL_*: kinds of tests held by a prune kernel, in the order in
+ * which they are run unless adaptive pruning reorders them.
+ */
+#define ENUM_KERNEL_PAIR   0
+#define ENUM_KERNEL_UPPER  1
+#define ENUM_KERNEL_QUAD   2
+#define ENUM_KERNEL_TERM   3
+#define ENUM_KERNEL_FUNC   4
+#define ENUM_KERNEL_KINDS  5
+
+/* ENUM_ADAPT_PERIOD: number of feasibility checks of a level between
+ * successive reorderings of its kernel under adaptive pruning.
+ * ENUM_ADAPT_SAMPLE: mask of the checks that are timed.
+ * ENUM_ADAPT_WARMUP: number of runs without a single prune after which
+ * a kind of test is deferred to the leaves.
+ */
+#define ENUM_ADAPT_PERIOD  (1U << 14)
+#define ENUM_ADAPT_SAMPLE  63
+#define ENUM_ADAPT_WARMUP  4096
+
+/* ENUM_NOGOOD_MAGIC: identifier string at the start of every nogood file.
+ * ENUM_NOGOOD_VERSION: version number of the nogood file format.
+ * ENUM_NOGOOD_SLOTS: number of entries in the nogood table.
+ * ENUM_NOGOOD_PROBE: maximum number of entries probed for each nogood.
+ * ENUM_NOGOOD_SPAN: maximum number of branching levels in a nogood.
+ */
+#define ENUM_NOGOOD_MAGIC    "IBPNOGD"
+#define ENUM_NOGOOD_VERSION  1
+#define ENUM_NOGOOD_SLOTS    (1U << 20)
+#define ENUM_NOGOOD_PROBE    16
+#define ENUM_NOGOOD_SPAN     8
+
+/* ENUM_TARGET_CLONES: attribute for compiling a kernel function once
+ * for each of several instruction sets, where the best version for the
+ * processor is selected at load time.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define ENUM_TARGET_CLONES \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define ENUM_TARGET_CLONES
+#endif
+
+/* enum_stat_inc(): increment a statistics counter held by the current
+ * enumerator thread. when statistics are disabled at build time, the
+ * counters are compiled out of the pruning functions entirely.
+ * enum_stat_add(): add a count to a statistics counter.
+ */
+#ifdef __IBP_HAVE_STATS
+#define enum_stat_inc(th, i)     ((th)->stats[i]++)
+#define enum_stat_add(th, i, n)  ((th)->stats[i] += (n))
+#else
+#define enum_stat_inc(th, i)     ((void) (th), (void) (i))
+#define enum_stat_add(th, i, n)  ((void) (th), (void) (i), (void) (n))
+#endif
+
 /* predeclare enum_t and enum_thread_t before defining them, in order
  * to allow the pruning function pointer specification below.
  */
 typedef struct _enum_t enum_t;
 typedef struct _enum_thread_t enum_thread_t;
+typedef struct _enum_frame_t enum_frame_t;
+typedef struct _enum_kernel_t enum_kernel_t;
 
 /* enum_prune_init_fn: function pointer specification for 
  * initializing an enumerator pruning device.
@@ -67,6 +173,23 @@ typedef void (*enum_prune_report_fn) (struct _enum_t *E,
                                       unsigned int lev,
                                       void *data);
 
+/* enum_prune_compile_fn: function pointer specification for merging
+ * a single pruning closure into the prune kernel of its level.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to access.
+ *  @lev: level in the graph repetition order of the closure.
+ *  @data: optional payload data pointer.
+ *  @K: pointer to the prune kernel to modify.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+typedef int (*enum_prune_compile_fn) (struct _enum_t *E,
+                                      unsigned int lev,
+                                      void *data,
+                                      struct _enum_kernel_t *K);
+
 /* enum_write_open_fn: function pointer specification for initializing
  * an enumerator data output system.
  *
@@ -78,18 +201,36 @@ typedef void (*enum_prune_report_fn) (struct _enum_t *E,
  */
 typedef int (*enum_write_open_fn) (struct _enum_t *E);
 
-/* enum_write_data_fn: function pointer specification for writing
- * solution data through an enumerator data output system.
+/* enum_write_pack_fn: function pointer specification for packing a
+ * solution held by an enumerator thread into an output frame.
  *
  * arguments:
  *  @E: pointer to the enumerator data structure to utilize.
  *  @th: pointer to the enumerator thread to access.
+ *  @frame: pointer to the output frame to fill.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+typedef int (*enum_write_pack_fn) (struct _enum_t *E,
+                                   struct _enum_thread_t *th,
+                                   struct _enum_frame_t *frame);
+
+/* enum_write_data_fn: function pointer specification for writing
+ * a batch of packed output frames through an enumerator data output
+ * system.
+ *
+ * arguments:
+ *  @E: pointer to the enumerator data structure to utilize.
+ *  @frames: array of pointers to the packed frames to write.
+ *  @n: number of frames in the batch.
  *
  * returns:
  *  integer indicating whether (1) or not (0) the operation succeeded.
  */
 typedef int (*enum_write_data_fn) (struct _enum_t *E,
-                                   struct _enum_thread_t *th);
+                                   struct _enum_frame_t **frames,
+                                   unsigned int n);
 
 /* enum_write_close_fn: function pointer specification for closing
  * an enumerator data output system.
@@ -109,22 +250,59 @@ typedef struct {
    *  @start: start index of the thread at the current level.
    *  @end: end index of the thread at the current level.
    *  @nb: number of nodes/branches at the current level.
+   *  @sym: whether or not the level only branches on sigma=+1.
    */
-  unsigned int idx, start, end, nb;
+  unsigned int idx, start, end, nb, sym;
 
   /* coordinate variables:
    *  @pos: position of the node for the candidate solution.
-   *  @prev: previous solution position of the node.
    */
-  vector_t pos, prev;
+  vector_t pos;
+
+  /* variables related to the local frame of the parent, which are shared
+   * by all siblings at the current level:
+   *  @p1, @p2, @p3: anchor vectors, such that each sibling is embedded
+   *                 at p1 + cos(omega) p2 + sin(omega) p3, relative to
+   *                 the position of the preceding atom.
+   *  @k0, @k1: coefficients, such that cos(omega) = k0 - k1 d03^2 at
+   *            levels that branch on a d(i,i-3) distance.
+   *  @framed: whether or not the frame belongs to the current parent.
+   */
+  vector_t p1, p2, p3;
+  double k0, k1;
+  unsigned int framed;
 
   /* variables related to dihedral interval reduction:
    *  @isa, @isb: interval sets used during intersection operations.
    *  @isk: interval arcs from the k-th vertex adjacent to us.
-   *  @omega: array of discretized dihedral angle values.
+   *  @omega: array of discretized dihedral angle values, or NULL if the
+   *          level does not branch on reduced intervals.
+   *  @cw, @sw: arrays of cosines and sines of the values in @omega.
+   *  @n_omega: number of values in @omega, or ENUM_REDUCE_STALE.
    */
   intervals_t *isa, *isb, *isk;
-  double *omega;
+  double *omega, *cw, *sw;
+  unsigned int n_omega;
+
+  /* variables related to batched sibling evaluation:
+   *  @bx, @by, @bz: arrays of sibling positions relative to the position
+   *                 of the preceding atom, or NULL if the level is not
+   *                 evaluated in batches.
+   *  @alive: array of flags marking the siblings that survived pruning.
+   *  @batched: whether or not the batch belongs to the current parent.
+   */
+  double *bx, *by, *bz;
+  unsigned char *alive;
+  unsigned int batched;
+
+  /* variables related to backjumping:
+   *  @dead: array of flags marking the siblings that are infeasible
+   *         under every parent, or NULL if the level does not learn.
+   *  @conf: shallowest level whose branch the failures seen under the
+   *         current parent depend on.
+   */
+  unsigned char *dead;
+  unsigned int conf;
 
   /* auxiliary variables:
    *  @energy: current energy at the node.
@@ -133,11 +311,184 @@ typedef struct {
 }
 enum_thread_node_t;
 
+/* enum_plan_t: data structure for holding the quantities required to
+ * embed the atom at a single level of the tree that do not depend on
+ * the positions of the preceding atoms. plans are computed once for
+ * all threads, so that embedding never queries the graph.
+ */
+typedef struct {
+  /* @d13, @d23: exact distances from the two nearest preceding atoms.
+   * @ct, @st: cosine and sine of the angle at the nearest preceding atom.
+   */
+  double d13, d23, ct, st;
+
+  /* @dihed: whether or not the level branches on a dihedral.
+   * @nb: number of branches at the level.
+   * @w: array of interpolated d(i,i-3) edges or dihedrals (in radians)
+   *     of each branch index.
+   * @sig: array of signs of sin(omega) of each branch index.
+   * @cw, @sw: arrays of cosines and sines of omega of each branch index,
+   *           at levels that branch on a dihedral.
+   */
+  unsigned int dihed, nb;
+  double *w, *sig, *cw, *sw;
+}
+enum_plan_t;
+
+/* energy term types held by prune kernels, in the order in which their
+ * terms are summed, cheapest first:
+ *  @ENERGY_CONTACT: close contact (vdw repulsion).
+ *  @ENERGY_BOND: harmonic bonded distance.
+ *  @ENERGY_DISTANCE: log-harmonic non-bonded distance.
+ *  @ENERGY_ANGLE: harmonic two-bond angle, in the cosine of the angle.
+ *  @ENERGY_DIHEDRAL: periodic dihedral angle, in the cosine and sine
+ *                    of the angle.
+ *  @ENERGY_TYPES: number of energy term types.
+ */
+#define ENERGY_CONTACT  0
+#define ENERGY_BOND     1
+#define ENERGY_DISTANCE 2
+#define ENERGY_ANGLE    3
+#define ENERGY_DIHEDRAL 4
+#define ENERGY_TYPES    5
+
+/* ENERGY_CHUNK: number of energy terms of a single type summed between
+ * successive checks of the partial energy of a node.
+ */
+#define ENERGY_CHUNK    16
+
+/* enum_kernel_pair_t: distance test between the atom at the current
+ * level of the tree and the atom at an earlier level.
+ */
+typedef struct {
+  /* @lev: level of the earlier atom.
+   * @stat: index of the test counter. the prune counter is @stat + 1.
+   * @conf: shallowest level whose branch the outcome of the test
+   *        depends on.
+   * @lo2, @hi2: squared bounds on the distance, including tolerances.
+   */
+  unsigned int lev, stat, conf;
+  double lo2, hi2;
+}
+enum_kernel_pair_t;
+
+/* enum_kernel_quad_t: dihedral angle test between the atoms at four
+ * levels of the tree, one of which is the current level.
+ */
+typedef struct {
+  /* @lev: levels of the four atoms.
+   * @stat: index of the test counter. the prune counter is @stat + 1.
+   * @conf: shallowest level whose branch the outcome of the test
+   *        depends on.
+   * @l, @u: bounds on the dihedral angle, including tolerances.
+   */
+  unsigned int lev[4], stat, conf;
+  double l, u;
+}
+enum_kernel_quad_t;
+
+/* enum_kernel_term_t: energy terms of a single type between the atoms
+ * at up to four levels of the tree, in structure-of-arrays layout. the
+ * force field parameters of each term are folded into the coefficients
+ * of a polynomial in its observed value:
+ *
+ *  contact:   c0 * (c1 / d^2)^3,        with d the distance.
+ *  bond:      c0 * (d - c1)^2.
+ *  distance:  c0 * log(c1 * d^2)^2.
+ *  angle:     c0 + c1 * x + c2 * x^2,   with x the cosine of the angle.
+ *  dihedral:  c0 + c1 * x + c2 * y,     with x, y the cosine and sine.
+ */
+typedef struct {
+  /* @n: number of terms.
+   * @stat: index of the test counter of the terms, counting the nodes
+   *        at which they were summed. the prune counter is @stat + 1.
+   * @lev: arrays of levels of the atoms of each term.
+   * @c: arrays of coefficients of each term.
+   */
+  unsigned int n, stat;
+  unsigned int *lev[4];
+  double *c[3];
+}
+enum_kernel_term_t;
+
+/* enum_adapt_t: measurements and decisions of adaptive pruning for the
+ * prune kernel of a single level, held by each thread.
+ */
+typedef struct {
+  /* @order: kinds of tests of the kernel, in the order they are run.
+   * @n_order: number of kinds in @order.
+   * @deferred: bit mask of the kinds that are only run at the leaves.
+   * @calls: number of feasibility checks of the level.
+   */
+  unsigned char order[ENUM_KERNEL_KINDS];
+  unsigned int n_order, deferred, calls;
+
+  /* @runs, @prunes: numbers of runs and prunes of each kind.
+   * @samples: number of timed runs of each kind.
+   * @ns: total duration of the timed runs of each kind, in nanoseconds.
+   */
+  unsigned long runs[ENUM_KERNEL_KINDS], prunes[ENUM_KERNEL_KINDS];
+  unsigned long samples[ENUM_KERNEL_KINDS];
+  double ns[ENUM_KERNEL_KINDS];
+}
+enum_adapt_t;
+
+/* enum_kernel_t: prune kernel of a single level of the tree. the kernel
+ * holds all pruning closures registered at the level, merged into flat
+ * arrays of tests of each kind, so that a node is checked without any
+ * indirect calls or graph queries.
+ */
+struct _enum_kernel_t {
+  /* @pair: array of two-sided distance tests, which are skipped for
+   *        nodes that were already checked in a batch.
+   * @upper: array of one-sided (upper bound) distance tests. consecutive
+   *         tests against the same earlier level share one distance.
+   * @n_pair, @n_upper: sizes of @pair and @upper.
+   */
+  enum_kernel_pair_t *pair, *upper;
+  unsigned int n_pair, n_upper;
+
+  /* @quad: array of dihedral angle tests.
+   * @term: energy terms of each type.
+   * @n_quad: size of @quad.
+   * @n_term: total number of energy terms of all types.
+   */
+  enum_kernel_quad_t *quad;
+  enum_kernel_term_t term[ENERGY_TYPES];
+  unsigned int n_quad, n_term;
+
+  /* @func, @data: closures that could not be merged into the kernel.
+   * @n_func: number of such closures.
+   */
+  enum_prune_test_fn *func;
+  void **data;
+  unsigned int n_func;
+};
+
+/* enum_frame_t: data structure for holding a single packed solution
+ * in the output ring of an enumerator. each frame is aligned to cache
+ * lines, so that threads filling neighbouring frames do not contend.
+ */
+struct __attribute__((aligned(ENUM_CACHE_LINE))) _enum_frame_t {
+  /* @seq: sequence number that publishes the frame to the writer.
+   * @isol: index of the solution held in the frame.
+   * @sz: number of packed bytes in the frame.
+   * @buf: packed frame data.
+   */
+  unsigned long seq;
+  unsigned int isol, sz;
+  char *buf;
+};
+
 /* enum_thread_t: data structure for holding the traversal state of a
  * single thread of an iDMDGP solution enumerator, which covers a
  * well-defined iDMDGP sub-tree.
+ *
+ * the structure is aligned to cache lines, and the variables written
+ * by other threads during scheduling are kept apart from the variables
+ * that the thread itself updates during traversal.
  */
-struct _enum_thread_t {
+struct __attribute__((aligned(ENUM_CACHE_LINE))) _enum_thread_t {
   /* @thread: system-level thread information.
    * @E: pointer back to the master enumerator.
    */
@@ -152,6 +503,81 @@ struct _enum_thread_t {
    */
   enum_thread_node_t *state;
   unsigned int level;
+
+  /* @stats: array of pruning statistics counters of the thread.
+   * @mirror: array of solution positions saved while the mirror images
+   *          of the solution are output.
+   */
+  unsigned long *stats;
+  vector_t *mirror;
+
+  /* @batch: storage of the sibling batches of every level. */
+  double *batch;
+
+  /* @adapt: array of adaptive pruning states of every level.
+   * @n_deferred: number of kinds of tests deferred to the leaves.
+   */
+  enum_adapt_t *adapt;
+  unsigned int n_deferred;
+
+  /* @dead: storage of the dead sibling flags of every level.
+   * @culprit: shallowest level whose branch the last failed test
+   *           depends on.
+   * @learned: number of siblings found to be infeasible under every
+   *           parent.
+   * @skipped: number of nodes skipped as dead siblings.
+   * @avoided: number of nodes skipped as completing a nogood.
+   */
+  unsigned char *dead;
+  unsigned int culprit;
+  unsigned long learned, skipped, avoided;
+
+  /* @rmsd_pos: array of packed positions of the current solution.
+   * @rmsd_prof: array of the radial profile of the current solution,
+   *             followed by its key vector.
+   */
+  vector_t *rmsd_pos;
+  double *rmsd_prof;
+
+  /* @clash_head: array of the deepest level held in each bucket of the
+   *              clash grid of the thread, or UINT_MAX if empty.
+   * @clash_next: array of the next shallower level in the same bucket.
+   * @clash_cell: array of the bucket holding each level.
+   * @clash_mark: array of marks of the levels excluded from the current
+   *              clash check.
+   * @clash_top: number of leading levels held in the clash grid.
+   * @clash_stamp: mark of the current clash check.
+   */
+  unsigned int *clash_head, *clash_next, *clash_cell, *clash_mark;
+  unsigned int clash_top, clash_stamp;
+
+  /* @best: packed frame of the lowest-energy solution found by the
+   *        thread, when minimizing.
+   * @best_energy: energy of the solution held in @best.
+   */
+  enum_frame_t best;
+  double best_energy;
+
+  /* work-stealing scheduler variables:
+   *  @id: index of the thread in the enumerator thread array.
+   *  @req: index of a thread requesting work from us, or -1.
+   *  @victim: index of the thread we requested work from, or -1.
+   *  @working: whether or not the thread holds a range of the tree.
+   *  @granted: whether or not a work request was granted.
+   */
+  unsigned int id __attribute__((aligned(ENUM_CACHE_LINE)));
+  int req, victim;
+  unsigned int working, granted;
+
+  /* utilisation statistics:
+   *  @nodes: number of tree nodes embedded by the thread.
+   *  @steals: number of sub-trees received from other threads.
+   *  @busy: time (in seconds) spent traversing the tree.
+   *  @stall: time (in seconds) spent waiting for free output frames.
+   */
+  unsigned long nodes __attribute__((aligned(ENUM_CACHE_LINE)));
+  unsigned int steals;
+  double busy, stall;
 };
 
 /* enum_t: structure for holding all state information required for the
@@ -173,26 +599,46 @@ struct _enum_t {
   graph_t *G;
 
   /* @writeord: atom ordering to use when writing data.
-   * @write_mutex: mutual exclusion for multi-threaded data writes.
    * @write_open: function pointer for opening the output system.
-   * @write_data: function pointer for writing output data.
+   * @write_pack: function pointer for packing output frames.
+   * @write_data: function pointer for writing output frames.
    * @write_close: function pointer for closing the output system.
    */
   unsigned int *writeord;
-#ifdef __IBP_HAVE_PTHREAD
-  pthread_mutex_t write_mutex;
-#endif
   enum_write_open_fn write_open;
+  enum_write_pack_fn write_pack;
   enum_write_data_fn write_data;
   enum_write_close_fn write_close;
 
+  /* asynchronous output variables:
+   *  @writer: unique thread for writing packed output frames.
+   *  @frames: ring of preallocated output frames.
+   *  @nframes: number of frames in the ring, a power of two.
+   *  @frame_bytes: maximum number of packed bytes in each frame.
+   *  @frame_head: sequence number of the next frame to fill.
+   *  @write_done: flag indicating that no more frames will be filled.
+   *  @write_frames: number of frames written by the writer.
+   *  @write_batches: number of batches written by the writer.
+   *  @write_depth: sum of the ring depths seen before each batch.
+   *  @write_maxdepth: largest ring depth seen before any batch.
+   */
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_t writer;
+#endif
+  enum_frame_t *frames;
+  unsigned int nframes, frame_bytes;
+  unsigned long frame_head;
+  unsigned int write_done;
+  unsigned long write_frames, write_batches, write_depth;
+  unsigned int write_maxdepth;
+
   /* @term: flag to terminate the enumeration.
    */
   unsigned int term;
 
   /* @logW: logarithm of the number of leaves in the tree.
-   * @nsol: number of solutions accepted during traversal.
-   * @nrej: number of solutions rejected during traversal.
+   * @nsol: number of solutions accepted during traversal (atomic).
+   * @nrej: number of solutions rejected during traversal (atomic).
    * @nmax: maximum number of solutions to compute.
    * @fname: file/directory name string for storing outputs.
    * @fd: file descriptor for DCD-formatted output.
@@ -208,13 +654,66 @@ struct _enum_t {
   unsigned int nbmax;
   double eps;
 
+  /* @reduce: whether or not to branch on reduced dihedral intervals.
+   * @n_reduce: number of levels that branch on reduced intervals.
+   * @batch: whether or not to embed and prune siblings in batches.
+   * @adaptive: whether or not to reorder and defer prune tests based
+   *            on their measured cost and benefit.
+   * @backjump: whether or not to learn and skip dead siblings.
+   */
+  unsigned int reduce, n_reduce, batch, adaptive, backjump;
+
+  /* nogood cache variables:
+   *  @nogood: whether or not to learn and skip nogoods.
+   *  @nogood_fname: filename string of the nogood file, or NULL.
+   *  @nogood_key: (2d) array of the two hashes of each table entry.
+   *  @nogood_spans: array of bit masks of the nogood lengths stored at
+   *                 each level, where bit k marks nogoods holding k + 1
+   *                 branching levels.
+   *  @nogood_reach: array of the shallowest level that a nogood ending
+   *                 at each level may start from.
+   *  @nogood_sig: signature of the instance that the nogoods hold for.
+   *  @nogood_n: number of stored nogoods (atomic).
+   *  @nogood_lost: number of nogoods dropped from full probes (atomic).
+   *  @nogood_loaded: number of nogoods read from the nogood file.
+   */
+  unsigned int nogood;
+  char *nogood_fname;
+  unsigned long *nogood_key;
+  unsigned int *nogood_spans, *nogood_reach;
+  unsigned long nogood_sig, nogood_n, nogood_lost, nogood_loaded;
+
+  /* partial reflection symmetry variables:
+   *  @symmetry: whether or not to exploit partial reflection symmetry.
+   *  @chiral: whether or not any pruning method depends on chirality.
+   *  @sym_lev: array of symmetry levels, in increasing order.
+   *  @n_sym: number of symmetry levels.
+   */
+  unsigned int symmetry, chiral;
+  unsigned int *sym_lev, n_sym;
+
+  /* @plan: array of embedding plans of each level of the tree.
+   * @plan_w: shared storage of the branch schedules in @plan.
+   */
+  enum_plan_t *plan;
+  double *plan_w;
+
   /* @prune: (2d) array of pruning test function pointers.
    * @prune_sz: sizes of each inner array in @prune.
    * @prune_data: array of pruning data payloads.
+   * @nstats: number of statistics counters held by each thread.
+   * @prune_mask: bit mask of the registered pruning methods, where bit
+   *              i marks the i-th method of the method mapping.
    */
   enum_prune_test_fn **prune;
   unsigned int *prune_sz;
   void ***prune_data;
+  unsigned int nstats, prune_mask;
+
+  /* @kern: array of prune kernels compiled from the closures held in
+   *        @prune and @prune_data, one for each level of the tree.
+   */
+  enum_kernel_t *kern;
 
   /* @threads: array of enumerator threads.
    * @nthreads: number of enumerator threads.
@@ -222,6 +721,92 @@ struct _enum_t {
   enum_thread_t *threads;
   unsigned int nthreads;
 
+  /* processor affinity variables:
+   *  @affinity: whether or not to pin each thread to a processor.
+   *  @cpus: array of indices of the processors available to us.
+   *  @ncpus: number of available processors.
+   */
+  unsigned int affinity;
+  unsigned int *cpus, ncpus;
+
+  /* checkpoint variables:
+   *  @ckpt_fname: filename string of the checkpoint file, or NULL.
+   *  @ckpt_req: flag requesting a checkpoint at the next safe point.
+   *  @ckpt_stop: flag to terminate the enumeration after a checkpoint.
+   *  @ckpt_parked: number of threads waiting at safe points.
+   *  @ckpt_count: number of checkpoints written.
+   */
+  char *ckpt_fname;
+  unsigned int ckpt_req, ckpt_stop;
+  unsigned int ckpt_parked, ckpt_count;
+
+  /* resumption variables, read from the checkpoint file:
+   *  @resume: whether or not to resume from the checkpoint file.
+   *  @resume_sz: number of saved ranges of the tree.
+   *  @resume_next: index of the next unclaimed saved range.
+   *  @resume_level: array of levels at which each saved range resumes.
+   *  @resume_state: (2d) array of node states of each saved range.
+   *  @resume_stats: array of merged pruning statistics counters.
+   *  @resume_slice: array of state indices of the first and the last
+   *                 leaves of the checkpointed slice of the tree.
+   *  @resume_frontier: index of the next unclaimed frontier prefix.
+   *  @resume_depth: number of levels fixed by each frontier prefix.
+   *  @resume_prefixes: number of feasible prefixes in the frontier.
+   *  @resume_tol: energy tolerance at the checkpoint.
+   *  @resume_offset: size (in bytes) of the output file.
+   */
+  unsigned int resume, resume_sz, resume_next;
+  unsigned int *resume_level;
+  enum_thread_node_t *resume_state;
+  unsigned long *resume_stats;
+  unsigned int *resume_slice;
+  unsigned int resume_frontier, resume_depth, resume_prefixes;
+  double resume_tol;
+  long resume_offset;
+
+  /* tree slicing variables:
+   *  @part_k: index [1..N] of the tree partition to enumerate.
+   *  @part_n: number of partitions of the tree.
+   *  @prefix: array of branch indices fixing the shallowest levels.
+   *  @n_prefix: number of branch indices in @prefix.
+   *  @slice_lo: array of state indices of the first leaf of the slice.
+   *  @slice_hi: array of state indices of the last leaf of the slice.
+   *  @logS: logarithm of the number of leaves in the slice.
+   */
+  unsigned int part_k, part_n;
+  unsigned int *prefix, n_prefix;
+  unsigned int *slice_lo, *slice_hi;
+  double logS;
+
+  /* work-stealing scheduler variables:
+   *  @sched_mutex: mutual exclusion for work requests and grants.
+   *  @sched_cond: condition signalled on every scheduler event.
+   *  @nidle: number of threads currently waiting for work.
+   *  @done: flag indicating that no work remains in the tree.
+   *  @wall: wall-clock time (in seconds) spent enumerating.
+   */
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_mutex_t sched_mutex;
+  pthread_cond_t sched_cond;
+#endif
+  unsigned int nidle, done;
+  double wall;
+
+  /* breadth-first frontier variables:
+   *  @frontier_lev: number of levels requested for the frontier.
+   *  @frontier_depth: number of levels fixed by each frontier prefix.
+   *  @frontier_sz: number of feasible prefixes in the frontier.
+   *  @frontier_next: index of the next unclaimed frontier prefix.
+   *  @frontier_idx: (2d) array of state indices of each prefix.
+   *  @frontier_pos: (2d) array of atom positions of each prefix.
+   *  @frontier_energy: (2d) array of node energies of each prefix.
+   */
+  unsigned int frontier_lev, frontier_depth;
+  unsigned int frontier_sz, frontier_next;
+  unsigned int *frontier_idx;
+  vector_t *frontier_pos;
+  double *frontier_energy;
+
   /* @timer: unique thread for computing timing information.
    */
 #ifdef __IBP_HAVE_PTHREAD
@@ -232,8 +817,50 @@ struct _enum_t {
    *  @ddf_tol: error tolerance for ddf bounds checking.
    *  @rmsd_tol: minimum acceptable rmsd between solutions.
    *  @energy_tol: maximum acceptable energy for pruning.
+   *  @energy_lb: array of lower bounds on the energy of the terms of
+   *              all levels after each level, or NULL if energetic
+   *              pruning is disabled.
+   *  @minimize: whether or not to search for the minimum-energy
+   *             solution instead of enumerating solutions.
+   *  @path_sample: maximum number of path prune tests per level that
+   *                have their own statistics counters, or zero for all.
    */
   double ddf_tol, rmsd_tol, energy_tol;
+  double *energy_lb;
+  unsigned int minimize, path_sample;
+
+  /* clash pruning variables:
+   *  @clash_rad: array of van der waals radii of the atom at each level,
+   *              or NULL if clash pruning is disabled.
+   *  @clash_grid: edge length of the cells of the clash grids, which
+   *               is the largest sum of two radii.
+   *  @clash_mask: number of buckets in each clash grid, minus one.
+   */
+  double *clash_rad, clash_grid;
+  unsigned int clash_mask;
+
+  /* rmsd diversity index variables:
+   *  @rmsd_lock: readers-writer lock guarding the index.
+   *  @rmsd_grid: grid spacing of the key vectors.
+   *  @rmsd_head: array of the newest solution in each hash bucket.
+   *  @rmsd_next: array of the next older solution in the same bucket.
+   *  @rmsd_key: (2d) array of key vectors of each stored solution.
+   *  @rmsd_prof: (2d) array of radial profiles of each stored solution.
+   *  @rmsd_pos: (2d) array of coordinates of each stored solution.
+   *  @rmsd_n: number of stored solutions.
+   *  @rmsd_cap: capacity of the stored solution arrays.
+   *  @rmsd_lookups: number of candidates checked against the index.
+   *  @rmsd_compared: number of full rmsd calculations.
+   */
+#ifdef __IBP_HAVE_PTHREAD
+  pthread_rwlock_t rmsd_lock;
+#endif
+  double rmsd_grid;
+  unsigned int *rmsd_head, *rmsd_next;
+  double *rmsd_key;
+  float *rmsd_prof, *rmsd_pos;
+  unsigned int rmsd_n, rmsd_cap;
+  unsigned long rmsd_lookups, rmsd_compared;
 };
 
 /* function declarations (enum.c): */
@@ -40,15 +40,34 @@
 \n\
  Enumeration options:\n\
   -m, --method ML         Pruning method(s) to use                   [none]\n\
+      --mode MODE         Search mode: enumerate or minimize    [enumerate]\n\
   -b, --branch-max NB     Maximum number of branches per node          [20]\n\
   -e, --branch-eps EPS    Minimum interval discretization            [0.05]\n\
+      --reduce            Flag to branch on reduced intervals         [off]\n\
+      --symmetry          Flag to mirror solutions at symmetries      [off]\n\
+      --batch             Flag to embed and prune siblings at once    [off]\n\
+      --adaptive          Flag to reorder prune tests by their yield  [off]\n\
+      --backjump          Flag to learn and skip dead siblings        [off]\n\
+      --nogood            Flag to learn and skip nogood branches      [off]\n\
+      --nogood-file FNG   Nogood filename, implies --nogood          [none]\n\
   -l, --limit NSOL        Maximum number of solutions                 [off]\n\
       --vdw-scale VF      Atomic radius scaling factor                [0.6]\n\
       --ddf-tol TOL       DDF error tolerance                       [0.001]\n\
+      --path-sample NS    Path tests counted per level (0: all)         [0]\n\
 \n\
  Parallel execution options:\n\
   -g, --gpu               Flag to execute on the GPU                  [off]\n\
-  -t, --threads NT        Number of threads to execute                  [1]\n\
+  -t, --threads NT        Number of threads to execute (0: auto)        [1]\n\
+      --affinity          Flag to pin threads to processors           [off]\n\
+      --frontier K        Tree levels to expand breadth-first           [0]\n\
+      --partition K/N     Enumerate the K-th of N tree partitions     [1/1]\n\
+      --prefix BL         Branch indices fixing the first levels     [none]\n\
+\n\
+ Checkpoint options:\n\
+      --checkpoint FCK    Checkpoint filename                        [none]\n\
+      --checkpoint-interval SEC\n\
+                          Seconds between checkpoints (0: off)     [3600]\n\
+      --resume            Flag to resume from the checkpoint          [off]\n\
 \n\
  The ibp-ng utility enumerates all feasible solutions to a given Interval\n\
  Discretizable Molecular Distance Geometry Problem (iDMDGP) instance, or\n\
@@ -81,11 +100,36 @@ enum_t *E = NULL;
  *  @sig: code of the caught signal.
  */
 void main_handler (int sig) {
+  /* when checkpointing, request a final checkpoint before terminating.
+   * a second interrupt terminates without waiting for the checkpoint.
+   */
+  if (E->ckpt_fname && !E->ckpt_stop) {
+    info("writing a checkpoint before a clean getaway...");
+    E->ckpt_stop = 1;
+    E->ckpt_req = 1;
+    return;
+  }
+
   /* write an informational message and raise the termination flag. */
   info("attempting a clean getaway...");
   E->term = 1;
 }
 
+/* main_checkpoint(): handle checkpoint signals by requesting that the
+ * running enumeration writes a checkpoint at its next safe point.
+ *
+ * arguments:
+ *  @sig: code of the caught signal.
+ */
+void main_checkpoint (int sig) {
+  /* raise the checkpoint request flag. */
+  E->ckpt_req = 1;
+
+  /* schedule the next periodic checkpoint. */
+  if (sig == SIGALRM)
+    alarm(opts->ckpt_interval);
+}
+
 /* main(): application entry point.
  *
  * arguments:
@@ -211,6 +255,13 @@ int main (int argc, char **argv) {
   /* catch interrupt signals. */
   signal(SIGINT, main_handler);
 
+  /* catch checkpoint signals, and schedule periodic checkpoints. */
+  if (opts->fname_ckpt) {
+    signal(SIGUSR1, main_checkpoint);
+    signal(SIGALRM, main_checkpoint);
+    alarm(opts->ckpt_interval);
+  }
+
   /* enumerate all solutions from the graph. */
   if (!enum_execute(E))
     die("failed to enumerate graph solutions");
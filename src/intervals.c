@@ -194,6 +194,7 @@ int intervals_intersect (intervals_t *Ia, intervals_t *Ib, intervals_t *Ic) {
 /* intervals_grid(): uniformly discretize an interval set with a specified
  * number of points, where the points are equally spaced on the interval
  * formed by concatenating all intervals in the set together end-to-end.
+ * a single requested point is placed at the middle of that interval.
  *
  * when the interval set consists of a union of degenerate intervals
  * (i.e. exact values), the resulting sample set will consist of
@@ -212,10 +213,10 @@ int intervals_intersect (intervals_t *Ia, intervals_t *Ib, intervals_t *Ic) {
  *            - the final number of sampled values.
  */
 void intervals_grid (intervals_t *I, double *samp, unsigned int *n_samp) {
-  /* the final number of sampled points will be the lesser of the
-   * number of available and requested point counts.
+  /* the final number of sampled points will be the requested number,
+   * unless the interval set is empty or degenerate.
    */
-  const unsigned int ns = (I->size < *n_samp ? I->size : *n_samp);
+  unsigned int ns = (I->size ? *n_samp : 0);
 
   /* immediately finish if the interval set is empty. */
   if (ns == 0)
@@ -232,37 +233,38 @@ void intervals_grid (intervals_t *I, double *samp, unsigned int *n_samp) {
      * into the output samples array, until we have exhausted
      * either the interval set or the array size.
      */
+    ns = (I->size < ns ? I->size : ns);
     for (unsigned int i = 0; i < ns; i++)
       samp[i] = I->start[i];
   }
   else {
-    /* compute the spacing between sampled points. */
-    const double h = len / (ns - 1);
+    /* compute the spacing between sampled points, and the position
+     * of a single point at the middle of the concatenation.
+     */
+    const double h = (ns > 1 ? len / (ns - 1) : 0.0);
+    const double mid = 0.5 * len;
 
-    /* initialize the first sampled point and zero the length. */
-    samp[0] = I->start[0];
+    /* loop over the sampled points. */
     len = 0.0;
-
-    /* loop until all sampled points are computed. */
-    for (unsigned int i = 0, j = 0; i < ns - 1; /**/) {
-      /* compute the distance from the last sampled point to the end
-       * of the currently indexed interval.
+    for (unsigned int i = 0, j = 0; i < ns; i++) {
+      /* compute the position of the point along the concatenation. */
+      const double s = (ns > 1 ? h * i : mid);
+
+      /* move to the interval that holds the point, where @len is the
+       * combined length of all intervals before it. a point that lies
+       * on the boundary between two intervals, to within round-off,
+       * stays at the end of the earlier one, so that sets of intervals
+       * with equal lengths are sampled the same way wherever they lie.
        */
-      const double start = (I->start[j] > samp[i] ? I->start[j] : samp[i]);
-      const double end = I->end[j];
-      const double dl = end - start;
-
-      /* check if the distance is sufficient. */
-      if (len + dl >= (h - 1.0e-8)) {
-        /* yes. add the new sampled point and zero the length. */
-        samp[++i] = start + (h - len);
-        len = 0.0;
-      }
-      else {
-        /* not yet. accumulate the length and move to the next interval. */
-        len += dl;
+      while (j + 1 < I->size &&
+             len + (I->end[j] - I->start[j]) < s - 1.0e-8) {
+        len += I->end[j] - I->start[j];
         j++;
       }
+
+      /* store the point, without passing the end of its interval. */
+      const double x = I->start[j] + (s - len);
+      samp[i] = (x < I->end[j] ? x : I->end[j]);
     }
   }
 
@@ -29,6 +29,22 @@
 #define OPTS_S_RMSD       ('z'+3)
 #define OPTS_S_REFINE     ('z'+4)
 #define OPTS_S_COMPLETE   ('z'+5)
+#define OPTS_S_FRONTIER   ('z'+6)
+#define OPTS_S_AFFINITY   ('z'+7)
+#define OPTS_S_CHECKPOINT ('z'+8)
+#define OPTS_S_CKPT_INT   ('z'+9)
+#define OPTS_S_RESUME     ('z'+10)
+#define OPTS_S_PARTITION  ('z'+11)
+#define OPTS_S_PREFIX     ('z'+12)
+#define OPTS_S_REDUCE     ('z'+13)
+#define OPTS_S_SYMMETRY   ('z'+14)
+#define OPTS_S_BATCH      ('z'+15)
+#define OPTS_S_ADAPTIVE   ('z'+16)
+#define OPTS_S_BACKJUMP   ('z'+17)
+#define OPTS_S_NOGOOD     ('z'+18)
+#define OPTS_S_NOGOOD_FN  ('z'+19)
+#define OPTS_S_PATH_SAMP  ('z'+20)
+#define OPTS_S_MODE       ('z'+21)
 
 /* define all accepted long options.
  */
@@ -57,6 +73,22 @@
 #define OPTS_L_RMSD       "rmsd"
 #define OPTS_L_REFINE     "refine"
 #define OPTS_L_COMPLETE   "complete"
+#define OPTS_L_FRONTIER   "frontier"
+#define OPTS_L_AFFINITY   "affinity"
+#define OPTS_L_CHECKPOINT "checkpoint"
+#define OPTS_L_CKPT_INT   "checkpoint-interval"
+#define OPTS_L_RESUME     "resume"
+#define OPTS_L_PARTITION  "partition"
+#define OPTS_L_PREFIX     "prefix"
+#define OPTS_L_REDUCE     "reduce"
+#define OPTS_L_SYMMETRY   "symmetry"
+#define OPTS_L_BATCH      "batch"
+#define OPTS_L_ADAPTIVE   "adaptive"
+#define OPTS_L_BACKJUMP   "backjump"
+#define OPTS_L_NOGOOD     "nogood"
+#define OPTS_L_NOGOOD_FN  "nogood-file"
+#define OPTS_L_PATH_SAMP  "path-sample"
+#define OPTS_L_MODE       "mode"
 
 /* opts_config_t: option definition structure for informing opts_next()
  * about all supported command line options that the user may specify.
@@ -102,6 +134,22 @@ static const opts_config_t conf[] = {
   { OPTS_L_RMSD,       OPTS_S_RMSD,       1 },
   { OPTS_L_REFINE,     OPTS_S_REFINE,     0 },
   { OPTS_L_COMPLETE,   OPTS_S_COMPLETE,   0 },
+  { OPTS_L_FRONTIER,   OPTS_S_FRONTIER,   1 },
+  { OPTS_L_AFFINITY,   OPTS_S_AFFINITY,   0 },
+  { OPTS_L_CHECKPOINT, OPTS_S_CHECKPOINT, 1 },
+  { OPTS_L_CKPT_INT,   OPTS_S_CKPT_INT,   1 },
+  { OPTS_L_RESUME,     OPTS_S_RESUME,     0 },
+  { OPTS_L_PARTITION,  OPTS_S_PARTITION,  1 },
+  { OPTS_L_PREFIX,     OPTS_S_PREFIX,     1 },
+  { OPTS_L_REDUCE,     OPTS_S_REDUCE,     0 },
+  { OPTS_L_SYMMETRY,   OPTS_S_SYMMETRY,   0 },
+  { OPTS_L_BATCH,      OPTS_S_BATCH,      0 },
+  { OPTS_L_ADAPTIVE,   OPTS_S_ADAPTIVE,   0 },
+  { OPTS_L_BACKJUMP,   OPTS_S_BACKJUMP,   0 },
+  { OPTS_L_NOGOOD,     OPTS_S_NOGOOD,     0 },
+  { OPTS_L_NOGOOD_FN,  OPTS_S_NOGOOD_FN,  1 },
+  { OPTS_L_PATH_SAMP,  OPTS_S_PATH_SAMP,  1 },
+  { OPTS_L_MODE,       OPTS_S_MODE,       1 },
 
   /* null terminator. */
   { NULL,              '\0',              0 }
@@ -240,13 +288,34 @@ opts_t *opts_new (void) {
   /* initialize branch control fields. */
   opts->thread_gpu = 0;
   opts->thread_num = 1;
+  opts->frontier = 0;
+  opts->affinity = 0;
   opts->branch_max = 20;
   opts->branch_eps = 0.05;
+  opts->reduce = 0;
+  opts->symmetry = 0;
+  opts->batch = 0;
+  opts->adaptive = 0;
+  opts->backjump = 0;
+  opts->nogood = 0;
+  opts->fname_nogood = NULL;
+
+  /* initialize checkpoint fields. */
+  opts->fname_ckpt = NULL;
+  opts->ckpt_interval = 3600;
+  opts->resume = 0;
+
+  /* initialize tree slicing fields. */
+  opts->part_k = opts->part_n = 1;
+  opts->prefix = NULL;
+  opts->n_prefix = 0;
 
   /* initialize prune control fields. */
+  opts->mode = NULL;
   opts->nsol_limit = 0;
   opts->vdw_scale = 0.6;
   opts->ddf_tol = 0.001;
+  opts->path_sample = 0;
   opts->rmsd_tol = 0.0;
 
   /* initialize graph control fields. */
@@ -426,6 +495,132 @@ int opts_add_pruner (opts_t *opts, char *str) {
   return 1;
 }
 
+/* opts_set_partition(): parse a partition string of the form 'k/N'
+ * into the partition fields of an options data structure.
+ *
+ * arguments:
+ *  @opts: pointer to the options structure to modify.
+ *  @str: partition string to parse.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int opts_set_partition (opts_t *opts, char *str) {
+  /* declare required variables:
+   *  @k, @n: parsed partition index and partition count.
+   *  @end: pointer to the first unparsed character.
+   */
+  char *end;
+  long k, n;
+
+  /* check that the structure pointer is valid. */
+  if (!opts)
+    throw("options structure pointer is invalid");
+
+  /* parse the partition index. */
+  k = strtol(str, &end, 10);
+  if (end == str || *end != '/')
+    throw("partition '%s' is not of the form k/N", str);
+
+  /* parse the partition count. */
+  str = end + 1;
+  n = strtol(str, &end, 10);
+  if (end == str || *end != '\0')
+    throw("partition '%s' is not of the form k/N", str);
+
+  /* check that the values are in bounds. */
+  if (n < 1 || (long) (unsigned int) n != n)
+    throw("partition count %ld out of bounds [1,inf)", n);
+
+  if (k < 1 || k > n)
+    throw("partition index %ld out of bounds [1,%ld]", k, n);
+
+  /* store the partition. */
+  opts->part_k = k;
+  opts->part_n = n;
+
+  /* return success. */
+  return 1;
+}
+
+/* opts_add_prefix(): append a new set of branch indices to the tree
+ * prefix array of an options data structure.
+ *
+ * arguments:
+ *  @opts: pointer to the options structure to modify.
+ *  @str: branch index string to parse and append.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the operation succeeded.
+ */
+int opts_add_prefix (opts_t *opts, char *str) {
+  /* declare required variables:
+   *  @pa, @pb: start and end substring pointers.
+   *  @end: pointer to the first unparsed character.
+   *  @idx: currently parsed branch index.
+   *  @done: completion flag.
+   */
+  char *pa, *pb, *end;
+  unsigned long idx;
+  int done;
+
+  /* check that the structure pointer is valid. */
+  if (!opts)
+    throw("options structure pointer is invalid");
+
+  /* initialize the start pointer and completion flag. */
+  pa = str;
+  done = 0;
+
+  /* loop until completion. */
+  do {
+    /* find the next integer. */
+    pb = strstr(pa, ",");
+
+    /* check if a new pointer was found. */
+    if (!pb) {
+      /* no. prepare the last string. */
+      done = 1;
+      pb = pa + strlen(pa);
+    }
+
+    /* skip empty strings. */
+    if (pb - pa > 0) {
+      /* parse the current integer, which must fill its substring. */
+      errno = 0;
+      idx = strtoul(pa, &end, 10);
+      if (!isdigit((unsigned char) *pa) || end != pb)
+        throw("branch index '%.*s' is not an integer", (int) (pb - pa), pa);
+
+      /* check that the integer is in bounds. */
+      if (errno == ERANGE || (unsigned long) (unsigned int) idx != idx)
+        throw("branch index '%.*s' out of bounds [0,%u]",
+              (int) (pb - pa), pa, (unsigned int) -1);
+
+      /* increment the prefix length. */
+      opts->n_prefix++;
+
+      /* reallocate the prefix array. */
+      opts->prefix = (unsigned int*)
+        realloc(opts->prefix, opts->n_prefix * sizeof(unsigned int));
+
+      /* check if reallocation failed. */
+      if (!opts->prefix)
+        throw("unable to reallocate prefix array");
+
+      /* store the new branch index. */
+      opts->prefix[opts->n_prefix - 1] = idx;
+    }
+
+    /* move past the delimiter. */
+    pa = pb + 1;
+  }
+  while (!done);
+
+  /* return success. */
+  return 1;
+}
+
 /* opts_new_from_strings(): allocate and fill a new options data structure
  * based on an array of command line argument strings.
  *
@@ -591,6 +786,73 @@ opts_t *opts_new_from_strings (int argc, char **argv) {
         break;
 #endif
 
+      /* processor affinity flag. */
+      case OPTS_S_AFFINITY:
+#if !defined(__IBP_HAVE_PTHREAD)
+        /* raise an exception about thread support. */
+        raise("this program was compiled without thread support");
+        opts_free(opts);
+        return NULL;
+#else
+        /* set the affinity flag. */
+        opts->affinity++;
+        break;
+#endif
+
+      /* breadth-first frontier depth. */
+      case OPTS_S_FRONTIER:
+        /* set the frontier depth. */
+        opts->frontier = atoi(argv[argi]);
+        argi++;
+        break;
+
+      /* checkpoint filename. */
+      case OPTS_S_CHECKPOINT:
+        /* set the checkpoint filename. */
+        opts->fname_ckpt = argv[argi];
+        argi++;
+        break;
+
+      /* checkpoint interval. */
+      case OPTS_S_CKPT_INT:
+        /* set the checkpoint interval. */
+        opts->ckpt_interval = atoi(argv[argi]);
+        argi++;
+        break;
+
+      /* resumption flag. */
+      case OPTS_S_RESUME:
+        opts->resume++;
+        break;
+
+      /* tree partition. */
+      case OPTS_S_PARTITION:
+        /* set the partition index and count. */
+        if (!opts_set_partition(opts, argv[argi])) {
+          /* raise an exception and return null. */
+          raise("unable to set tree partition");
+          opts_free(opts);
+          return NULL;
+        }
+
+        /* increment the argument index and break. */
+        argi++;
+        break;
+
+      /* tree prefix. */
+      case OPTS_S_PREFIX:
+        /* add the new branch index or index list. */
+        if (!opts_add_prefix(opts, argv[argi])) {
+          /* raise an exception and return null. */
+          raise("unable to add tree prefix index/indices");
+          opts_free(opts);
+          return NULL;
+        }
+
+        /* increment the argument index and break. */
+        argi++;
+        break;
+
       /* pruning method. */
       case OPTS_S_METHOD:
         /* add the new pruning method or method list. */
@@ -605,6 +867,43 @@ opts_t *opts_new_from_strings (int argc, char **argv) {
         argi++;
         break;
 
+      /* interval reduction flag. */
+      case OPTS_S_REDUCE:
+        opts->reduce++;
+        break;
+
+      /* partial reflection symmetry flag. */
+      case OPTS_S_SYMMETRY:
+        opts->symmetry++;
+        break;
+
+      /* batched sibling evaluation flag. */
+      case OPTS_S_BATCH:
+        opts->batch++;
+        break;
+
+      /* adaptive pruning flag. */
+      case OPTS_S_ADAPTIVE:
+        opts->adaptive++;
+        break;
+
+      /* backjumping flag. */
+      case OPTS_S_BACKJUMP:
+        opts->backjump++;
+        break;
+
+      /* nogood cache flag. */
+      case OPTS_S_NOGOOD:
+        opts->nogood++;
+        break;
+
+      /* nogood filename, which implies the nogood cache. */
+      case OPTS_S_NOGOOD_FN:
+        opts->fname_nogood = argv[argi];
+        opts->nogood++;
+        argi++;
+        break;
+
       /* branch maximum. */
       case OPTS_S_BRANCH_MAX:
         opts->branch_max = atoi(argv[argi]);
@@ -617,6 +916,12 @@ opts_t *opts_new_from_strings (int argc, char **argv) {
         argi++;
         break;
 
+      /* search mode. */
+      case OPTS_S_MODE:
+        opts->mode = argv[argi];
+        argi++;
+        break;
+
       /* solution limit. */
       case OPTS_S_LIMIT:
         opts->nsol_limit = atoi(argv[argi]);
@@ -635,6 +940,12 @@ opts_t *opts_new_from_strings (int argc, char **argv) {
         argi++;
         break;
 
+      /* path statistics sample size. */
+      case OPTS_S_PATH_SAMP:
+        opts->path_sample = atoi(argv[argi]);
+        argi++;
+        break;
+
       /* rmsd tolerance. */
       case OPTS_S_RMSD:
         opts->rmsd_tol = atof(argv[argi]);
@@ -689,6 +1000,10 @@ void opts_free (opts_t *opts) {
   if (opts->n_sidech)
     free(opts->sidech);
 
+  /* free the array of tree prefix indices. */
+  if (opts->n_prefix)
+    free(opts->prefix);
+
   /* free the array of pruning device names. */
   if (opts->n_prune) {
     /* free the array elements. */
@@ -750,10 +1065,6 @@ int opts_validate (opts_t *opts) {
   if (!opts->fname_ord)
     raise("expected reorder filename not specified");
 
-  /* validate the thread count. */
-  if (opts->thread_num == 0)
-    raise("thread count must be non-zero");
-
   /* validate the branch count. */
   if (opts->branch_max == 0)
     raise("maximum branch count must be positive");
@@ -770,6 +1081,31 @@ int opts_validate (opts_t *opts) {
   if (opts->ddf_tol < 0.0)
     raise("DDF: error tolerance must be non-negative");
 
+  /* check that a checkpoint filename was specified for resumption. */
+  if (opts->resume && !opts->fname_ckpt)
+    raise("resumption requires a checkpoint filename");
+
+  /* checkpoints do not hold the rmsd diversity index, so a resumed
+   * enumeration would accept solutions similar to those already written.
+   */
+  if (opts->resume && opts->rmsd_tol > 0.0)
+    raise("resumption does not support rmsd filtering");
+
+  /* validate the search mode. minimization does not hold its incumbent
+   * solution in checkpoints, and its minimum is only proven over the
+   * whole tree.
+   */
+  if (opts->mode && strcmp(opts->mode, "enumerate") &&
+      strcmp(opts->mode, "minimize"))
+    raise("unrecognized search mode '%s'", opts->mode);
+  else if (opts->mode && !strcmp(opts->mode, "minimize")) {
+    if (opts->fname_ckpt)
+      raise("minimization does not support checkpoints");
+
+    if (opts->part_n > 1 || opts->n_prefix)
+      raise("minimization does not support partitions or prefixes");
+  }
+
   /* return valid. */
   return (traceback_length() == 0);
 }
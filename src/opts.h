@@ -65,21 +65,52 @@ typedef struct {
 
   /* declare variables for branch control:
    *  @thread_gpu: whether or not we should use the gpu.
-   *  @thread_num: number of parallel threads to utilize.
+   *  @thread_num: number of parallel threads to utilize, or zero.
+   *  @frontier: number of levels to expand breadth-first.
+   *  @affinity: whether or not to pin threads to processors.
    *  @branch_max: maximum number of branches per node.
    *  @branch_eps: smallest division for interval discretization.
+   *  @reduce: whether or not to branch on reduced dihedral intervals.
+   *  @symmetry: whether or not to exploit partial reflection symmetry.
+   *  @batch: whether or not to embed and prune siblings in batches.
+   *  @adaptive: whether or not to adaptively reorder prune tests.
+   *  @backjump: whether or not to learn and skip dead siblings.
+   *  @nogood: whether or not to learn and skip nogoods.
+   *  @fname_nogood: nogood filename string.
    */
-  unsigned int thread_gpu, thread_num;
-  unsigned int branch_max;
+  unsigned int thread_gpu, thread_num, frontier, affinity;
+  unsigned int branch_max, reduce, symmetry, batch, adaptive, backjump;
+  unsigned int nogood;
+  char *fname_nogood;
   double branch_eps;
 
+  /* declare variables for checkpointing:
+   *  @fname_ckpt: checkpoint filename string.
+   *  @ckpt_interval: time (in seconds) between periodic checkpoints.
+   *  @resume: whether or not to resume from the checkpoint file.
+   */
+  char *fname_ckpt;
+  unsigned int ckpt_interval, resume;
+
+  /* declare variables for tree slicing:
+   *  @part_k: index [1..N] of the tree partition to enumerate.
+   *  @part_n: number of partitions to divide the tree into.
+   *  @prefix: array of branch indices fixing the shallowest levels.
+   *  @n_prefix: number of branch indices in @prefix.
+   */
+  unsigned int part_k, part_n;
+  unsigned int *prefix, n_prefix;
+
   /* declare variables for pruning control:
+   *  @mode: search mode name string.
    *  @nsol_limit: maximum number of solutions to enumerate.
    *  @vdw_scale: atomic radius scaling factor for ddf lower-bounds.
    *  @ddf_tol: tolerance for acceptable out-of-bound errors.
    *  @rmsd_tol: rmsd for skipping structures.
+   *  @path_sample: number of path tests per level to count, or zero.
    */
-  unsigned int nsol_limit;
+  char *mode;
+  unsigned int nsol_limit, path_sample;
   double vdw_scale;
   double ddf_tol;
   double rmsd_tol;
@@ -0,0 +1,145 @@
+
+/* include the enumerator tests header. */
+#include "enum-base.h"
+
+/* TEST_ENUM_ARGS: arguments shared by every test enumerator, which
+ * select the library files and discard all output structures.
+ */
+#define TEST_ENUM_ARGS \
+  "--topology lib/ibp-protein.top " \
+  "--params lib/ibp-protein.par " \
+  "--reorder lib/ibp-protein.ord " \
+  "--format null "
+
+/* TEST_ENUM_MAXARGS: maximum number of argument strings. */
+#define TEST_ENUM_MAXARGS  64
+
+/* test_enum_new(): build an enumerator in the same way as the ibp-ng
+ * utility, from a string of command line arguments. paths are relative
+ * to the top of the source tree, from which all tests are executed.
+ *
+ * arguments:
+ *  @T: pointer to the test enumerator structure to fill.
+ *  @args: space-separated command line arguments.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the enumerator was built.
+ */
+int test_enum_new (test_enum_t *T, const char *args) {
+  /* declare required variables:
+   *  @argv: array of argument strings.
+   *  @argc: number of argument strings.
+   */
+  char *argv[TEST_ENUM_MAXARGS];
+  int argc = 0;
+
+  /* initialize the structure pointers. */
+  T->opts = NULL;
+  T->top = NULL;
+  T->par = NULL;
+  T->ord = NULL;
+  T->P = NULL;
+  T->G = NULL;
+  T->E = NULL;
+
+  /* build the argument buffer. */
+  T->args = (char*) malloc(strlen(TEST_ENUM_ARGS) + strlen(args) + 1);
+  if (!T->args)
+    return 0;
+
+  strcpy(T->args, TEST_ENUM_ARGS);
+  strcat(T->args, args);
+
+  /* split the buffer into argument strings. */
+  argv[argc++] = "ibp-ng";
+  for (char *tok = strtok(T->args, " "); tok && argc < TEST_ENUM_MAXARGS;
+       tok = strtok(NULL, " "))
+    argv[argc++] = tok;
+
+  /* parse and validate the arguments. */
+  T->opts = opts_new_from_strings(argc, argv);
+  if (!T->opts || !opts_validate(T->opts))
+    return 0;
+
+  /* read the topology, parameters and reorder definitions. */
+  T->top = topol_new_from_file(T->opts->fname_top);
+  T->par = param_new_from_file(T->opts->fname_par, T->opts->vdw_scale);
+  T->ord = reorder_new_from_file(T->opts->fname_ord);
+  if (!T->top || !T->par || !T->ord)
+    return 0;
+
+  /* read the peptide, and apply its topology and parameters. */
+  T->P = peptide_new_from_file(T->opts->fname_in, T->opts->idx_in);
+  if (!T->P ||
+      !topol_apply_all(T->top, T->P) ||
+      !param_apply_all(T->par, T->P))
+    return 0;
+
+  /* add the restraints to the peptide. */
+  for (unsigned int i = 0; i < T->opts->n_restr; i++) {
+    if (!assign_set_from_file(T->P, T->opts->fname_restr[i]))
+      return 0;
+  }
+
+  /* build the graph and the enumerator. */
+  if (!peptide_field(T->P, T->opts->ddf_tol))
+    return 0;
+
+  T->G = peptide_graph(T->P, T->ord, T->opts->refine, T->opts->complete);
+  if (!T->G)
+    return 0;
+
+  T->E = enum_new(T->P, T->G, T->opts);
+  if (!T->E)
+    return 0;
+
+  /* silence the pruning reports written by the enumerator. */
+  if (!freopen("/dev/null", "w", stdout))
+    return 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* test_enum_free(): free all structures held by a test enumerator.
+ *
+ * arguments:
+ *  @T: pointer to the test enumerator structure to free.
+ */
+void test_enum_free (test_enum_t *T) {
+  /* free the enumerator and its inputs. */
+  enum_free(T->E);
+  peptide_free(T->P);
+  graph_free(T->G);
+  reorder_free(T->ord);
+  param_free(T->par);
+  topol_free(T->top);
+  opts_free(T->opts);
+
+  /* free the argument buffer. */
+  free(T->args);
+
+  /* clear any raised exceptions. */
+  traceback_clear();
+}
+
+/* test_write_file(): write a string into a file.
+ *
+ * arguments:
+ *  @fname: filename string of the file to write.
+ *  @str: string to write.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the file was written.
+ */
+int test_write_file (const char *fname, const char *str) {
+  /* open the file. */
+  FILE *fh = fopen(fname, "w");
+  if (!fh)
+    return 0;
+
+  /* write the string and close the file. */
+  const int ok = (fputs(str, fh) >= 0);
+  return (fclose(fh) == 0 && ok);
+}
+
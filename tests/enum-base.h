@@ -0,0 +1,40 @@
+
+/* ensure once-only inclusion. */
+#pragma once
+
+/* include the enumerator and molecular information headers. */
+#include "../src/enum.h"
+#include "../src/topol.h"
+#include "../src/param.h"
+#include "../src/assign.h"
+
+/* test_enum_t: structure holding an enumerator, along with every input
+ * structure that it was built from.
+ */
+typedef struct {
+  /* @args: buffer holding the argument strings.
+   * @opts: options parsed from the argument strings.
+   * @top, @par, @ord: topology, parameter and reorder structures.
+   * @P: peptide structure.
+   * @G: graph structure.
+   * @E: enumerator structure.
+   */
+  char *args;
+  opts_t *opts;
+  topol_t *top;
+  param_t *par;
+  reorder_t *ord;
+  peptide_t *P;
+  graph_t *G;
+  enum_t *E;
+}
+test_enum_t;
+
+/* function declarations (enum-base.c): */
+
+int test_enum_new (test_enum_t *T, const char *args);
+
+void test_enum_free (test_enum_t *T);
+
+int test_write_file (const char *fname, const char *str);
+
@@ -0,0 +1,124 @@
+
+/* include the required headers. */
+#include "base.h"
+#include "enum-base.h"
+
+/* ARGS: arguments of every enumerator. */
+#define ARGS \
+  "--input data/tetra/tetra.fa --restraints data/tetra/tetra.res " \
+  "--method dist,impr --branch-max 4 --branch-eps 0.5 --vdw-scale 0.5 "
+
+/* NSTOP: number of solutions after which a checkpoint is requested. */
+#define NSTOP  5000
+
+/* count: number of solutions passed to the output system (atomic).
+ * stop: enumerator to checkpoint and stop after NSTOP solutions.
+ */
+static unsigned int count;
+static enum_t *stop;
+
+/* count_pack(): count the solutions passed to the output system, and
+ * request a stopping checkpoint once NSTOP solutions have been seen.
+ */
+static int count_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame) {
+  if (__atomic_add_fetch(&count, 1, __ATOMIC_RELAXED) == NSTOP && stop) {
+    E->ckpt_stop = 1;
+    E->ckpt_req = 1;
+  }
+
+  frame->sz = 0;
+  return 1;
+}
+
+/* count_data(): write nothing. */
+static int count_data (enum_t *E, enum_frame_t **frames, unsigned int n) {
+  return 1;
+}
+
+/* enumerate(): run an enumerator, counting its solutions, and return
+ * the final solution count, or UINT_MAX on failure.
+ */
+static unsigned int enumerate (const char *args, int checkpoint,
+                               unsigned int *nckpt) {
+  test_enum_t T;
+
+  /* build the enumerator. */
+  if (!test_enum_new(&T, args)) {
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  /* count the solutions, and stop early if requested. */
+  T.E->write_pack = count_pack;
+  T.E->write_data = count_data;
+  T.E->frame_bytes = sizeof(double);
+  stop = (checkpoint ? T.E : NULL);
+  count = 0;
+
+  /* run the enumerator. */
+  const unsigned int nsol = (enum_execute(T.E) ? T.E->nsol : UINT_MAX);
+  if (nckpt)
+    *nckpt = T.E->ckpt_count;
+
+  test_enum_free(&T);
+  return nsol;
+}
+
+/* enum-checkpoint.x: test-case for writing checkpoints and resuming
+ * enumerations from them.
+ */
+int main (int argc, char **argv) {
+  unsigned int n_fails = 0;
+  unsigned int nckpt;
+  char fname[] = "/tmp/ibp-ckpt-XXXXXX";
+  char args[512];
+
+  /* create the checkpoint file. */
+  const int fd = mkstemp(fname);
+  if (fd < 0)
+    return 1;
+
+  close(fd);
+
+  /* enumerate the whole tree. */
+  const unsigned int nsol = enumerate(ARGS, 0, NULL);
+  n_fails += test_eq_uint(count, nsol);
+
+  /* stop single-threaded and multi-threaded enumerations partway
+   * through, and resume them from their checkpoints.
+   */
+  const char *modes[] = { "", "--threads 3 --frontier 4" };
+  for (unsigned int m = 0; m < 2; m++) {
+    /* enumerate until the first checkpoint. */
+    sprintf(args, "%s %s --checkpoint %s", ARGS, modes[m], fname);
+    const unsigned int nsol1 = enumerate(args, 1, &nckpt);
+    n_fails += test_eq_uint(nckpt, 1);
+    n_fails += test_eq_uint(nsol1 >= NSTOP && nsol1 < nsol, 1);
+
+    /* resumption must refuse other slices and pruning options, and the
+     * rmsd diversity index, which is not saved.
+     */
+    const char *other[] = {
+      "--partition 1/2", "--prefix 0", "--reduce", "--method path",
+      "--rmsd 0.5"
+    };
+    for (unsigned int i = 0; i < 5; i++) {
+      sprintf(args, "%s %s %s --checkpoint %s --resume",
+              ARGS, modes[m], other[i], fname);
+      n_fails += test_eq_uint(enumerate(args, 0, NULL), UINT_MAX);
+    }
+
+    /* resume the enumeration, which must find the remaining solutions. */
+    sprintf(args, "%s %s --checkpoint %s --resume", ARGS, modes[m], fname);
+    const unsigned int nsol2 = enumerate(args, 0, &nckpt);
+    n_fails += test_eq_uint(nsol2, nsol);
+    n_fails += test_eq_uint(count, nsol - nsol1);
+    n_fails += test_eq_uint(nckpt, 1);
+  }
+
+  /* remove the checkpoint file. */
+  unlink(fname);
+
+  return (n_fails > 0);
+}
+
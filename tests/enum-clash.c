@@ -0,0 +1,158 @@
+
+/* include the required headers. */
+#include "base.h"
+#include "enum-base.h"
+
+/* SEQ, RES: sequence and restraints of a hexapeptide whose backbone
+ * psi angles are free, so that its side chains clash in some leaves.
+ */
+#define SEQ "> hexa\nAGSAGS\n"
+#define RES \
+  "assign (resid 2 and name N)  (resid 2 and name CA)\n" \
+  "       (resid 2 and name C)  (resid 3 and name N) 1.0 0.0 1000.0 1\n" \
+  "assign (resid 3 and name N)  (resid 3 and name CA)\n" \
+  "       (resid 3 and name C)  (resid 4 and name N) 1.0 0.0 1000.0 1\n" \
+  "assign (resid 4 and name N)  (resid 4 and name CA)\n" \
+  "       (resid 4 and name C)  (resid 5 and name N) 1.0 0.0 1000.0 1\n" \
+  "assign (resid 5 and name N)  (resid 5 and name CA)\n" \
+  "       (resid 5 and name C)  (resid 6 and name N) 1.0 0.0 1000.0 1\n"
+
+/* ARGS: arguments of every enumerator, which follow the filenames. */
+#define ARGS \
+  "--branch-max 4 --branch-eps 0.5 --vdw-scale 0.3 --partition 17/64 " \
+  "--threads 1 "
+
+/* check: state of the checks made on every accepted solution:
+ *  @nsol: number of checked solutions.
+ *  @nfree: number of solutions without clashes.
+ *  @nlate: number of solutions with clashes that follow a solution
+ *          without clashes.
+ */
+static struct {
+  unsigned int nsol, nfree, nlate;
+} check;
+
+/* clashes(): return whether any two atoms of a solution overlap beyond
+ * the tolerance, checking every pair that the graph does not already
+ * allow to lie closer than the sum of their radii. the first three
+ * levels are placed without pruning, and so are not checked together.
+ */
+static int clashes (enum_t *E, const enum_thread_node_t *state) {
+  graph_t *G = E->G;
+
+  /* loop over every pair of embedded atoms. */
+  for (unsigned int j = 3; j < G->n_order; j++) {
+    if (G->orig[j])
+      continue;
+
+    for (unsigned int i = 0; i < j; i++) {
+      if (G->orig[i])
+        continue;
+
+      /* skip pairs left to the distance pruners. */
+      const double rsum = E->P->atoms[G->order[i]].radius +
+                          E->P->atoms[G->order[j]].radius;
+      const value_t bound = graph_get_edge(G, G->order[i], G->order[j]);
+      if (bound.type != VALUE_TYPE_UNDEFINED && bound.l < rsum)
+        continue;
+
+      /* check the pair. */
+      const double r = rsum - E->ddf_tol;
+      const vector_t *x = &state[i].pos, *y = &state[j].pos;
+      const double dx = x->x - y->x, dy = x->y - y->y, dz = x->z - y->z;
+      if (r > 0.0 && dx * dx + dy * dy + dz * dz < r * r)
+        return 1;
+    }
+  }
+
+  /* no atoms overlap. */
+  return 0;
+}
+
+/* check_pack(): check each accepted solution for clashes. */
+static int check_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame) {
+  check.nsol++;
+  if (!clashes(E, th->state))
+    check.nfree++;
+  else if (check.nfree)
+    check.nlate++;
+
+  frame->sz = 0;
+  return 1;
+}
+
+/* check_data(): write nothing. */
+static int check_data (enum_t *E, enum_frame_t **frames, unsigned int n) {
+  return 1;
+}
+
+/* enumerate(): enumerate the hexapeptide with a set of pruning methods,
+ * checking each solution, and return the solution count, or UINT_MAX
+ * on failure.
+ */
+static unsigned int enumerate (const char *dir, const char *methods) {
+  char args[512];
+  test_enum_t T;
+
+  /* build the enumerator. */
+  sprintf(args, "--input %s/hexa.fa --restraints %s/hexa.res %s --method %s",
+          dir, dir, ARGS, methods);
+  if (!test_enum_new(&T, args)) {
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  /* check every solution. */
+  check.nsol = check.nfree = check.nlate = 0;
+  T.E->write_pack = check_pack;
+  T.E->write_data = check_data;
+  T.E->frame_bytes = sizeof(double);
+
+  /* run the enumerator. */
+  const unsigned int nsol = (enum_execute(T.E) ? T.E->nsol : UINT_MAX);
+  test_enum_free(&T);
+  return nsol;
+}
+
+/* enum-clash.x: test-case for clash pruning against a check of every
+ * pair of atoms of each solution.
+ */
+int main (int argc, char **argv) {
+  unsigned int n_fails = 0;
+  char dir[] = "/tmp/ibp-clash-XXXXXX";
+  char fseq[64], fres[64];
+
+  /* write the input files. */
+  if (!mkdtemp(dir))
+    return 1;
+
+  sprintf(fseq, "%s/hexa.fa", dir);
+  sprintf(fres, "%s/hexa.res", dir);
+  if (!test_write_file(fseq, SEQ) || !test_write_file(fres, RES))
+    return 1;
+
+  /* without clash pruning, some solutions must clash, and some of them
+   * must follow a solution that does not, whose centering then moves
+   * the atoms held by the clash grid.
+   */
+  const unsigned int nall = enumerate(dir, "dist,impr");
+  const unsigned int nfree = check.nfree;
+  n_fails += test_eq_uint(nall == UINT_MAX, 0);
+  n_fails += test_eq_uint(check.nsol, nall);
+  n_fails += test_eq_uint(nfree > 0 && nfree < nall, 1);
+  n_fails += test_eq_uint(check.nlate > 0, 1);
+
+  /* with clash pruning, exactly the solutions without clashes remain. */
+  const unsigned int nsol = enumerate(dir, "dist,impr,clash");
+  n_fails += test_eq_uint(nsol, nfree);
+  n_fails += test_eq_uint(check.nsol, nfree);
+  n_fails += test_eq_uint(check.nfree, nfree);
+
+  /* remove the input files. */
+  unlink(fseq);
+  unlink(fres);
+  rmdir(dir);
+
+  return (n_fails > 0);
+}
+
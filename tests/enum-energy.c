@@ -0,0 +1,288 @@
+
+/* include the required headers. */
+#include "base.h"
+#include "enum-base.h"
+
+/* ARGS: arguments of every enumerator. */
+#define ARGS \
+  "--input data/tetra/tetra.fa --restraints data/tetra/tetra.res " \
+  "--method dist,energy --branch-max 4 --branch-eps 0.5 " \
+  "--vdw-scale 0.5 --threads 1 "
+
+/* ALL_TYPES: mask selecting every type of energy term. */
+#define ALL_TYPES  ((1U << ENERGY_TYPES) - 1)
+
+/* check: state of the checks made on every accepted solution:
+ *  @P: peptide holding the force field parameters.
+ *  @lev: array of the level at which each atom is embedded.
+ *  @kappa: precision of close contacts.
+ *  @types: mask of the energy term types in use.
+ *  @nsol: number of checked solutions.
+ *  @nbad: number of solutions whose energy differs from the reference.
+ *  @nlb: number of solutions whose energy lies below the lower bounds.
+ *  @umin: least energy of the checked solutions.
+ */
+static struct {
+  peptide_t *P;
+  unsigned int *lev;
+  double kappa;
+  unsigned int types;
+  unsigned int nsol, nbad, nlb;
+  double umin;
+} check;
+
+/* agree(): return whether two energies agree to within rounding. */
+static int agree (double a, double b) {
+  return (fabs(a - b) <= 1.0e-8 * (fabs(a) + fabs(b) + 1.0));
+}
+
+/* counted(): return whether a term over a set of atoms is summed into
+ * the energy of a solution, which holds the terms of the fourth and
+ * deeper levels, as the first three levels are placed without pruning.
+ */
+static int counted (const unsigned int *ids, unsigned int n) {
+  unsigned int lmax = 0;
+  for (unsigned int k = 0; k < n; k++)
+    lmax = (check.lev[ids[k]] > lmax ? check.lev[ids[k]] : lmax);
+
+  return (lmax >= 3);
+}
+
+/* reference(): compute the energy of a solution of the peptide directly
+ * from the force field, in the terms of the selected types.
+ */
+static double reference (enum_thread_node_t *state) {
+  peptide_t *P = check.P;
+  const unsigned int *lev = check.lev;
+  const unsigned int types = check.types;
+  double U = 0.0;
+
+  /* bonds use the harmonic form, and virtual bonds the log form. */
+  for (unsigned int i = 0; i < P->n_bonds; i++) {
+    const unsigned int *ids = P->bonds[i].atom_id;
+    if (!counted(ids, 2))
+      continue;
+
+    const double mu = P->bonds[i].mu, kappa = P->bonds[i].kappa;
+    const double d = vector_dist(&state[lev[ids[0]]].pos,
+                                 &state[lev[ids[1]]].pos);
+
+    if (P->bonds[i].is_virtual && (types & (1U << ENERGY_DISTANCE)))
+      U += 0.5 * kappa * pow(log(d / mu), 2.0);
+    else if (!P->bonds[i].is_virtual && (types & (1U << ENERGY_BOND)))
+      U += 0.5 * kappa * pow(d - mu, 2.0);
+  }
+
+  /* angles use the harmonic form in their cosine, or the linear form
+   * about a straight angle.
+   */
+  for (unsigned int i = 0; types & (1U << ENERGY_ANGLE) &&
+                           i < P->n_angles; i++) {
+    const unsigned int *ids = P->angles[i].atom_id;
+    if (!counted(ids, 3))
+      continue;
+
+    const double mu = P->angles[i].mu, kappa = P->angles[i].kappa;
+    const double theta = vector_angle(&state[lev[ids[0]]].pos,
+                                      &state[lev[ids[1]]].pos,
+                                      &state[lev[ids[2]]].pos);
+
+    if (pow(sin(mu), 2.0) > 1.0e-3)
+      U += 0.5 * kappa * pow(cos(theta) - cos(mu), 2.0) / pow(sin(mu), 2.0);
+    else
+      U += kappa * (1.0 - cos(theta) * (cos(mu) < 0.0 ? -1.0 : 1.0));
+  }
+
+  /* torsions and impropers use the periodic form. */
+  for (unsigned int i = 0; types & (1U << ENERGY_DIHEDRAL) &&
+                           i < P->n_torsions + P->n_impropers; i++) {
+    const peptide_dihed_t *t = (i < P->n_torsions ? P->torsions + i :
+                                P->impropers + i - P->n_torsions);
+    const unsigned int *ids = t->atom_id;
+    if (!counted(ids, 4))
+      continue;
+
+    const double omega = vector_dihedral(&state[lev[ids[0]]].pos,
+                                         &state[lev[ids[1]]].pos,
+                                         &state[lev[ids[2]]].pos,
+                                         &state[lev[ids[3]]].pos);
+
+    U += t->kappa * (1.0 - cos(omega - t->mu));
+  }
+
+  /* contacts are held between every pair of atoms. */
+  for (unsigned int i = 0; types & (1U << ENERGY_CONTACT) &&
+                           i < P->n_atoms; i++) {
+    for (unsigned int j = i + 1; j < P->n_atoms; j++) {
+      const unsigned int ids[2] = { i, j };
+      if (!counted(ids, 2))
+        continue;
+
+      const double mu = P->atoms[i].radius + P->atoms[j].radius;
+      const double d = vector_dist(&state[lev[i]].pos, &state[lev[j]].pos);
+      U += 0.5 * check.kappa * pow(mu / d, 6.0);
+    }
+  }
+
+  return U;
+}
+
+/* check_pack(): check the energy of each accepted solution against its
+ * reference, and the energy added below each level against the lower
+ * bound on the energy of the deeper levels.
+ */
+static int check_pack (enum_t *E, enum_thread_t *th, enum_frame_t *frame) {
+  enum_thread_node_t *state = th->state;
+  const unsigned int n = E->G->n_order;
+  const double U = state[n - 1].energy;
+
+  /* check the energy of the solution. */
+  check.nsol++;
+  if (!agree(U, reference(state)))
+    check.nbad++;
+
+  /* check the least energy of the terms of each summed level. */
+  for (unsigned int lev = 3; lev < n; lev++) {
+    const double lb = E->energy_lb[lev - 1] - E->energy_lb[lev];
+    const double du = state[lev].energy - state[lev - 1].energy;
+    if (lb > du && !agree(lb, du)) {
+      check.nlb++;
+      break;
+    }
+  }
+
+  /* store the least energy. */
+  check.umin = (U < check.umin ? U : check.umin);
+
+  frame->sz = 0;
+  return 1;
+}
+
+/* check_data(): write nothing. */
+static int check_data (enum_t *E, enum_frame_t **frames, unsigned int n) {
+  return 1;
+}
+
+/* enumerate(): enumerate every solution with the energy terms of the
+ * selected types, checking each of them, and return the solution count,
+ * or UINT_MAX on failure.
+ */
+static unsigned int enumerate (unsigned int types) {
+  test_enum_t T;
+
+  /* build the inputs. */
+  if (!test_enum_new(&T, ARGS)) {
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  /* remove the terms of the types not selected. */
+  peptide_t *P = T.P;
+  for (unsigned int i = 0; i < P->n_bonds; i++) {
+    const unsigned int type = (P->bonds[i].is_virtual ? ENERGY_DISTANCE
+                                                      : ENERGY_BOND);
+    if (!(types & (1U << type)))
+      P->bonds[i].kappa = 0.0;
+  }
+
+  for (unsigned int i = 0; !(types & (1U << ENERGY_ANGLE)) &&
+                           i < P->n_angles; i++)
+    P->angles[i].kappa = 0.0;
+
+  for (unsigned int i = 0; !(types & (1U << ENERGY_DIHEDRAL)) &&
+                           i < P->n_torsions; i++)
+    P->torsions[i].kappa = 0.0;
+
+  for (unsigned int i = 0; !(types & (1U << ENERGY_DIHEDRAL)) &&
+                           i < P->n_impropers; i++)
+    P->impropers[i].kappa = 0.0;
+
+  for (unsigned int i = 0; !(types & (1U << ENERGY_CONTACT)) &&
+                           i < P->n_atoms; i++)
+    P->atoms[i].radius = 0.0;
+
+  /* rebuild the enumerator from the modified force field. */
+  enum_free(T.E);
+  T.E = enum_new(T.P, T.G, T.opts);
+  if (!T.E) {
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  /* locate the embedded level of every atom. */
+  enum_t *E = T.E;
+  unsigned int *lev = (unsigned int*)
+    malloc(P->n_atoms * sizeof(unsigned int));
+  if (!lev || E->G->n_orig != P->n_atoms) {
+    free(lev);
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  for (unsigned int i = 0; i < E->G->n_order; i++) {
+    if (!E->G->orig[i])
+      lev[E->G->order[i]] = i;
+  }
+
+  /* check every solution. */
+  check.P = P;
+  check.lev = lev;
+  check.kappa = 3.84147997 * pow(E->ddf_tol, -2.0);
+  check.types = types;
+  check.nsol = check.nbad = check.nlb = 0;
+  check.umin = INFINITY;
+
+  E->write_pack = check_pack;
+  E->write_data = check_data;
+  E->frame_bytes = sizeof(double);
+
+  /* run the enumerator. */
+  const unsigned int nsol = (enum_execute(E) ? E->nsol : UINT_MAX);
+
+  free(lev);
+  test_enum_free(&T);
+  return nsol;
+}
+
+/* minimize(): search for the least energy of every solution, and return
+ * it, or infinity on failure.
+ */
+static double minimize (void) {
+  test_enum_t T;
+
+  /* build and run the enumerator. */
+  if (!test_enum_new(&T, ARGS "--mode minimize") || !enum_execute(T.E)) {
+    test_enum_free(&T);
+    return INFINITY;
+  }
+
+  /* return the least energy. */
+  const double umin = (T.E->nsol ? T.E->energy_tol : INFINITY);
+  test_enum_free(&T);
+  return umin;
+}
+
+/* enum-energy.x: test-case for the energy terms, the lower bounds on the
+ * energy of deeper levels, and the minimum-energy search.
+ */
+int main (int argc, char **argv) {
+  unsigned int n_fails = 0;
+
+  /* check each type of term in turn, and then all types at once. */
+  for (unsigned int type = 0; type <= ENERGY_TYPES; type++) {
+    const unsigned int types = (type < ENERGY_TYPES ? 1U << type : ALL_TYPES);
+    const unsigned int nsol = enumerate(types);
+
+    n_fails += test_eq_uint(nsol > 0 && nsol != UINT_MAX, 1);
+    n_fails += test_eq_uint(check.nsol, nsol);
+    n_fails += test_eq_uint(check.nbad, 0);
+    n_fails += test_eq_uint(check.nlb, 0);
+  }
+
+  /* the search must find the least energy of all solutions. */
+  const double umin = check.umin;
+  n_fails += test_eq_uint(agree(minimize(), umin), 1);
+
+  return (n_fails > 0);
+}
+
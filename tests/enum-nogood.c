@@ -0,0 +1,83 @@
+
+/* include the required headers. */
+#include "base.h"
+#include "enum-base.h"
+
+/* ARGS: arguments of every enumerator. */
+#define ARGS \
+  "--input data/alpha/alpha.fa --restraints data/alpha/alpha.res " \
+  "--method dist,impr --branch-max 64 --vdw-scale 0.5 "
+
+/* enumerate(): run an enumerator with a nogood file, and return its
+ * solution count, and the numbers of nodes embedded and avoided, and
+ * of nogoods stored and loaded.
+ */
+static unsigned int enumerate (const char *eps, const char *fname,
+                               unsigned long *res) {
+  char args[512];
+  test_enum_t T;
+
+  /* build and run the enumerator. */
+  sprintf(args, "%s --branch-eps %s --nogood-file %s", ARGS, eps, fname);
+  if (!test_enum_new(&T, args) || !enum_execute(T.E)) {
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  /* sum the node counts over all threads. */
+  res[0] = res[1] = 0;
+  for (unsigned int t = 0; t < T.E->nthreads; t++) {
+    res[0] += T.E->threads[t].nodes;
+    res[1] += T.E->threads[t].avoided;
+  }
+
+  /* store the nogood counts. */
+  res[2] = T.E->nogood_n;
+  res[3] = T.E->nogood_loaded;
+
+  const unsigned int nsol = T.E->nsol;
+  test_enum_free(&T);
+  return nsol;
+}
+
+/* enum-nogood.x: test-case for saving nogoods into a file and loading
+ * them in later runs of the same instance.
+ */
+int main (int argc, char **argv) {
+  unsigned int n_fails = 0;
+  unsigned long res1[4], res2[4], res3[4];
+  char fname[] = "/tmp/ibp-nogood-XXXXXX";
+
+  /* create a name for the nogood file, which must not yet exist. */
+  const int fd = mkstemp(fname);
+  if (fd < 0)
+    return 1;
+
+  close(fd);
+  unlink(fname);
+
+  /* learn nogoods in a first run, which has no file to load. */
+  const unsigned int nsol1 = enumerate("0.05", fname, res1);
+  n_fails += test_eq_uint(nsol1 == UINT_MAX, 0);
+  n_fails += test_eq_uint(res1[2] > 0, 1);
+  n_fails += test_eq_uint(res1[3] == 0, 1);
+
+  /* a second run loads every nogood, and embeds fewer nodes. */
+  const unsigned int nsol2 = enumerate("0.05", fname, res2);
+  n_fails += test_eq_uint(nsol2, nsol1);
+  n_fails += test_eq_uint(res2[3] == res1[2], 1);
+  n_fails += test_eq_uint(res2[1] > 0, 1);
+  n_fails += test_eq_uint(res2[0] < res1[0], 1);
+
+  /* a run of another instance discards the nogoods of the file. */
+  const unsigned int nsol3 = enumerate("0.1", fname, res3);
+  n_fails += test_eq_uint(nsol3 == UINT_MAX, 0);
+  n_fails += test_eq_uint(res3[3] == 0, 1);
+  n_fails += test_eq_uint(res3[1] == 0, 1);
+
+  /* remove the nogood file. */
+  unlink(fname);
+
+  return (n_fails > 0);
+}
+
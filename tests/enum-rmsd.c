@@ -0,0 +1,233 @@
+
+/* include the required headers. */
+#include "base.h"
+#include "enum-base.h"
+#include "../src/enum-rmsd.h"
+
+/* ARGS: arguments of the enumerator. */
+#define ARGS \
+  "--input data/tetra/tetra.fa --restraints data/tetra/tetra.res " \
+  "--method dist --rmsd 0.5 "
+
+/* NBASE, NCAND: numbers of base structures and of candidates. */
+#define NBASE  3
+#define NCAND  600
+
+/* uniform(): return a pseudo-random number in [-1,1]. */
+static double uniform (void) {
+  return 2.0 * ((double) rand() / (double) RAND_MAX) - 1.0;
+}
+
+/* sqdev(): compute the sum of squared deviations between two centered
+ * structures after optimal superposition, from the largest eigenvalue
+ * of the 4x4 quaternion matrix of horn, which is found by jacobi
+ * rotations. this is independent of the characteristic polynomial
+ * solved by the enumerator.
+ */
+static double sqdev (const vector_t *a, const vector_t *b, unsigned int n) {
+  double S[3][3] = { { 0.0 } }, G = 0.0;
+
+  /* compute the inner products. */
+  for (unsigned int i = 0; i < n; i++) {
+    const double u[3] = { a[i].x, a[i].y, a[i].z };
+    const double v[3] = { b[i].x, b[i].y, b[i].z };
+    for (unsigned int j = 0; j < 3; j++) {
+      G += u[j] * u[j] + v[j] * v[j];
+      for (unsigned int k = 0; k < 3; k++)
+        S[j][k] += u[j] * v[k];
+    }
+  }
+
+  /* build the quaternion matrix. */
+  double N[4][4] = {
+    { S[0][0] + S[1][1] + S[2][2], S[1][2] - S[2][1],
+      S[2][0] - S[0][2], S[0][1] - S[1][0] },
+    { S[1][2] - S[2][1], S[0][0] - S[1][1] - S[2][2],
+      S[0][1] + S[1][0], S[2][0] + S[0][2] },
+    { S[2][0] - S[0][2], S[0][1] + S[1][0],
+      -S[0][0] + S[1][1] - S[2][2], S[1][2] + S[2][1] },
+    { S[0][1] - S[1][0], S[2][0] + S[0][2],
+      S[1][2] + S[2][1], -S[0][0] - S[1][1] + S[2][2] }
+  };
+
+  /* diagonalize the matrix by cyclic jacobi rotations. */
+  for (unsigned int sweep = 0; sweep < 50; sweep++) {
+    for (unsigned int p = 0; p < 3; p++) {
+      for (unsigned int q = p + 1; q < 4; q++) {
+        if (fabs(N[p][q]) < 1.0e-300)
+          continue;
+
+        const double theta = (N[q][q] - N[p][p]) / (2.0 * N[p][q]);
+        const double t = (theta >= 0.0 ? 1.0 : -1.0) /
+                         (fabs(theta) + sqrt(theta * theta + 1.0));
+        const double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+
+        for (unsigned int k = 0; k < 4; k++) {
+          const double nkp = N[k][p], nkq = N[k][q];
+          N[k][p] = c * nkp - s * nkq;
+          N[k][q] = s * nkp + c * nkq;
+        }
+
+        for (unsigned int k = 0; k < 4; k++) {
+          const double npk = N[p][k], nqk = N[q][k];
+          N[p][k] = c * npk - s * nqk;
+          N[q][k] = s * npk + c * nqk;
+        }
+      }
+    }
+  }
+
+  /* return the deviation from the largest eigenvalue. */
+  double lmax = N[0][0];
+  for (unsigned int k = 1; k < 4; k++)
+    lmax = (N[k][k] > lmax ? N[k][k] : lmax);
+
+  const double d = G - 2.0 * lmax;
+  return (d > 0.0 ? d : 0.0);
+}
+
+/* enum-rmsd.x: test-case for the lower bounds and the decisions of the
+ * rmsd diversity index.
+ */
+int main (int argc, char **argv) {
+  unsigned int n_fails = 0;
+  unsigned int nnovel = 0, nsimilar = 0;
+  test_enum_t T;
+
+  /* build the enumerator and its rmsd index. */
+  if (!test_enum_new(&T, ARGS) || !enum_rmsd_init(T.E)) {
+    test_enum_free(&T);
+    return 1;
+  }
+
+  enum_t *E = T.E;
+  enum_thread_t *th = E->threads;
+  const unsigned int n = E->G->n_orig;
+  const double tol = E->rmsd_tol;
+
+  /* allocate the base, candidate and stored structures. */
+  vector_t *base = (vector_t*) malloc(NBASE * n * sizeof(vector_t));
+  vector_t *cand = (vector_t*) malloc(n * sizeof(vector_t));
+  vector_t *stored = (vector_t*) malloc(NCAND * n * sizeof(vector_t));
+  if (!base || !cand || !stored)
+    return 1;
+
+  /* build the base structures. */
+  srand(1);
+  for (unsigned int i = 0; i < NBASE * n; i++) {
+    base[i].x = 5.0 * uniform();
+    base[i].y = 5.0 * uniform();
+    base[i].z = 5.0 * uniform();
+  }
+
+  /* check candidates made from rotated and perturbed base structures. */
+  unsigned int nstored = 0;
+  for (unsigned int c = 0; c < NCAND; c++) {
+    /* pick a random rotation from a unit quaternion. */
+    double q[4], qn = 0.0;
+    for (unsigned int k = 0; k < 4; k++) {
+      q[k] = uniform();
+      qn += q[k] * q[k];
+    }
+
+    for (unsigned int k = 0; k < 4; k++)
+      q[k] /= sqrt(qn);
+
+    const double R[3][3] = {
+      { 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]),
+        2.0 * (q[1] * q[2] - q[0] * q[3]),
+        2.0 * (q[1] * q[3] + q[0] * q[2]) },
+      { 2.0 * (q[1] * q[2] + q[0] * q[3]),
+        1.0 - 2.0 * (q[1] * q[1] + q[3] * q[3]),
+        2.0 * (q[2] * q[3] - q[0] * q[1]) },
+      { 2.0 * (q[1] * q[3] - q[0] * q[2]),
+        2.0 * (q[2] * q[3] + q[0] * q[1]),
+        1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]) }
+    };
+
+    /* rotate and perturb a base structure, by amplitudes that place
+     * candidates on both sides of the tolerance.
+     */
+    const vector_t *b = base + (c % NBASE) * n;
+    const double a = 0.6 * (1.0 + uniform());
+    vector_t x0 = { 0.0, 0.0, 0.0 };
+    for (unsigned int i = 0; i < n; i++) {
+      cand[i].x = R[0][0] * b[i].x + R[0][1] * b[i].y + R[0][2] * b[i].z;
+      cand[i].y = R[1][0] * b[i].x + R[1][1] * b[i].y + R[1][2] * b[i].z;
+      cand[i].z = R[2][0] * b[i].x + R[2][1] * b[i].y + R[2][2] * b[i].z;
+      cand[i].x += a * uniform();
+      cand[i].y += a * uniform();
+      cand[i].z += a * uniform();
+      vector_axpy(&x0, 1.0 / (double) n, cand + i);
+    }
+
+    /* center the candidate, and place it into the thread state. */
+    for (unsigned int i = 0, j = 0; i < E->G->n_order; i++) {
+      if (E->G->orig[i])
+        continue;
+
+      vector_axpy(cand + j, -1.0, &x0);
+      th->state[i].pos = cand[j++];
+    }
+
+    /* check the candidate against the index. */
+    unsigned int nseen;
+    const int novel = enum_rmsd_novel(th, &nseen);
+
+    /* compare the candidate against every stored solution. */
+    const double *prof = th->rmsd_prof;
+    const double *key = prof + n;
+    double dmin = INFINITY;
+    for (unsigned int s = 0; s < nstored; s++) {
+      /* compute the exact deviation. */
+      const double d = sqdev(cand, stored + s * n, n);
+      dmin = (d < dmin ? d : dmin);
+
+      /* the radial profile bound may not exceed the exact deviation. */
+      const float *sprof = E->rmsd_prof + (unsigned long) s * n;
+      double dprof = 0.0;
+      for (unsigned int i = 0; i < n; i++)
+        dprof += (prof[i] - sprof[i]) * (prof[i] - sprof[i]);
+
+      n_fails += test_eq_uint(dprof <= d * (1.0 + 1.0e-6) + 1.0e-6, 1);
+
+      /* the key bound may not exceed the radial profile bound. */
+      const double *skey = E->rmsd_key + (unsigned long) s * ENUM_RMSD_GROUPS;
+      double dkey = 0.0;
+      for (unsigned int j = 0; j < ENUM_RMSD_GROUPS; j++)
+        dkey += (key[j] - skey[j]) * (key[j] - skey[j]);
+
+      n_fails += test_eq_uint(n * dkey <= dprof * (1.0 + 1.0e-6) + 1.0e-6,
+                              1);
+    }
+
+    /* the index must agree with the exact deviations, except within
+     * the rounding of the stored single-precision coordinates.
+     */
+    if (fabs(dmin - tol) > 1.0e-3 * tol)
+      n_fails += test_eq_int(novel, dmin >= tol);
+
+    /* store novel candidates. */
+    if (novel) {
+      n_fails += test_eq_int(enum_rmsd_insert(th, nseen), 1);
+      memcpy(stored + nstored * n, cand, n * sizeof(vector_t));
+      nstored++;
+      nnovel++;
+    }
+    else
+      nsimilar++;
+  }
+
+  /* both decisions must have been exercised. */
+  n_fails += test_eq_uint(nnovel > 10 && nsimilar > 10, 1);
+  n_fails += test_eq_uint(E->rmsd_n, nstored);
+
+  /* free allocated memory. */
+  free(base);
+  free(cand);
+  free(stored);
+  test_enum_free(&T);
+
+  return (n_fails > 0);
+}
+
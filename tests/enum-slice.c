@@ -0,0 +1,123 @@
+
+/* include the required headers. */
+#include "base.h"
+#include "enum-base.h"
+
+/* ARGS: arguments of the enumerator of every slice. */
+#define ARGS \
+  "--input data/tetra/tetra.fa --restraints data/tetra/tetra.res " \
+  "--method dist,impr --branch-max 4 --branch-eps 0.5 --vdw-scale 0.5 "
+
+/* leaf_index(): compute the index of a leaf of the tree from its
+ * mixed-radix state indices.
+ */
+static unsigned long leaf_index (enum_t *E, const unsigned int *idx) {
+  unsigned long leaf = 0;
+  for (unsigned int i = 0; i < E->G->n_order; i++)
+    leaf = leaf * E->threads[0].state[i].nb + idx[i];
+
+  return leaf;
+}
+
+/* enumerate(): enumerate one slice of the tree, and return its number
+ * of solutions and the indices of its first and last leaves.
+ */
+static unsigned int enumerate (const char *slice,
+                               unsigned long *lo, unsigned long *hi,
+                               unsigned int *nb) {
+  char args[512];
+  test_enum_t T;
+
+  /* build and run the enumerator of the slice. */
+  sprintf(args, "%s %s", ARGS, slice);
+  if (!test_enum_new(&T, args) || !enum_execute(T.E)) {
+    test_enum_free(&T);
+    return UINT_MAX;
+  }
+
+  /* store the bounds of the slice. */
+  const unsigned int nsol = T.E->nsol;
+  *lo = leaf_index(T.E, T.E->slice_lo);
+  *hi = leaf_index(T.E, T.E->slice_hi);
+
+  /* store the branch count of the first branching level. */
+  if (nb) {
+    unsigned int i = 0;
+    while (T.E->threads[0].state[i].nb < 2)
+      i++;
+
+    *nb = T.E->threads[0].state[i].nb;
+  }
+
+  test_enum_free(&T);
+  return nsol;
+}
+
+/* enum-slice.x: test-case for tiling the enumeration tree by partitions
+ * and prefixes.
+ */
+int main (int argc, char **argv) {
+  unsigned int n_fails = 0;
+  unsigned long lo, hi, first, last;
+  unsigned int nb = 0;
+  char slice[64];
+
+  /* enumerate the whole tree. */
+  const unsigned int nsol = enumerate("", &first, &last, &nb);
+  n_fails += test_eq_uint(nsol == UINT_MAX, 0);
+  n_fails += test_eq_uint(first == 0, 1);
+
+  /* the partitions of the tree must cover it without gaps or overlaps. */
+  const unsigned int parts[] = { 2, 3, 7 };
+  for (unsigned int n = 0; n < 3; n++) {
+    unsigned long next = first;
+    unsigned int sum = 0;
+
+    for (unsigned int k = 1; k <= parts[n]; k++) {
+      sprintf(slice, "--partition %u/%u", k, parts[n]);
+      sum += enumerate(slice, &lo, &hi, NULL);
+
+      n_fails += test_eq_uint(lo == next, 1);
+      n_fails += test_eq_uint(hi >= lo, 1);
+      next = hi + 1;
+    }
+
+    n_fails += test_eq_uint(next == last + 1, 1);
+    n_fails += test_eq_uint(sum, nsol);
+  }
+
+  /* the prefixes of the first branching level must also cover it. */
+  unsigned int sum = 0;
+  for (unsigned int b = 0; b < nb; b++) {
+    sprintf(slice, "--prefix %u", b);
+    sum += enumerate(slice, &lo, &hi, NULL);
+  }
+
+  n_fails += test_eq_uint(sum, nsol);
+
+  /* partitions of a prefix must cover the prefix. */
+  const unsigned int npre = enumerate("--prefix 1", &first, &last, NULL);
+  unsigned long next = first;
+  sum = 0;
+  for (unsigned int k = 1; k <= 5; k++) {
+    sprintf(slice, "--prefix 1 --partition %u/5", k);
+    sum += enumerate(slice, &lo, &hi, NULL);
+
+    n_fails += test_eq_uint(lo == next, 1);
+    next = hi + 1;
+  }
+
+  n_fails += test_eq_uint(next == last + 1, 1);
+  n_fails += test_eq_uint(sum, npre);
+
+  /* malformed and out-of-range prefixes must be refused. */
+  const char *bad[] = {
+    "--prefix -1", "--prefix 1x", "--prefix 1,+2",
+    "--prefix 4294967296", "--prefix 1,99999999999999999999"
+  };
+  for (unsigned int i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    n_fails += test_eq_uint(enumerate(bad[i], &lo, &hi, NULL), UINT_MAX);
+
+  return (n_fails > 0);
+}
+
@@ -17,14 +17,57 @@ int main (int argc, char **argv) {
 
   /* compute the set of grid samples. */
   double samples[8];
-  intervals_grid(I, samples, 5);
+  unsigned int n = 5;
+  intervals_grid(I, samples, &n);
 
   /* test the result. */
   const double ans[] = { 0.5, 2.125, 2.75, 4.875, 6.5 };
   n_fails += test_eq_array_double(5, samples, ans, 1.0e-8);
+  n_fails += test_eq_uint(n, 5);
 
-  /* free the interval set. */
+  /* compute a single sample, which lies at the middle of the
+   * concatenated set: 1.25 along a total length of 2.5.
+   */
+  n = 1;
+  intervals_grid(I, samples, &n);
+
+  /* test the result. */
+  n_fails += test_eq_double(samples[0], 2.75, 1.0e-8);
+  n_fails += test_eq_uint(n, 1);
+
+  /* compute a single sample on a two-interval set, where the middle
+   * of the concatenation falls inside the second interval.
+   */
+  intervals_t *J = intervals_new(2);
+  intervals_union(J, 0.0, 1.0);
+  intervals_union(J, 2.0, 5.0);
+  n = 1;
+  intervals_grid(J, samples, &n);
+
+  /* test the result. */
+  n_fails += test_eq_double(samples[0], 3.0, 1.0e-8);
+  n_fails += test_eq_uint(n, 1);
+
+  /* compute a single sample on pairs of intervals whose lengths agree
+   * to within round-off, where the middle of the concatenation lies on
+   * the boundary between them, and so at the end of the first one.
+   */
+  for (unsigned int k = 0; k < 2; k++) {
+    intervals_t *K = intervals_new(2);
+    intervals_union(K, -2.8 - (k ? 1.0e-12 : 0.0), -2.7);
+    intervals_union(K, 2.7, 2.8 + (k ? 0.0 : 1.0e-12));
+    n = 1;
+    intervals_grid(K, samples, &n);
+
+    /* test the result. */
+    n_fails += test_eq_double(samples[0], -2.7, 1.0e-8);
+    n_fails += test_eq_uint(n, 1);
+    intervals_free(K);
+  }
+
+  /* free the interval sets. */
   intervals_free(I);
+  intervals_free(J);
 
   return (n_fails > 0);
 }